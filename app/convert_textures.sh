@@ -0,0 +1,11 @@
+# Converts the image assets into the ETC1 containers of the texture loader (<asset>.etc1 next to the PNG).
+# usage: ./convert_textures.sh <path of texture_converter> (the host build of src/main/jni)
+CONVERTER=${1:-../build-host/texture_converter}
+ASSETS=src/main/assets
+for f in title c64_press up_press down_press left_press right_press fire_press; do
+	$CONVERTER $ASSETS/$f.png $ASSETS/$f.etc1 || exit 1
+done
+for f in main_background_horizontal main_background_vertical; do
+	$CONVERTER -flatten $ASSETS/$f.png $ASSETS/$f.etc1 || exit 1
+done
+exit 0
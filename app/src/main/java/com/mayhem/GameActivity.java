@@ -113,6 +113,12 @@ public class GameActivity extends Activity {
 		mView.onResume ();
 	}
 
+	@Override
+	protected void onDestroy () {
+		GameLib.shutdown ();
+		super.onDestroy ();
+	}
+
 	@Override
 	public void onConfigurationChanged (Configuration newConfig) {
 		super.onConfigurationChanged (newConfig);
@@ -18,6 +18,7 @@ public class GameLib {
 	public static native void pause ();
 	public static native void resume ();
 	public static native boolean isPaused ();
+	public static native void shutdown ();
 
 	public static native void step ();
 	public static native void resize (int newScreenWidth, int newScreenHeight);
@@ -30,6 +31,53 @@ public class GameLib {
 	public static native void touchUp (int id, float x, float y);
 	public static native void touchMove (int id, float x, float y);
 
+	//Frame phase timings (JSON, times in microseconds), the dump appends a line to the given file of the data directory
+	public static native String getFrameTimings ();
+	public static native void resetFrameTimings ();
+	public static native void dumpFrameTimings (String fileName);
+
+	//Batching of the overlay meshes into one draw call per texture (switch it off to compare the frame timings)
+	public static native void setSpriteBatch (boolean enabled);
+	public static native boolean isSpriteBatch ();
+
+	//Filtering of the redundant GL state calls and the count of the issued and filtered calls (JSON, per frame and totals)
+	public static native void setGLStateFilter (boolean enabled);
+	public static native boolean isGLStateFilter ();
+	public static native String getGLState ();
+	public static native void resetGLState ();
+
+	//GPU memory budget of the image textures kept over the layout changes, and the cache statistics (JSON)
+	public static native void setTextureCacheBudget (int megabytes);
+	public static native String getTextureCache ();
+	public static native void resetTextureCache ();
+
+	//Decoding of the image assets in the background (uploads in the frame budget) and the loader statistics (JSON)
+	public static native void setTextureLoader (boolean async);
+	public static native boolean isTextureLoader ();
+	public static native String getTextureLoader ();
+	public static native void resetTextureLoader ();
+
+	//ETC1 textures of the image assets (the textures loaded after the switch, when the device has ETC1)
+	public static native void setETC1Textures (boolean enabled);
+	public static native boolean isETC1Textures ();
+
+	//Native PNG decoding of the image assets (else by BitmapFactory), the load times (JSON) and the benchmark of both paths over the loaded images (JSON)
+	public static native void setNativeImageDecode (boolean enabled);
+	public static native boolean isNativeImageDecode ();
+	public static native String getImageLoads ();
+	public static native void resetImageLoads ();
+	public static native String benchmarkImageLoads ();
+
+	//Emulator sound path (direct: the audio callback reads the emulator sound, else the game thread pushes it) and its end-to-end latency (JSON, times in microseconds)
+	public static native void setDirectPCM (boolean direct);
+	public static native boolean isDirectPCM ();
+	public static native String getPCMLatency ();
+	public static native void resetPCMLatency ();
+
+	//Offset of the emulator sound to its picture (JSON, times in microseconds, positive: the sound is late) and the correction of the sound delay
+	public static native String getAVSync ();
+	public static native void resetAVSync ();
+
 	public static void runEmulator () {
 		String exePath = combinePath (mDataPath, "x86.exe");
 		String diskPath = combinePath (mDataPath, "game.d64");
@@ -31,14 +31,32 @@ LOCAL_SRC_FILES +=						\
 	jnihelper/jniload.cpp				\
 	platform/androidcontentmanager.cpp	\
 	platform/audiomanager.cpp			\
+	platform/openslbackend.cpp			\
 	management/glerror.cpp				\
+	management/glstate.cpp				\
 	management/game.cpp					\
+	management/frametimer.cpp			\
+	management/pcmresampler.cpp			\
+	management/pcmautotuner.cpp			\
+	management/pcmmixer.cpp				\
+	management/pcmoutput.cpp			\
+	management/avsync.cpp				\
+	management/simaudiobackend.cpp		\
 	content/animation.cpp				\
 	content/geom.cpp					\
 	content/mesh2D.cpp					\
+	content/spritebatch.cpp				\
+	content/textureatlas.cpp			\
+	content/atlasmesh.cpp				\
+	content/geometryregistry.cpp		\
+	content/texturecache.cpp			\
+	content/textureloader.cpp			\
+	content/pngdecoder.cpp				\
+	content/etc1texture.cpp				\
 	content/coloredmesh.cpp				\
 	content/texanimmesh.cpp				\
 	content/imagemesh.cpp				\
+	content/pixelkernels.cpp			\
 	content/qte.cpp						\
 	content/rigidbody2D.cpp				\
 	game/mayhemgame.cpp					\
@@ -46,10 +64,22 @@ LOCAL_SRC_FILES +=						\
 	jni_GameActivity.cpp				\
 	jni_GameLib.cpp
 
+#SIMD pixel kernels and sound mixing (the implementation is selected at runtime by the CPU features)
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+	LOCAL_SRC_FILES += content/pixelkernels_neon.cpp.neon management/pcmmixer_neon.cpp.neon
+endif
+ifeq ($(TARGET_ARCH_ABI),arm64-v8a)
+	LOCAL_SRC_FILES += content/pixelkernels_neon.cpp management/pcmmixer_neon.cpp
+endif
+ifneq ($(filter x86 x86_64,$(TARGET_ARCH_ABI)),)
+	LOCAL_SRC_FILES += content/pixelkernels_sse.cpp management/pcmmixer_sse.cpp
+endif
+
 LOCAL_SHARED_LIBRARIES := c64emu-prebuilt
-#LOCAL_STATIC_LIBRARIES :=
+LOCAL_STATIC_LIBRARIES := cpufeatures
 
-LOCAL_LDLIBS := -llog -lGLESv1_CM -lEGL -landroid -ljnigraphics -lOpenSLES
+LOCAL_LDLIBS := -llog -lGLESv1_CM -lEGL -landroid -ljnigraphics -lOpenSLES -lz
 
 include $(BUILD_SHARED_LIBRARY)
 
+$(call import-module,android/cpufeatures)
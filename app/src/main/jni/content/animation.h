@@ -82,7 +82,7 @@ private:
 	float mFrameTime;
 
 public:
-	FrameAnimation (float frameTime) : mFrameTime (frameTime) {}
+	FrameAnimation (float frameTime) : mFrame (0), mFrameTime (frameTime) {}
 
 	uint32_t Frame () const {
 		return mFrame;
@@ -0,0 +1,55 @@
+#include "../pch.h"
+#include "atlasmesh.h"
+#include "textureatlas.h"
+#include "geometryregistry.h"
+
+void AtlasMesh::Init () {
+	Mesh2D::Init ();
+
+	assert (mAtlas && mAtlas->IsBuilt () && !mRegions.empty ());
+
+	mFrame = 0;
+	vector<float> texCoords (8);
+	RegionTexCoords (mFrame, &texCoords[0]);
+	mVbo = NewTexturedVBO (mAtlas->GetTexture (), vector<float> (), texCoords);
+
+	//The texture coordinates of each frame (shared with the other meshes of the atlas)
+	for (uint32_t frame = 0; frame < (uint32_t) mRegions.size (); ++frame) {
+		RegionTexCoords (frame, &texCoords[0]);
+		mFrameVbo.push_back (GeometryRegistry::Get ().Acquire (texCoords));
+	}
+}
+
+void AtlasMesh::Shutdown () {
+	DeleteTexturedVBO (mVbo);
+	DeleteTexturedVBO (mFrameVbo);
+
+	Mesh2D::Shutdown ();
+}
+
+void AtlasMesh::SetFrame (uint32_t frame) {
+	frame %= (uint32_t) mRegions.size ();
+	if (frame == mFrame || mVbo.empty ())
+		return;
+
+	mFrame = frame;
+
+	//The texture coordinates of the batched quad, overwritten in place (the rendered one selects the buffer of the frame)
+	assert (mQuadTexCoords.size () == 8);
+	RegionTexCoords (mFrame, &mQuadTexCoords[0]);
+}
+
+void AtlasMesh::RenderMesh () {
+	RenderTexturedVBO (mAtlas->GetTexture (), mVbo[0], mFrameVbo[mFrame]);
+}
+
+void AtlasMesh::RegionTexCoords (uint32_t frame, float* texCoords) const {
+	const TextureAtlas::Region& region = mAtlas->GetRegion (mRegions[frame]);
+	const float coords[8] = {
+		region.u0, region.v0,
+		region.u1, region.v0,
+		region.u0, region.v1,
+		region.u1, region.v1
+	};
+	memcpy (texCoords, coords, sizeof (coords));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "mesh2D.h"
+
+class TextureAtlas;
+
+/// A quad showing one of the given regions of a texture atlas at a time (the frames of a flipbook animation).
+class AtlasMesh : public Mesh2D {
+private:
+	shared_ptr<TextureAtlas> mAtlas;
+	vector<uint32_t> mRegions;
+	uint32_t mFrame;
+
+	vector<GLuint> mVbo;
+	vector<GLuint> mFrameVbo; ///< The texture coordinates of the frames.
+
+public:
+	AtlasMesh (shared_ptr<TextureAtlas> atlas, const vector<uint32_t>& regions) : mAtlas (atlas), mRegions (regions), mFrame (0) {}
+
+	virtual void Init () override;
+	virtual void Shutdown () override;
+
+	uint32_t GetFrameCount () const {
+		return (uint32_t) mRegions.size ();
+	}
+
+	/// Show the region of the frame (the frames are repeated).
+	void SetFrame (uint32_t frame);
+
+protected:
+	virtual void RenderMesh () override;
+
+private:
+	/// Write the 8 texture coordinates of the region of the frame.
+	void RegionTexCoords (uint32_t frame, float* texCoords) const;
+};
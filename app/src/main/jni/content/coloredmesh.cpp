@@ -1,5 +1,6 @@
 #include "../pch.h"
 #include "coloredmesh.h"
+#include "../management/glstate.h"
 
 void ColoredMesh::Init () {
 	Mesh2D::Init ();
@@ -9,13 +10,10 @@ void ColoredMesh::Init () {
 }
 
 void ColoredMesh::Shutdown () {
-	if (mVbo.size () > 0) {
-		glDeleteBuffers (mVbo.size (), &mVbo[0]);
-		mVbo.clear ();
-	}
+	DeleteTexturedVBO (mVbo);
 
 	if (mTex > 0) {
-		glDeleteTextures (1, &mTex);
+		GLState::Get ().DeleteTextures (1, &mTex);
 		mTex = 0;
 	}
 
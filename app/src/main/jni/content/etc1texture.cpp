@@ -0,0 +1,56 @@
+#include "../pch.h"
+#include "etc1texture.h"
+
+string ETC1Texture::ContainerOf (const string& asset) {
+	size_t dot = asset.find_last_of ('.');
+	size_t slash = asset.find_last_of ('/');
+	if (dot == string::npos || (slash != string::npos && dot < slash))
+		return asset + ".etc1";
+
+	return asset.substr (0, dot) + ".etc1";
+}
+
+bool ETC1Texture::Read (const uint8_t* data, size_t size) {
+	Header header;
+	if (data == nullptr || size < sizeof (header))
+		return false;
+
+	memcpy (&header, data, sizeof (header));
+	if (header.magic != Magic || header.version != Version || header.width == 0 || header.height == 0 || header.width > 16384 || header.height > 16384)
+		return false;
+
+	int w = (int) header.width;
+	int h = (int) header.height;
+	size_t alphaSize = (header.flags & HasAlpha) != 0 ? AlphaPitch (w) * h : 0;
+	if (header.colorSize != ColorSize (w, h) || header.alphaSize != alphaSize || size < sizeof (header) + header.colorSize + header.alphaSize)
+		return false;
+
+	width = w;
+	height = h;
+
+	const uint8_t* src = data + sizeof (header);
+	color.assign (src, src + header.colorSize);
+	src += header.colorSize;
+	alpha.assign (src, src + header.alphaSize);
+	return true;
+}
+
+vector<uint8_t> ETC1Texture::Write () const {
+	assert (color.size () == ColorSize (width, height));
+	assert (alpha.empty () || alpha.size () == AlphaPitch (width) * height);
+
+	Header header;
+	header.magic = Magic;
+	header.version = Version;
+	header.width = (uint32_t) width;
+	header.height = (uint32_t) height;
+	header.flags = alpha.empty () ? 0u : (uint32_t) HasAlpha;
+	header.colorSize = (uint32_t) color.size ();
+	header.alphaSize = (uint32_t) alpha.size ();
+
+	vector<uint8_t> data (sizeof (header));
+	memcpy (&data[0], &header, sizeof (header));
+	data.insert (data.end (), color.begin (), color.end ());
+	data.insert (data.end (), alpha.begin (), alpha.end ());
+	return data;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+///
+/// The container of the ETC1 compressed image assets (<asset>.etc1 next to the PNG, made by the texture_converter tool).
+///
+/// ETC1 has no alpha: the images with transparent pixels have a separate alpha plane of 8 bit samples, uploaded into a
+/// GL_ALPHA texture and drawn on the second texture unit (GLState::SetAlphaPlane). The colors are premultiplied like the
+/// pixels of the PNG images. The layout (little endian):
+///
+///		header: magic ("ETC1"), version, width, height, flags, color size, alpha size (7 x uint32_t)
+///		color: the ETC1 blocks of 4x4 pixels (8 bytes each, the rows of blocks from the top)
+///		alpha: the rows of the alpha plane from the top (each padded to 4 bytes, the unpack alignment of GL)
+class ETC1Texture {
+//Definitions
+public:
+	enum : uint32_t {
+		Magic = 0x31435445, ///< "ETC1"
+		Version = 1,
+		HasAlpha = 1 ///< The flag of the alpha plane.
+	};
+
+private:
+	struct Header {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t flags;
+		uint32_t colorSize;
+		uint32_t alphaSize;
+	};
+
+//Data
+public:
+	int width;
+	int height;
+	vector<uint8_t> color; ///< The ETC1 blocks.
+	vector<uint8_t> alpha; ///< The alpha plane (empty, when the image is opaque).
+
+//Construction
+public:
+	ETC1Texture () : width (0), height (0) {}
+
+//Interface
+public:
+	/// The container of the image asset (the extension replaced by .etc1).
+	static string ContainerOf (const string& asset);
+
+	/// The size of the ETC1 blocks of an image (the partial blocks at the right and bottom edges are whole).
+	static size_t ColorSize (int width, int height) {
+		return (size_t) ((width + 3) / 4) * (size_t) ((height + 3) / 4) * 8;
+	}
+
+	static size_t AlphaPitch (int width) {
+		return ((size_t) width + 3) & ~(size_t) 3;
+	}
+
+	/// The GPU memory of the texture and its alpha plane.
+	size_t Bytes () const {
+		return color.size () + alpha.size ();
+	}
+
+	/// Parse the container, returns false, when the content is not a valid container.
+	bool Read (const uint8_t* data, size_t size);
+	vector<uint8_t> Write () const;
+};
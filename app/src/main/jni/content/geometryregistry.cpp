@@ -0,0 +1,59 @@
+#include "../pch.h"
+#include "geometryregistry.h"
+#include "../management/glstate.h"
+
+GLuint GeometryRegistry::Acquire (const vector<float>& data) {
+	assert (!data.empty ());
+
+	++mReferenceCount;
+
+	Entries::iterator it = mEntries.find (data);
+	if (it != mEntries.end ()) {
+		++mHitCount;
+		++it->second.refCount;
+		return it->second.vbo;
+	}
+
+	++mMissCount;
+
+	GLuint vbo = 0;
+	glGenBuffers (1, &vbo);
+	GLState::Get ().BindBuffer (GL_ARRAY_BUFFER, vbo);
+	glBufferData (GL_ARRAY_BUFFER, data.size () * sizeof (float), &data[0], GL_STATIC_DRAW);
+
+	it = mEntries.insert (make_pair (data, Entry { vbo, 1 })).first;
+	mBuffers[vbo] = it;
+	return vbo;
+}
+
+void GeometryRegistry::Release (GLuint vbo) {
+	auto it = mBuffers.find (vbo);
+	assert (it != mBuffers.end () && it->second->second.refCount > 0);
+	if (it == mBuffers.end () || it->second->second.refCount == 0)
+		return;
+
+	--it->second->second.refCount;
+	--mReferenceCount;
+}
+
+void GeometryRegistry::Trim () {
+	for (Entries::iterator it = mEntries.begin (); it != mEntries.end ();) {
+		if (it->second.refCount > 0) {
+			++it;
+			continue;
+		}
+
+		GLState::Get ().DeleteBuffers (1, &it->second.vbo);
+		mBuffers.erase (it->second.vbo);
+		it = mEntries.erase (it);
+	}
+}
+
+GeometryRegistry::Stats GeometryRegistry::GetStats () const {
+	Stats stats;
+	stats.bufferCount = (uint32_t) mEntries.size ();
+	stats.referenceCount = mReferenceCount;
+	stats.hitCount = mHitCount;
+	stats.missCount = mMissCount;
+	return stats;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+///
+/// Interns the vertex data of the meshes: the same content is one shared, reference counted VBO.
+///
+/// Nearly all meshes are the same unit quad with the same texture coordinates, so they share two buffers. The buffers
+/// without references are kept (a layout rebuild creates the same geometry again) until Trim. GL thread only.
+class GeometryRegistry {
+//Definitions
+public:
+	struct Stats {
+		uint32_t bufferCount; ///< The live buffers (with or without references).
+		uint32_t referenceCount;
+		uint64_t hitCount; ///< Acquires served by an existing buffer.
+		uint64_t missCount; ///< Acquires created a new buffer.
+	};
+
+private:
+	struct Entry {
+		GLuint vbo;
+		uint32_t refCount;
+	};
+
+	typedef map<vector<float>, Entry> Entries;
+
+//Data
+private:
+	Entries mEntries;
+	map<GLuint, Entries::iterator> mBuffers; ///< The entries by buffer name.
+
+	uint32_t mReferenceCount;
+	uint64_t mHitCount;
+	uint64_t mMissCount;
+
+//Construction
+private:
+	GeometryRegistry () : mReferenceCount (0), mHitCount (0), mMissCount (0) {}
+
+public:
+	static GeometryRegistry& Get () {
+		static GeometryRegistry inst;
+		return inst;
+	}
+
+//Interface
+public:
+	/// The shared static buffer of the data (a new reference, release it by Release).
+	GLuint Acquire (const vector<float>& data);
+	void Release (GLuint vbo);
+
+	/// Delete the buffers without references.
+	void Trim ();
+
+	Stats GetStats () const;
+};
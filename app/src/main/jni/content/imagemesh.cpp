@@ -1,21 +1,19 @@
 #include "../pch.h"
 #include "imagemesh.h"
+#include "texturecache.h"
 
 void ImageMesh::Init () {
 	Mesh2D::Init ();
 
-	mTex = LoadTextureFromAsset (mAsset);
+	mTex = TextureCache::Get ().Acquire (mAsset);
 	mVbo = NewTexturedVBO (mTex);
 }
 
 void ImageMesh::Shutdown () {
-	if (mVbo.size () > 0) {
-		glDeleteBuffers (mVbo.size (), &mVbo[0]);
-		mVbo.clear ();
-	}
+	DeleteTexturedVBO (mVbo);
 
 	if (mTex > 0) {
-		glDeleteTextures (1, &mTex);
+		TextureCache::Get ().Release (mTex);
 		mTex = 0;
 	}
 
@@ -1,7 +1,10 @@
 #include "../pch.h"
 #include "mesh2D.h"
 #include "color.h"
+#include "spritebatch.h"
+#include "geometryregistry.h"
 #include "../management/game.h"
+#include "../management/glstate.h"
 
 void Mesh2D::Init () {
 	Scale = Vector2D (1, 1);
@@ -11,6 +14,10 @@ void Mesh2D::Shutdown () {
 	Pos = Vector2D ();
 	Rotation = 0;
 	Scale = Vector2D (1, 1);
+
+	mQuadTexture = 0;
+	mQuadVertices.clear ();
+	mQuadTexCoords.clear ();
 }
 
 void Mesh2D::Render () {
@@ -25,15 +32,40 @@ void Mesh2D::Render () {
 	glPopMatrix ();
 }
 
+void Mesh2D::Render (SpriteBatch* batch) {
+	if (batch == nullptr) {
+		Render ();
+		return;
+	}
+
+	if (mQuadTexture > 0) {
+		batch->Draw (mQuadTexture, &mQuadVertices[0], &mQuadTexCoords[0], Pos, Rotation, Scale);
+		return;
+	}
+
+	//Keep the drawing order
+	batch->Flush ();
+	Render ();
+}
+
+void Mesh2D::GetTextureFormat (int bpp, GLint& format, GLenum& type) {
+	assert (bpp == 16 || bpp == 24 || bpp == 32);
+
+	format = bpp == 32 ? GL_RGBA : GL_RGB;
+	type = bpp == 16 ? GL_UNSIGNED_SHORT_5_6_5 : GL_UNSIGNED_BYTE;
+}
+
 GLuint Mesh2D::CreateTexture (int width, int height, int bpp) const {
-	assert (width > 0 && height > 0 && (bpp == 24 || bpp == 32));
+	assert (width > 0 && height > 0);
 
 	GLuint texID = 0;
 	glGenTextures (1, &texID);
-	glBindTexture (GL_TEXTURE_2D, texID);
+	GLState::Get ().BindTexture (texID);
 
-	GLint format = bpp == 24 ? GL_RGB : GL_RGBA;
-	glTexImage2D (GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr);
+	GLint format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	GetTextureFormat (bpp, format, type);
+	glTexImage2D (GL_TEXTURE_2D, 0, format, width, height, 0, format, type, nullptr);
 
 	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -42,11 +74,11 @@ GLuint Mesh2D::CreateTexture (int width, int height, int bpp) const {
 }
 
 GLuint Mesh2D::CreateColoredTexture (int width, int height, int bpp, const Color& color) const {
-	assert (width > 0 && height > 0 && (bpp == 24 || bpp == 32));
+	assert (width > 0 && height > 0);
 
 	GLuint texID = 0;
 	glGenTextures (1, &texID);
-	glBindTexture (GL_TEXTURE_2D, texID);
+	GLState::Get ().BindTexture (texID);
 
 	uint8_t colR = color.RedByte ();
 	uint8_t colG = color.GreenByte ();
@@ -58,6 +90,13 @@ GLuint Mesh2D::CreateColoredTexture (int width, int height, int bpp, const Color
 	for (int y = 0;y < height;++y) {
 		for (int x = 0;x < width;++x) {
 			int offset = (y * width + x) * bytePerPixel;
+			if (bytePerPixel == 2) { //RGB565
+				uint16_t packed = (uint16_t) ((colR >> 3) << 11 | (colG >> 2) << 5 | (colB >> 3));
+				pixels[offset + 0] = (uint8_t) (packed & 0xFF);
+				pixels[offset + 1] = (uint8_t) (packed >> 8);
+				continue;
+			}
+
 			pixels[offset + 0] = colR;
 			pixels[offset + 1] = colG;
 			pixels[offset + 2] = colB;
@@ -66,8 +105,10 @@ GLuint Mesh2D::CreateColoredTexture (int width, int height, int bpp, const Color
 		}
 	}
 
-	GLint format = bpp == 24 ? GL_RGB : GL_RGBA;
-	glTexImage2D (GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, &pixels[0]);
+	GLint format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	GetTextureFormat (bpp, format, type);
+	glTexImage2D (GL_TEXTURE_2D, 0, format, width, height, 0, format, type, &pixels[0]);
 
 	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -75,26 +116,6 @@ GLuint Mesh2D::CreateColoredTexture (int width, int height, int bpp, const Color
 	return texID;
 }
 
-GLuint Mesh2D::LoadTextureFromAsset (const string &asset) const {
-	GLuint texID = 0;
-	glGenTextures (1, &texID);
-	glBindTexture (GL_TEXTURE_2D, texID);
-
-	IContentManager &contentManager = Game::ContentManager ();
-	Image image = contentManager.LoadImage (asset);
-
-	const uint8_t *pixels = contentManager.LockPixels (image);
-	glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, contentManager.GetWidth (image), contentManager.GetHeight (image), 0, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *) pixels);
-	contentManager.UnlockPixels (image);
-
-	contentManager.UnloadImage (image);
-
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	return texID;
-}
-
 Rect2D Mesh2D::CalculateBoundingBox (const vector <float> &vertices) const {
 	Vector2D min (FLT_MAX, FLT_MAX);
 	Vector2D max (-FLT_MAX, -FLT_MAX);
@@ -115,54 +136,62 @@ GLuint Mesh2D::NewVBO (const vector <float> &data) const {
 	GLuint vboID = 0;
 	glGenBuffers (1, &vboID);
 
-	glBindBuffer (GL_ARRAY_BUFFER, vboID);
+	GLState::Get ().BindBuffer (GL_ARRAY_BUFFER, vboID);
 	glBufferData (GL_ARRAY_BUFFER, data.size () * sizeof (float), &data[0], GL_STATIC_DRAW);
 
 	return vboID;
 }
 
 vector <GLuint> Mesh2D::NewTexturedVBO (GLuint texID, const vector <float> &vertices, const vector <float> &texCoords) {
-	GLuint vboID = 0;
-	if (vertices.size () <= 0) {
-		vector <float> quad ({
-								 -0.5f, -0.5f,
-								 0.5f, -0.5f,
-								 -0.5f, 0.5f,
-								 0.5f, 0.5f
-							 });
-
-		vboID = NewVBO (quad);
-		boundingBox = CalculateBoundingBox (quad);
-	} else {
-		vboID = NewVBO (vertices);
-		boundingBox = CalculateBoundingBox (vertices);
-	}
-
+	mQuadVertices = vertices.size () <= 0 ? vector<float> ({
+															   -0.5f, -0.5f,
+															   0.5f, -0.5f,
+															   -0.5f, 0.5f,
+															   0.5f, 0.5f
+														   }) : vertices;
+
+	mQuadTexCoords = texCoords.size () <= 0 ? vector<float> ({
+																 0.0f, 0.0f,
+																 1.0f, 0.0f,
+																 0.0f, 1.0f,
+																 1.0f, 1.0f
+															 }) : texCoords;
+
+	boundingBox = CalculateBoundingBox (mQuadVertices);
+
+	//Only the quads of a triangle strip can be batched
+	mQuadTexture = mQuadVertices.size () == 8 && mQuadTexCoords.size () == 8 ? texID : 0;
+
+	//The same quads share their buffers
+	GeometryRegistry& registry = GeometryRegistry::Get ();
 	return {
-		vboID,
-		NewVBO (texCoords.size () <= 0 ? vector<float> ({
-															0.0f, 0.0f,
-															1.0f, 0.0f,
-															0.0f, 1.0f,
-															1.0f, 1.0f
-														}) : texCoords)
+		registry.Acquire (mQuadVertices),
+		registry.Acquire (mQuadTexCoords)
 	};
 }
 
+void Mesh2D::DeleteTexturedVBO (vector<GLuint>& vbo) const {
+	GeometryRegistry& registry = GeometryRegistry::Get ();
+	for (GLuint id : vbo)
+		registry.Release (id);
+
+	vbo.clear ();
+}
+
 void Mesh2D::RenderTexturedVBO (GLuint texID, GLuint vertCoordID, GLuint texCoordID, GLenum mode, int vertexCount) const {
-	glEnable (GL_BLEND);
-	glBlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::Get ().Enable (GL_BLEND);
+	GLState::Get ().BlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	glEnable (GL_TEXTURE_2D);
-	glBindTexture (GL_TEXTURE_2D, texID);
+	GLState::Get ().Enable (GL_TEXTURE_2D);
+	GLState::Get ().BindTexture (texID);
 
-	glBindBuffer (GL_ARRAY_BUFFER, vertCoordID);
+	GLState::Get ().BindBuffer (GL_ARRAY_BUFFER, vertCoordID);
 	glVertexPointer (2, GL_FLOAT, 0, nullptr);
-	glEnableClientState (GL_VERTEX_ARRAY);
+	GLState::Get ().EnableClientState (GL_VERTEX_ARRAY);
 
-	glBindBuffer (GL_ARRAY_BUFFER, texCoordID);
-	glTexCoordPointer (2, GL_FLOAT, 0, nullptr);
-	glEnableClientState (GL_TEXTURE_COORD_ARRAY);
+	GLState::Get ().BindBuffer (GL_ARRAY_BUFFER, texCoordID);
+	GLState::Get ().TexCoordPointer (2, GL_FLOAT, 0, nullptr);
+	GLState::Get ().EnableClientState (GL_TEXTURE_COORD_ARRAY);
 
 	glDrawArrays (mode, 0, vertexCount);
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "rect2D.h"
 
 class Color;
+class SpriteBatch;
 
 /// Base class for 2D meshes.
 class Mesh2D : public enable_shared_from_this<Mesh2D> {
@@ -15,9 +16,15 @@ public:
 
 	Rect2D boundingBox;
 
+protected:
+	//The CPU copy of the textured quad (batching)
+	GLuint mQuadTexture; ///< 0, when the mesh is not a textured quad.
+	vector<float> mQuadVertices;
+	vector<float> mQuadTexCoords;
+
 //Construction
 protected:
-	Mesh2D () : Rotation (0.0f) {}
+	Mesh2D () : Rotation (0.0f), mQuadTexture (0) {}
 
 //Interface
 public:
@@ -25,6 +32,9 @@ public:
 	virtual void Shutdown ();
 	void Render ();
 
+	/// Add the mesh to the batch, when it is a textured quad, else flush the batch and render it (nullptr: render it immediately).
+	void Render (SpriteBatch* batch);
+
 protected:
     virtual void RenderMesh () = 0;
 
@@ -35,14 +45,18 @@ public:
 	}
 
 protected:
+	/// The GL format and type of texture pixels with the given bit per pixel (16: RGB565, 24: RGB, 32: RGBA).
+	static void GetTextureFormat (int bpp, GLint& format, GLenum& type);
+
 	GLuint CreateTexture (int width, int height, int bpp) const;
 	GLuint CreateColoredTexture (int width, int height, int bpp, const Color& color) const;
-	GLuint LoadTextureFromAsset (const string& asset) const;
 
 	Rect2D CalculateBoundingBox (const vector<float>& vertices) const;
 
 	GLuint NewVBO (const vector<float>& data) const;
+	/// The shared buffers of the vertices and texture coordinates (release them by DeleteTexturedVBO).
 	vector<GLuint> NewTexturedVBO (GLuint texID, const vector<float>& vertices = vector<float> (), const vector<float>& texCoords = vector<float> ());
+	void DeleteTexturedVBO (vector<GLuint>& vbo) const;
 
 	void RenderTexturedVBO (GLuint texID, GLuint vertCoordID, GLuint texCoordID, GLenum mode = GL_TRIANGLE_STRIP, int vertexCount = 4) const;
 };
@@ -0,0 +1,197 @@
+#include "../pch.h"
+#include "pixelkernels.h"
+#ifdef __ANDROID__
+#include <android/cpu-features.h>
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+PixelKernels::PixelKernels () :
+	mConvertBGRA (&PixelKernels::ConvertBGRA_Scalar),
+	mConvertBGRASum (&PixelKernels::ConvertBGRASum_Scalar),
+	mSumRGBA (&PixelKernels::SumRGBA_Scalar),
+	mName ("scalar") {
+#ifdef __ANDROID__
+	AndroidCpuFamily family = android_getCpuFamily ();
+	uint64_t features = android_getCpuFeatures ();
+	bool hasNEON = family == ANDROID_CPU_FAMILY_ARM64 || (family == ANDROID_CPU_FAMILY_ARM && (features & ANDROID_CPU_ARM_FEATURE_NEON));
+	bool hasSSSE3 = (family == ANDROID_CPU_FAMILY_X86 || family == ANDROID_CPU_FAMILY_X86_64) && (features & ANDROID_CPU_X86_FEATURE_SSSE3);
+#else //Host build
+#	if defined (__aarch64__) || defined (__ARM_NEON)
+	bool hasNEON = true;
+#	else
+	bool hasNEON = false;
+#	endif
+#	ifdef PIXEL_KERNELS_SSSE3
+	bool hasSSSE3 = __builtin_cpu_supports ("ssse3");
+#	else
+	bool hasSSSE3 = false;
+#	endif
+#endif //__ANDROID__
+
+#ifdef PIXEL_KERNELS_NEON
+	if (hasNEON) {
+		mConvertBGRA = &PixelKernels::ConvertBGRA_NEON;
+		mConvertBGRASum = &PixelKernels::ConvertBGRASum_NEON;
+		mSumRGBA = &PixelKernels::SumRGBA_NEON;
+		mName = "neon";
+	}
+#endif //PIXEL_KERNELS_NEON
+
+#ifdef PIXEL_KERNELS_SSSE3
+	if (hasSSSE3) {
+		mConvertBGRA = &PixelKernels::ConvertBGRA_SSSE3;
+		mConvertBGRASum = &PixelKernels::ConvertBGRASum_SSSE3;
+		mSumRGBA = &PixelKernels::SumRGBA_SSSE3;
+		mName = "ssse3";
+	}
+#endif //PIXEL_KERNELS_SSSE3
+
+	(void) hasNEON; //Only one of them is used on each architecture
+	(void) hasSSSE3;
+
+#ifdef _DEBUG
+	SelfTest ();
+#endif //_DEBUG
+}
+
+bool PixelKernels::ConvertBGRA_Scalar (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+	const uint64_t* src_pixel = (const uint64_t*) src;
+	uint64_t* dst_pixel = (uint64_t*) dst;
+	uint64_t diff = 0;
+
+	//Two pixels in each 64 bit word: swap the 1st and 3rd byte of the pixels and set alpha to 0xFF
+	uint32_t x = 0;
+	for (; x + 8 <= pixelCount; x += 8) {
+		uint64_t pixels = *src_pixel++;
+		uint64_t converted = (pixels & 0x00FF000000FF0000ull) >> 16 | (pixels & 0x0000FF000000FF00ull) | (pixels & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+		diff |= *dst_pixel ^ converted;
+		*dst_pixel++ = converted;
+
+		pixels = *src_pixel++;
+		converted = (pixels & 0x00FF000000FF0000ull) >> 16 | (pixels & 0x0000FF000000FF00ull) | (pixels & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+		diff |= *dst_pixel ^ converted;
+		*dst_pixel++ = converted;
+
+		pixels = *src_pixel++;
+		converted = (pixels & 0x00FF000000FF0000ull) >> 16 | (pixels & 0x0000FF000000FF00ull) | (pixels & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+		diff |= *dst_pixel ^ converted;
+		*dst_pixel++ = converted;
+
+		pixels = *src_pixel++;
+		converted = (pixels & 0x00FF000000FF0000ull) >> 16 | (pixels & 0x0000FF000000FF00ull) | (pixels & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+		diff |= *dst_pixel ^ converted;
+		*dst_pixel++ = converted;
+	}
+
+	//Remaining pixels one by one
+	const uint32_t* src_rest = (const uint32_t*) src_pixel;
+	uint32_t* dst_rest = (uint32_t*) dst_pixel;
+	for (; x < pixelCount; ++x) {
+		uint32_t pixel = *src_rest++;
+		uint32_t converted = (pixel & 0x00FF0000u) >> 16 | (pixel & 0x0000FF00u) | (pixel & 0x000000FFu) << 16 | 0xFF000000u;
+		diff |= *dst_rest ^ converted;
+		*dst_rest++ = converted;
+	}
+
+	return diff != 0;
+}
+
+void PixelKernels::ConvertBGRASum_Scalar (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums) {
+	const uint64_t* src_pixel = (const uint64_t*) src;
+	uint64_t* dst_pixel = (uint64_t*) dst;
+	uint32_t redSum = 0;
+	uint32_t greenSum = 0;
+	uint32_t blueSum = 0;
+
+	uint32_t x = 0;
+	for (; x + 2 <= pixelCount; x += 2) {
+		uint64_t pixels = *src_pixel++;
+		redSum +=	(uint8_t)((pixels & 0x00FF000000000000ull) >> 48) + (uint8_t)((pixels & 0x0000000000FF0000ull) >> 16);
+		greenSum +=	(uint8_t)((pixels & 0x0000FF0000000000ull) >> 40) + (uint8_t)((pixels & 0x000000000000FF00ull) >> 8);
+		blueSum +=	(uint8_t)((pixels & 0x000000FF00000000ull) >> 32) + (uint8_t)(pixels & 0x00000000000000FFull);
+		*dst_pixel++ = (pixels & 0x00FF000000FF0000ull) >> 16 | (pixels & 0x0000FF000000FF00ull) | (pixels & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+	}
+
+	if (x < pixelCount) {
+		uint32_t pixel = *(const uint32_t*) src_pixel;
+		redSum +=	(pixel & 0x00FF0000u) >> 16;
+		greenSum +=	(pixel & 0x0000FF00u) >> 8;
+		blueSum +=	pixel & 0x000000FFu;
+		*(uint32_t*) dst_pixel = (pixel & 0x00FF0000u) >> 16 | (pixel & 0x0000FF00u) | (pixel & 0x000000FFu) << 16 | 0xFF000000u;
+	}
+
+	sums[0] += redSum;
+	sums[1] += greenSum;
+	sums[2] += blueSum;
+}
+
+void PixelKernels::SumRGBA_Scalar (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) {
+	uint32_t redSum = 0;
+	uint32_t greenSum = 0;
+	uint32_t blueSum = 0;
+
+	for (uint32_t x = 0; x < pixelCount; ++x, src += 4) {
+		redSum += src[0];
+		greenSum += src[1];
+		blueSum += src[2];
+	}
+
+	sums[0] += redSum;
+	sums[1] += greenSum;
+	sums[2] += blueSum;
+}
+
+void PixelKernels::SumRGB565_Scalar (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) {
+	const uint16_t* src_pixel = (const uint16_t*) src;
+	uint32_t redSum = 0;
+	uint32_t greenSum = 0;
+	uint32_t blueSum = 0;
+
+	for (uint32_t x = 0; x < pixelCount; ++x) {
+		uint32_t pixel = *src_pixel++;
+		uint32_t red = (pixel >> 11) & 0x1F;
+		uint32_t green = (pixel >> 5) & 0x3F;
+		uint32_t blue = pixel & 0x1F;
+
+		redSum += red << 3 | red >> 2;
+		greenSum += green << 2 | green >> 4;
+		blueSum += blue << 3 | blue >> 2;
+	}
+
+	sums[0] += redSum;
+	sums[1] += greenSum;
+	sums[2] += blueSum;
+}
+
+void PixelKernels::SelfTest () const {
+	//Compare the selected implementation with the scalar one (odd lengths cover the remainder handling too)
+	const uint32_t maxPixelCount = 67;
+	vector<uint8_t> src (maxPixelCount * 4);
+	uint32_t seed = 0x12345678;
+	for (auto& value : src) {
+		seed = seed * 1664525u + 1013904223u;
+		value = (uint8_t) (seed >> 24);
+	}
+
+	for (uint32_t pixelCount = 0; pixelCount <= maxPixelCount; ++pixelCount) {
+		vector<uint8_t> expected (maxPixelCount * 4, 0);
+		vector<uint8_t> result (maxPixelCount * 4, 0);
+
+		bool expectedChanged = ConvertBGRA_Scalar (&src[0], &expected[0], pixelCount);
+		bool changed = mConvertBGRA (&src[0], &result[0], pixelCount);
+		CHECKMSG (changed == expectedChanged && result == expected, "PixelKernels::SelfTest () - ConvertBGRA result mismatch!");
+		CHECKMSG (!mConvertBGRA (&src[0], &result[0], pixelCount), "PixelKernels::SelfTest () - ConvertBGRA reports change on same content!");
+
+		uint32_t expectedSums[3] = { 0, 0, 0 };
+		uint32_t sums[3] = { 0, 0, 0 };
+		ConvertBGRASum_Scalar (&src[0], &expected[0], pixelCount, expectedSums);
+		mConvertBGRASum (&src[0], &result[0], pixelCount, sums);
+		CHECKMSG (result == expected && memcmp (sums, expectedSums, sizeof (sums)) == 0, "PixelKernels::SelfTest () - ConvertBGRASum result mismatch!");
+
+		uint32_t expectedRGBASums[3] = { 0, 0, 0 };
+		uint32_t rgbaSums[3] = { 0, 0, 0 };
+		SumRGBA_Scalar (&src[0], pixelCount, expectedRGBASums);
+		mSumRGBA (&src[0], pixelCount, rgbaSums);
+		CHECKMSG (memcmp (rgbaSums, expectedRGBASums, sizeof (rgbaSums)) == 0, "PixelKernels::SelfTest () - SumRGBA result mismatch!");
+	}
+}
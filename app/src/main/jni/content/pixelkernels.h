@@ -0,0 +1,87 @@
+#pragma once
+
+//The SIMD implementations available on the target architecture (selected at runtime by CPU features)
+#if defined (__arm__) || defined (__aarch64__)
+#	define PIXEL_KERNELS_NEON 1
+#elif defined (__i386__) || defined (__x86_64__)
+#	define PIXEL_KERNELS_SSSE3 1
+#endif
+
+///
+/// Pixel conversion kernels of the C64 screen.
+///
+/// The implementation (NEON, SSSE3 or scalar) is chosen once from the features of the running CPU.
+class PixelKernels {
+//Definitions
+public:
+	/// Convert pixelCount BGRA pixels to RGBA with opaque alpha. Returns true, when the content of dst changed.
+	typedef bool (*ConvertBGRAFunc) (const uint8_t* src, uint8_t* dst, uint32_t pixelCount);
+
+	/// Convert pixelCount BGRA pixels to RGBA with opaque alpha and add the red, green and blue channel sums of the source to sums[0..2].
+	typedef void (*ConvertBGRASumFunc) (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums);
+
+	/// Add the red, green and blue channel sums of pixelCount pixels to sums[0..2] without conversion.
+	typedef void (*SumFunc) (const uint8_t* src, uint32_t pixelCount, uint32_t* sums);
+
+//Data
+private:
+	ConvertBGRAFunc mConvertBGRA;
+	ConvertBGRASumFunc mConvertBGRASum;
+	SumFunc mSumRGBA;
+	string mName;
+
+//Construction
+private:
+	PixelKernels ();
+
+public:
+	static const PixelKernels& Get () {
+		static PixelKernels inst;
+		return inst;
+	}
+
+//Interface
+public:
+	/// The name of the selected implementation.
+	const string& Name () const {
+		return mName;
+	}
+
+	bool ConvertBGRA (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) const {
+		return mConvertBGRA (src, dst, pixelCount);
+	}
+
+	void ConvertBGRASum (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums) const {
+		mConvertBGRASum (src, dst, pixelCount, sums);
+	}
+
+	void SumRGBA (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) const {
+		mSumRGBA (src, pixelCount, sums);
+	}
+
+	/// The channels are expanded to 8 bits before summing, so the results are comparable with the 32 bit formats.
+	void SumRGB565 (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) const {
+		SumRGB565_Scalar (src, pixelCount, sums);
+	}
+
+//Implementations
+public:
+	static bool ConvertBGRA_Scalar (const uint8_t* src, uint8_t* dst, uint32_t pixelCount);
+	static void ConvertBGRASum_Scalar (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums);
+	static void SumRGBA_Scalar (const uint8_t* src, uint32_t pixelCount, uint32_t* sums);
+	static void SumRGB565_Scalar (const uint8_t* src, uint32_t pixelCount, uint32_t* sums);
+#ifdef PIXEL_KERNELS_NEON
+	static bool ConvertBGRA_NEON (const uint8_t* src, uint8_t* dst, uint32_t pixelCount);
+	static void ConvertBGRASum_NEON (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums);
+	static void SumRGBA_NEON (const uint8_t* src, uint32_t pixelCount, uint32_t* sums);
+#endif //PIXEL_KERNELS_NEON
+#ifdef PIXEL_KERNELS_SSSE3
+	static bool ConvertBGRA_SSSE3 (const uint8_t* src, uint8_t* dst, uint32_t pixelCount);
+	static void ConvertBGRASum_SSSE3 (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums);
+	static void SumRGBA_SSSE3 (const uint8_t* src, uint32_t pixelCount, uint32_t* sums);
+#endif //PIXEL_KERNELS_SSSE3
+
+//Helper methods
+private:
+	void SelfTest () const;
+};
@@ -0,0 +1,111 @@
+#include "../pch.h"
+#include "pixelkernels.h"
+
+#ifdef PIXEL_KERNELS_NEON
+
+#include <arm_neon.h>
+
+bool PixelKernels::ConvertBGRA_NEON (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+	const uint8x16_t alpha = vdupq_n_u8 (0xFF);
+	uint8x16_t diff = vdupq_n_u8 (0);
+
+	//16 pixels in each step: deinterleave the channels, swap blue and red, force alpha
+	uint32_t x = 0;
+	for (; x + 16 <= pixelCount; x += 16) {
+		uint8x16x4_t pixels = vld4q_u8 (src);
+		uint8x16x4_t old = vld4q_u8 (dst);
+
+		uint8x16x4_t converted;
+		converted.val[0] = pixels.val[2];
+		converted.val[1] = pixels.val[1];
+		converted.val[2] = pixels.val[0];
+		converted.val[3] = alpha;
+
+		diff = vorrq_u8 (diff, veorq_u8 (old.val[0], converted.val[0]));
+		diff = vorrq_u8 (diff, veorq_u8 (old.val[1], converted.val[1]));
+		diff = vorrq_u8 (diff, veorq_u8 (old.val[2], converted.val[2]));
+		diff = vorrq_u8 (diff, veorq_u8 (old.val[3], converted.val[3]));
+
+		vst4q_u8 (dst, converted);
+
+		src += 64;
+		dst += 64;
+	}
+
+	uint64x2_t diff64 = vreinterpretq_u64_u8 (diff);
+	bool changed = (vgetq_lane_u64 (diff64, 0) | vgetq_lane_u64 (diff64, 1)) != 0;
+
+	//Remaining pixels with the scalar kernel
+	if (x < pixelCount)
+		changed = ConvertBGRA_Scalar (src, dst, pixelCount - x) || changed;
+
+	return changed;
+}
+
+void PixelKernels::ConvertBGRASum_NEON (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums) {
+	const uint8x16_t alpha = vdupq_n_u8 (0xFF);
+	uint32x4_t redSum = vdupq_n_u32 (0);
+	uint32x4_t greenSum = vdupq_n_u32 (0);
+	uint32x4_t blueSum = vdupq_n_u32 (0);
+
+	//16 pixels in each step: swizzle like ConvertBGRA_NEON, then widen the channels pairwise (u8 -> u16 -> u32) into the sums
+	uint32_t x = 0;
+	for (; x + 16 <= pixelCount; x += 16) {
+		uint8x16x4_t pixels = vld4q_u8 (src);
+
+		blueSum = vpadalq_u16 (blueSum, vpaddlq_u8 (pixels.val[0]));
+		greenSum = vpadalq_u16 (greenSum, vpaddlq_u8 (pixels.val[1]));
+		redSum = vpadalq_u16 (redSum, vpaddlq_u8 (pixels.val[2]));
+
+		uint8x16x4_t converted;
+		converted.val[0] = pixels.val[2];
+		converted.val[1] = pixels.val[1];
+		converted.val[2] = pixels.val[0];
+		converted.val[3] = alpha;
+		vst4q_u8 (dst, converted);
+
+		src += 64;
+		dst += 64;
+	}
+
+	//Horizontal add of the lanes
+	uint64x2_t red = vpaddlq_u32 (redSum);
+	uint64x2_t green = vpaddlq_u32 (greenSum);
+	uint64x2_t blue = vpaddlq_u32 (blueSum);
+	sums[0] += (uint32_t) (vgetq_lane_u64 (red, 0) + vgetq_lane_u64 (red, 1));
+	sums[1] += (uint32_t) (vgetq_lane_u64 (green, 0) + vgetq_lane_u64 (green, 1));
+	sums[2] += (uint32_t) (vgetq_lane_u64 (blue, 0) + vgetq_lane_u64 (blue, 1));
+
+	//Remaining pixels with the scalar kernel
+	if (x < pixelCount)
+		ConvertBGRASum_Scalar (src, dst, pixelCount - x, sums);
+}
+
+void PixelKernels::SumRGBA_NEON (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) {
+	uint32x4_t redSum = vdupq_n_u32 (0);
+	uint32x4_t greenSum = vdupq_n_u32 (0);
+	uint32x4_t blueSum = vdupq_n_u32 (0);
+
+	uint32_t x = 0;
+	for (; x + 16 <= pixelCount; x += 16) {
+		uint8x16x4_t pixels = vld4q_u8 (src);
+
+		redSum = vpadalq_u16 (redSum, vpaddlq_u8 (pixels.val[0]));
+		greenSum = vpadalq_u16 (greenSum, vpaddlq_u8 (pixels.val[1]));
+		blueSum = vpadalq_u16 (blueSum, vpaddlq_u8 (pixels.val[2]));
+
+		src += 64;
+	}
+
+	uint64x2_t red = vpaddlq_u32 (redSum);
+	uint64x2_t green = vpaddlq_u32 (greenSum);
+	uint64x2_t blue = vpaddlq_u32 (blueSum);
+	sums[0] += (uint32_t) (vgetq_lane_u64 (red, 0) + vgetq_lane_u64 (red, 1));
+	sums[1] += (uint32_t) (vgetq_lane_u64 (green, 0) + vgetq_lane_u64 (green, 1));
+	sums[2] += (uint32_t) (vgetq_lane_u64 (blue, 0) + vgetq_lane_u64 (blue, 1));
+
+	if (x < pixelCount)
+		SumRGBA_Scalar (src, pixelCount - x, sums);
+}
+
+#endif //PIXEL_KERNELS_NEON
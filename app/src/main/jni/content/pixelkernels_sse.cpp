@@ -0,0 +1,109 @@
+#include "../pch.h"
+#include "pixelkernels.h"
+
+#ifdef PIXEL_KERNELS_SSSE3
+
+#include <tmmintrin.h>
+
+//The x86 ABI baseline has no SSSE3, so only this function is compiled for it (selected at runtime)
+__attribute__ ((target ("ssse3")))
+bool PixelKernels::ConvertBGRA_SSSE3 (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+	const __m128i shuffle = _mm_setr_epi8 (2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	const __m128i alpha = _mm_set1_epi32 ((int) 0xFF000000);
+	__m128i diff = _mm_setzero_si128 ();
+
+	//8 pixels in each step: swap blue and red with a byte shuffle, force alpha
+	uint32_t x = 0;
+	for (; x + 8 <= pixelCount; x += 8) {
+		__m128i pixels0 = _mm_loadu_si128 ((const __m128i*) src);
+		__m128i pixels1 = _mm_loadu_si128 ((const __m128i*) (src + 16));
+
+		__m128i converted0 = _mm_or_si128 (_mm_shuffle_epi8 (pixels0, shuffle), alpha);
+		__m128i converted1 = _mm_or_si128 (_mm_shuffle_epi8 (pixels1, shuffle), alpha);
+
+		diff = _mm_or_si128 (diff, _mm_xor_si128 (_mm_loadu_si128 ((const __m128i*) dst), converted0));
+		diff = _mm_or_si128 (diff, _mm_xor_si128 (_mm_loadu_si128 ((const __m128i*) (dst + 16)), converted1));
+
+		_mm_storeu_si128 ((__m128i*) dst, converted0);
+		_mm_storeu_si128 ((__m128i*) (dst + 16), converted1);
+
+		src += 32;
+		dst += 32;
+	}
+
+	bool changed = _mm_movemask_epi8 (_mm_cmpeq_epi8 (diff, _mm_setzero_si128 ())) != 0xFFFF;
+
+	//Remaining pixels with the scalar kernel
+	if (x < pixelCount)
+		changed = ConvertBGRA_Scalar (src, dst, pixelCount - x) || changed;
+
+	return changed;
+}
+
+__attribute__ ((target ("ssse3")))
+void PixelKernels::ConvertBGRASum_SSSE3 (const uint8_t* src, uint8_t* dst, uint32_t pixelCount, uint32_t* sums) {
+	const __m128i shuffle = _mm_setr_epi8 (2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+	const __m128i alpha = _mm_set1_epi32 ((int) 0xFF000000);
+	const __m128i redMask = _mm_set1_epi32 (0x00FF0000);
+	const __m128i greenMask = _mm_set1_epi32 (0x0000FF00);
+	const __m128i blueMask = _mm_set1_epi32 (0x000000FF);
+	const __m128i zero = _mm_setzero_si128 ();
+	__m128i redSum = zero;
+	__m128i greenSum = zero;
+	__m128i blueSum = zero;
+
+	//4 pixels in each step: the channels are masked out and summed horizontally by psadbw into 64 bit lanes
+	uint32_t x = 0;
+	for (; x + 4 <= pixelCount; x += 4) {
+		__m128i pixels = _mm_loadu_si128 ((const __m128i*) src);
+
+		redSum = _mm_add_epi64 (redSum, _mm_sad_epu8 (_mm_and_si128 (pixels, redMask), zero));
+		greenSum = _mm_add_epi64 (greenSum, _mm_sad_epu8 (_mm_and_si128 (pixels, greenMask), zero));
+		blueSum = _mm_add_epi64 (blueSum, _mm_sad_epu8 (_mm_and_si128 (pixels, blueMask), zero));
+
+		_mm_storeu_si128 ((__m128i*) dst, _mm_or_si128 (_mm_shuffle_epi8 (pixels, shuffle), alpha));
+
+		src += 16;
+		dst += 16;
+	}
+
+	//Add the two 64 bit lanes (the sums of a row fit into 32 bits)
+	sums[0] += (uint32_t) _mm_cvtsi128_si32 (redSum) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (redSum, 8));
+	sums[1] += (uint32_t) _mm_cvtsi128_si32 (greenSum) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (greenSum, 8));
+	sums[2] += (uint32_t) _mm_cvtsi128_si32 (blueSum) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (blueSum, 8));
+
+	//Remaining pixels with the scalar kernel
+	if (x < pixelCount)
+		ConvertBGRASum_Scalar (src, dst, pixelCount - x, sums);
+}
+
+__attribute__ ((target ("ssse3")))
+void PixelKernels::SumRGBA_SSSE3 (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) {
+	const __m128i redMask = _mm_set1_epi32 (0x000000FF);
+	const __m128i greenMask = _mm_set1_epi32 (0x0000FF00);
+	const __m128i blueMask = _mm_set1_epi32 (0x00FF0000);
+	const __m128i zero = _mm_setzero_si128 ();
+	__m128i redSum = zero;
+	__m128i greenSum = zero;
+	__m128i blueSum = zero;
+
+	uint32_t x = 0;
+	for (; x + 4 <= pixelCount; x += 4) {
+		__m128i pixels = _mm_loadu_si128 ((const __m128i*) src);
+
+		redSum = _mm_add_epi64 (redSum, _mm_sad_epu8 (_mm_and_si128 (pixels, redMask), zero));
+		greenSum = _mm_add_epi64 (greenSum, _mm_sad_epu8 (_mm_and_si128 (pixels, greenMask), zero));
+		blueSum = _mm_add_epi64 (blueSum, _mm_sad_epu8 (_mm_and_si128 (pixels, blueMask), zero));
+
+		src += 16;
+	}
+
+	sums[0] += (uint32_t) _mm_cvtsi128_si32 (redSum) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (redSum, 8));
+	sums[1] += (uint32_t) _mm_cvtsi128_si32 (greenSum) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (greenSum, 8));
+	sums[2] += (uint32_t) _mm_cvtsi128_si32 (blueSum) + (uint32_t) _mm_cvtsi128_si32 (_mm_srli_si128 (blueSum, 8));
+
+	if (x < pixelCount)
+		SumRGBA_Scalar (src, pixelCount - x, sums);
+}
+
+#endif //PIXEL_KERNELS_SSSE3
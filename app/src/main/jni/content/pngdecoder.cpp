@@ -0,0 +1,292 @@
+#include "../pch.h"
+#include "pngdecoder.h"
+
+#include <zlib.h>
+
+//The idle decoders of DecodeShared (with their staging buffers)
+static mutex s_decoder_lock;
+static vector<unique_ptr<PNGDecoder>> s_decoders;
+
+static inline uint8_t Premultiply (uint32_t color, uint32_t alpha) {
+	//The rounding of Skia (the bitmaps of BitmapFactory)
+	uint32_t prod = color * alpha + 128;
+	return (uint8_t) ((prod + (prod >> 8)) >> 8);
+}
+
+bool PNGDecoder::Decode (const uint8_t* png, size_t size, vector<uint8_t>& pixels, int& width, int& height) {
+	const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	if (png == nullptr || size < 8 || memcmp (png, signature, sizeof (signature)) != 0)
+		return false;
+
+	//The chunks before the image data: the header, the palette and the transparency
+	Header header;
+	bool hasHeader = false;
+	mHasColorKey = false;
+	memset (mPalette, 0, sizeof (mPalette));
+
+	size_t pos = 8;
+	size_t dataPos = 0;
+	while (pos + 12 <= size) {
+		uint32_t length = ReadU32 (png + pos);
+		if (length > size - pos - 12)
+			return false;
+
+		const uint8_t* type = png + pos + 4;
+		const uint8_t* data = png + pos + 8;
+		if (memcmp (type, "IHDR", 4) == 0) {
+			if (!ReadHeader (data, length, header))
+				return false;
+			hasHeader = true;
+		} else if (memcmp (type, "PLTE", 4) == 0) {
+			for (uint32_t i = 0, count = min (length / 3, (uint32_t) 256); i < count; ++i) {
+				memcpy (&mPalette[i * 4], data + i * 3, 3);
+				mPalette[i * 4 + 3] = 0xFF;
+			}
+		} else if (memcmp (type, "tRNS", 4) == 0 && hasHeader) {
+			if (header.colorType == 3) {
+				for (uint32_t i = 0, count = min (length, (uint32_t) 256); i < count; ++i)
+					mPalette[i * 4 + 3] = data[i];
+			} else if ((header.colorType == 0 && length >= 2) || (header.colorType == 2 && length >= 6)) {
+				for (int i = 0; i < header.channels; ++i)
+					mColorKey[i] = (uint16_t) (data[i * 2] << 8 | data[i * 2 + 1]);
+				mHasColorKey = true;
+			}
+		} else if (memcmp (type, "IDAT", 4) == 0) {
+			dataPos = pos;
+			break;
+		} else if (memcmp (type, "IEND", 4) == 0) {
+			break;
+		}
+
+		pos += 12 + length;
+	}
+
+	if (!hasHeader || dataPos == 0)
+		return false;
+
+	z_stream stream;
+	memset (&stream, 0, sizeof (stream));
+	if (inflateInit (&stream) != Z_OK)
+		return false;
+
+	size_t stride = header.rowBytes + 1;
+	mRows.resize (stride * 2);
+	uint8_t* row = &mRows[0];
+	uint8_t* prev = &mRows[stride];
+	memset (prev, 0, stride); //The row above the first one is zero for the filters
+
+	pixels.resize ((size_t) header.width * header.height * 4);
+
+	//The image data chunks are consecutive, they are inflated row by row without collecting them
+	pos = dataPos;
+	bool valid = true;
+	for (int y = 0; y < header.height && valid; ++y) {
+		stream.next_out = row;
+		stream.avail_out = (uInt) stride;
+		while (stream.avail_out > 0) {
+			if (stream.avail_in == 0) {
+				if (pos + 12 > size || memcmp (png + pos + 4, "IDAT", 4) != 0 || ReadU32 (png + pos) > size - pos - 12) {
+					valid = false;
+					break;
+				}
+
+				stream.next_in = (Bytef*) (png + pos + 8);
+				stream.avail_in = (uInt) ReadU32 (png + pos);
+				pos += 12 + stream.avail_in;
+				continue;
+			}
+
+			int result = inflate (&stream, Z_NO_FLUSH);
+			if (result == Z_STREAM_END ? stream.avail_out > 0 : result != Z_OK) {
+				valid = false;
+				break;
+			}
+		}
+
+		if (row[0] > 4) //Unknown filter type
+			valid = false;
+
+		if (!valid)
+			break;
+
+		Unfilter (row[0], row + 1, prev + 1, header.rowBytes, header.pixelBytes);
+		ConvertRow (header, row + 1, &pixels[(size_t) y * header.width * 4]);
+		swap (row, prev);
+	}
+
+	inflateEnd (&stream);
+
+	if (!valid) {
+		pixels.clear ();
+		return false;
+	}
+
+	width = header.width;
+	height = header.height;
+	return true;
+}
+
+bool PNGDecoder::DecodeShared (const uint8_t* png, size_t size, vector<uint8_t>& pixels, int& width, int& height) {
+	unique_ptr<PNGDecoder> decoder;
+	{
+		lock_guard<mutex> lock (s_decoder_lock);
+		if (!s_decoders.empty ()) {
+			decoder = move (s_decoders.back ());
+			s_decoders.pop_back ();
+		}
+	}
+
+	if (!decoder)
+		decoder.reset (new PNGDecoder ());
+
+	bool result = decoder->Decode (png, size, pixels, width, height);
+
+	lock_guard<mutex> lock (s_decoder_lock);
+	s_decoders.push_back (move (decoder));
+	return result;
+}
+
+bool PNGDecoder::ReadHeader (const uint8_t* data, uint32_t length, Header& header) {
+	if (length < 13)
+		return false;
+
+	//Larger than any texture is not decoded (the sizes stay in the range of int)
+	uint32_t width = ReadU32 (data);
+	uint32_t height = ReadU32 (data + 4);
+	if (width == 0 || height == 0 || width > 16384 || height > 16384)
+		return false;
+
+	//Deflate, adaptive filtering, not interlaced
+	if (data[10] != 0 || data[11] != 0 || data[12] != 0)
+		return false;
+
+	header.width = (int) width;
+	header.height = (int) height;
+	header.bitDepth = data[8];
+	header.colorType = data[9];
+
+	uint32_t depths = 0; //The valid bit depths of the color type as bits
+	switch (header.colorType) {
+		case 0: header.channels = 1; depths = 1 << 1 | 1 << 2 | 1 << 4 | 1 << 8 | 1 << 16; break; //Gray
+		case 2: header.channels = 3; depths = 1 << 8 | 1 << 16; break; //RGB
+		case 3: header.channels = 1; depths = 1 << 1 | 1 << 2 | 1 << 4 | 1 << 8; break; //Palette
+		case 4: header.channels = 2; depths = 1 << 8 | 1 << 16; break; //Gray and alpha
+		case 6: header.channels = 4; depths = 1 << 8 | 1 << 16; break; //RGBA
+		default: return false;
+	}
+
+	if (header.bitDepth > 16 || (depths & (1u << header.bitDepth)) == 0)
+		return false;
+
+	size_t bits = (size_t) header.channels * header.bitDepth;
+	header.rowBytes = ((size_t) header.width * bits + 7) / 8;
+	header.pixelBytes = max (bits / 8, (size_t) 1);
+	return true;
+}
+
+void PNGDecoder::Unfilter (uint8_t filter, uint8_t* row, const uint8_t* prev, size_t rowBytes, size_t pixelBytes) {
+	switch (filter) {
+		case 1: //Sub
+			for (size_t i = pixelBytes; i < rowBytes; ++i)
+				row[i] += row[i - pixelBytes];
+			break;
+		case 2: //Up
+			for (size_t i = 0; i < rowBytes; ++i)
+				row[i] += prev[i];
+			break;
+		case 3: //Average
+			for (size_t i = 0; i < pixelBytes && i < rowBytes; ++i)
+				row[i] += (uint8_t) (prev[i] >> 1);
+			for (size_t i = pixelBytes; i < rowBytes; ++i)
+				row[i] += (uint8_t) ((row[i - pixelBytes] + prev[i]) >> 1);
+			break;
+		case 4: //Paeth (the predictor is the row above in the first pixel)
+			for (size_t i = 0; i < pixelBytes && i < rowBytes; ++i)
+				row[i] += prev[i];
+			for (size_t i = pixelBytes; i < rowBytes; ++i) {
+				int a = row[i - pixelBytes];
+				int b = prev[i];
+				int c = prev[i - pixelBytes];
+				int pa = abs (b - c);
+				int pb = abs (a - c);
+				int pc = abs (a + b - 2 * c);
+				int ab = pa <= pb ? a : b;
+				int pab = pa <= pb ? pa : pb;
+				row[i] += (uint8_t) (pab <= pc ? ab : c);
+			}
+			break;
+		default: //None
+			break;
+	}
+}
+
+void PNGDecoder::ConvertRow (const Header& header, const uint8_t* row, uint8_t* dst) const {
+	if (header.colorType == 6 && header.bitDepth == 8) { //The assets of the game
+		for (int x = 0; x < header.width; ++x, row += 4, dst += 4) {
+			uint32_t alpha = row[3];
+			dst[0] = Premultiply (row[0], alpha);
+			dst[1] = Premultiply (row[1], alpha);
+			dst[2] = Premultiply (row[2], alpha);
+			dst[3] = (uint8_t) alpha;
+		}
+		return;
+	}
+
+	int depth = header.bitDepth;
+	int channels = header.channels;
+	uint32_t maxSample = (1u << depth) - 1;
+	auto sample = [row, depth, channels] (int x, int channel) -> uint32_t {
+		size_t index = (size_t) x * channels + channel;
+		if (depth == 16)
+			return (uint32_t) row[index * 2] << 8 | row[index * 2 + 1];
+		if (depth == 8)
+			return row[index];
+
+		size_t bit = index * depth;
+		return (uint32_t) (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+	};
+
+	for (int x = 0; x < header.width; ++x, dst += 4) {
+		uint32_t r, g, b, a = 255;
+		if (header.colorType == 3) {
+			const uint8_t* color = &mPalette[sample (x, 0) * 4];
+			r = color[0];
+			g = color[1];
+			b = color[2];
+			a = color[3];
+		} else {
+			uint32_t samples[4] = { 0, 0, 0, 0 };
+			for (int c = 0; c < channels; ++c)
+				samples[c] = sample (x, c);
+
+			if (mHasColorKey && (channels == 1 || channels == 3)) {
+				bool transparent = true;
+				for (int c = 0; c < channels; ++c)
+					transparent = transparent && samples[c] == mColorKey[c];
+				if (transparent)
+					a = 0;
+			}
+
+			//Scaled to 8 bits
+			for (int c = 0; c < channels; ++c)
+				samples[c] = depth == 16 ? samples[c] >> 8 : samples[c] * 255 / maxSample;
+
+			if (channels <= 2) { //Gray
+				r = g = b = samples[0];
+				if (channels == 2)
+					a = samples[1];
+			} else {
+				r = samples[0];
+				g = samples[1];
+				b = samples[2];
+				if (channels == 4)
+					a = samples[3];
+			}
+		}
+
+		dst[0] = Premultiply (r, a);
+		dst[1] = Premultiply (g, a);
+		dst[2] = Premultiply (b, a);
+		dst[3] = (uint8_t) a;
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+///
+/// Decodes PNG images from memory (a mapped asset) into RGBA pixels.
+///
+/// The pixels are premultiplied by alpha like the ARGB_8888 bitmaps of BitmapFactory, so the textures are the same on
+/// both of the image paths. The rows are inflated one by one into a staging buffer of two rows (the current and the
+/// previous one for the filters), which is kept by the decoder for the next images. All of the color types and bit
+/// depths are read (16 bit samples are cut to 8 bits), interlaced images are not.
+class PNGDecoder {
+//Definitions
+private:
+	struct Header {
+		int width;
+		int height;
+		int bitDepth;
+		int colorType;
+		int channels;
+		size_t rowBytes; ///< The bytes of a row without the filter byte.
+		size_t pixelBytes; ///< The distance of the filtered bytes (at least 1).
+	};
+
+//Data
+private:
+	vector<uint8_t> mRows; ///< The staging buffer: the current and the previous row with their filter bytes.
+	uint8_t mPalette[256 * 4]; ///< RGBA
+	bool mHasColorKey;
+	uint16_t mColorKey[3]; ///< The transparent gray or RGB samples (tRNS).
+
+//Construction
+public:
+	PNGDecoder () : mHasColorKey (false) {}
+
+//Interface
+public:
+	/// Decode the image into pixels (width * height * 4 bytes), returns false, when the data is not a supported PNG.
+	bool Decode (const uint8_t* png, size_t size, vector<uint8_t>& pixels, int& width, int& height);
+
+	/// Decode by one of the shared decoders (thread safe, the staging buffers are reused by the threads in turn).
+	static bool DecodeShared (const uint8_t* png, size_t size, vector<uint8_t>& pixels, int& width, int& height);
+
+//Helper methods
+private:
+	static uint32_t ReadU32 (const uint8_t* data) {
+		return (uint32_t) data[0] << 24 | (uint32_t) data[1] << 16 | (uint32_t) data[2] << 8 | (uint32_t) data[3];
+	}
+
+	static bool ReadHeader (const uint8_t* data, uint32_t length, Header& header);
+	static void Unfilter (uint8_t filter, uint8_t* row, const uint8_t* prev, size_t rowBytes, size_t pixelBytes);
+
+	/// Convert the unfiltered row into premultiplied RGBA.
+	void ConvertRow (const Header& header, const uint8_t* row, uint8_t* dst) const;
+};
@@ -0,0 +1,111 @@
+#include "../pch.h"
+#include "spritebatch.h"
+#include "../management/glstate.h"
+
+//The process wide switch of the batching
+static atomic<bool> s_sprite_batch_enabled (true);
+
+void SpriteBatch::Init () {
+	if (IsInited ())
+		return;
+
+	mVertices.reserve (MaxQuads * 4);
+	mRuns.reserve (MaxQuads);
+
+	//Two triangles for each quad of the strip order (0, 1, 2, 3): 0-1-2 and 2-1-3
+	vector<GLushort> indices (MaxQuads * 6);
+	for (uint32_t quad = 0; quad < MaxQuads; ++quad) {
+		GLushort first = (GLushort) (quad * 4);
+		GLushort* index = &indices[quad * 6];
+		index[0] = first;
+		index[1] = first + 1;
+		index[2] = first + 2;
+		index[3] = first + 2;
+		index[4] = first + 1;
+		index[5] = first + 3;
+	}
+
+	glGenBuffers (1, &mIndexBuffer);
+	GLState::Get ().BindBuffer (GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	glBufferData (GL_ELEMENT_ARRAY_BUFFER, indices.size () * sizeof (GLushort), &indices[0], GL_STATIC_DRAW);
+
+	glGenBuffers (1, &mVertexBuffer);
+	GLState::Get ().BindBuffer (GL_ARRAY_BUFFER, mVertexBuffer);
+	glBufferData (GL_ARRAY_BUFFER, MaxQuads * 4 * sizeof (Vertex), nullptr, GL_DYNAMIC_DRAW);
+}
+
+void SpriteBatch::Shutdown () {
+	mVertices.clear ();
+	mRuns.clear ();
+
+	if (mVertexBuffer > 0) {
+		GLState::Get ().DeleteBuffers (1, &mVertexBuffer);
+		mVertexBuffer = 0;
+	}
+
+	if (mIndexBuffer > 0) {
+		GLState::Get ().DeleteBuffers (1, &mIndexBuffer);
+		mIndexBuffer = 0;
+	}
+}
+
+void SpriteBatch::Draw (GLuint texID, const float* vertices, const float* texCoords, const Vector2D& pos, float rotation, const Vector2D& scale) {
+	assert (IsInited ());
+	assert (vertices != nullptr && texCoords != nullptr);
+
+	uint32_t quad = (uint32_t) (mVertices.size () / 4);
+	if (quad >= MaxQuads) {
+		Flush ();
+		quad = 0;
+	}
+
+	if (mRuns.empty () || mRuns.back ().texID != texID)
+		mRuns.push_back ({ texID, quad, 0 });
+	++mRuns.back ().quadCount;
+
+	//Scale, rotate, then translate (the matrix order of Mesh2D::Render)
+	float angle = rotation * (float) M_PI / 180.0f;
+	float cosAngle = cos (angle);
+	float sinAngle = sin (angle);
+
+	for (int i = 0; i < 4; ++i) {
+		float x = vertices[i * 2] * scale.x;
+		float y = vertices[i * 2 + 1] * scale.y;
+		mVertices.push_back ({ x * cosAngle - y * sinAngle + pos.x, x * sinAngle + y * cosAngle + pos.y, texCoords[i * 2], texCoords[i * 2 + 1] });
+	}
+}
+
+void SpriteBatch::Flush () {
+	if (mRuns.empty ())
+		return;
+
+	GLState::Get ().Enable (GL_BLEND);
+	GLState::Get ().BlendFunc (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	GLState::Get ().Enable (GL_TEXTURE_2D);
+
+	//Replace the content of the streaming buffer (the driver does not have to wait for the draws of the previous flush)
+	GLState::Get ().BindBuffer (GL_ARRAY_BUFFER, mVertexBuffer);
+	glBufferData (GL_ARRAY_BUFFER, mVertices.size () * sizeof (Vertex), &mVertices[0], GL_DYNAMIC_DRAW);
+
+	glVertexPointer (2, GL_FLOAT, sizeof (Vertex), (const GLvoid*) offsetof (Vertex, x));
+	GLState::Get ().EnableClientState (GL_VERTEX_ARRAY);
+	GLState::Get ().TexCoordPointer (2, GL_FLOAT, sizeof (Vertex), (const GLvoid*) offsetof (Vertex, u));
+	GLState::Get ().EnableClientState (GL_TEXTURE_COORD_ARRAY);
+
+	GLState::Get ().BindBuffer (GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	for (const Run& run : mRuns) {
+		GLState::Get ().BindTexture (run.texID);
+		glDrawElements (GL_TRIANGLES, (GLsizei) (run.quadCount * 6), GL_UNSIGNED_SHORT, (const GLvoid*) (run.firstQuad * 6 * sizeof (GLushort)));
+	}
+
+	mVertices.clear ();
+	mRuns.clear ();
+}
+
+bool SpriteBatch::IsEnabled () {
+	return s_sprite_batch_enabled.load (memory_order_relaxed);
+}
+
+void SpriteBatch::SetEnabled (bool enabled) {
+	s_sprite_batch_enabled.store (enabled, memory_order_relaxed);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "vector2D.h"
+
+///
+/// Collects textured quads and draws them with as few GL calls as possible.
+///
+/// The quads are transformed on the CPU (position, rotation, scale of the meshes), so no matrix calls are needed. A flush
+/// uploads all of the collected vertices into one streaming VBO at once, then draws each run of quads with the same texture
+/// by one indexed draw call, in the order of the quads. The blend, texture and client array states are set once per flush.
+class SpriteBatch {
+//Definitions
+public:
+	enum : uint32_t {
+		MaxQuads = 256 ///< The quads of one flush (the batch flushes itself, when it is full).
+	};
+
+private:
+	struct Vertex {
+		float x;
+		float y;
+		float u;
+		float v;
+	};
+
+	/// Quads drawn with the same texture.
+	struct Run {
+		GLuint texID;
+		uint32_t firstQuad;
+		uint32_t quadCount;
+	};
+
+//Data
+private:
+	GLuint mVertexBuffer;
+	GLuint mIndexBuffer;
+
+	vector<Vertex> mVertices; ///< The vertices of the collected quads (four for each).
+	vector<Run> mRuns;
+
+//Construction
+public:
+	SpriteBatch () : mVertexBuffer (0), mIndexBuffer (0) {}
+
+//Interface
+public:
+	/// Create the GL buffers (on the GL thread, with a current context).
+	void Init ();
+	void Shutdown ();
+
+	bool IsInited () const {
+		return mVertexBuffer > 0;
+	}
+
+	/// Add a quad of a triangle strip (4 vertices and texture coordinates) transformed like Mesh2D::Render does (rotation in degrees).
+	void Draw (GLuint texID, const float* vertices, const float* texCoords, const Vector2D& pos, float rotation, const Vector2D& scale);
+
+	/// Draw the collected quads (call it before anything else is drawn and at the end of the frame).
+	void Flush ();
+
+	/// Batching of the meshes is on (process wide switch to measure the renderer with and without it).
+	static bool IsEnabled ();
+	static void SetEnabled (bool enabled);
+};
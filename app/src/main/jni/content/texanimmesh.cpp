@@ -1,6 +1,7 @@
 #include "../pch.h"
 #include "texanimmesh.h"
 #include "color.h"
+#include "../management/glstate.h"
 
 void TexAnimMesh::Init () {
 	Mesh2D::Init ();
@@ -10,13 +11,10 @@ void TexAnimMesh::Init () {
 }
 
 void TexAnimMesh::Shutdown () {
-	if (mVbo.size () > 0) {
-		glDeleteBuffers (mVbo.size (), &mVbo[0]);
-		mVbo.clear ();
-	}
+	DeleteTexturedVBO (mVbo);
 
 	if (mTex > 0) {
-		glDeleteTextures (1, &mTex);
+		GLState::Get ().DeleteTextures (1, &mTex);
 		mTex = 0;
 	}
 
@@ -24,11 +22,33 @@ void TexAnimMesh::Shutdown () {
 }
 
 void TexAnimMesh::SetPixels (int width, int height, int bpp, const uint8_t *pixels) {
-	assert (mWidth == width && mHeight == height && (bpp == 24 || bpp == 32) && pixels != nullptr);
+	assert (mWidth == width && mHeight == height && pixels != nullptr);
+
+	GLint format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	GetTextureFormat (bpp, format, type);
+
+	GLState::Get ().BindTexture (mTex);
+	glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight, format, type, pixels);
+}
 
-	GLint format = bpp == 24 ? GL_RGB : GL_RGBA;
-	glBindTexture (GL_TEXTURE_2D, mTex);
-	glTexSubImage2D (GL_TEXTURE_2D, 0, 0, 0, mWidth, mHeight, format, GL_UNSIGNED_BYTE, pixels);
+void TexAnimMesh::SetPixelRows (const vector<pair<uint32_t, uint32_t>>& rowSpans, int bpp, const uint8_t* pixels) {
+	assert (pixels != nullptr);
+
+	if (rowSpans.empty ())
+		return;
+
+	//Full width rows are contiguous in the frame, so every span is one upload without repacking
+	GLint format = GL_RGBA;
+	GLenum type = GL_UNSIGNED_BYTE;
+	GetTextureFormat (bpp, format, type);
+	size_t pitch = (size_t) mWidth * (bpp / 8);
+
+	GLState::Get ().BindTexture (mTex);
+	for (const auto& span : rowSpans) {
+		assert (span.second > 0 && span.first + span.second <= (uint32_t) mHeight);
+		glTexSubImage2D (GL_TEXTURE_2D, 0, 0, (GLint) span.first, mWidth, (GLsizei) span.second, format, type, pixels + span.first * pitch);
+	}
 }
 
 void TexAnimMesh::RenderMesh () {
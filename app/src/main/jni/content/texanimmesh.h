@@ -23,6 +23,9 @@ public:
 
 	void SetPixels (int width, int height, int bpp, const uint8_t* pixels);
 
+	/// Upload only the given row spans (first row, row count) of a full frame.
+	void SetPixelRows (const vector<pair<uint32_t, uint32_t>>& rowSpans, int bpp, const uint8_t* pixels);
+
 protected:
 	virtual void RenderMesh () override;
 };
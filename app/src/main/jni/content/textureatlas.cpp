@@ -0,0 +1,139 @@
+#include "../pch.h"
+#include "textureatlas.h"
+#include "../management/game.h"
+#include "../management/glstate.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+uint32_t TextureAtlas::Add (const string& asset) {
+	assert (!IsBuilt ());
+
+	mAssets.push_back (asset);
+	return (uint32_t) (mAssets.size () - 1);
+}
+
+void TextureAtlas::Build () {
+	if (IsBuilt () || mAssets.empty ())
+		return;
+
+	IContentManager& contentManager = Game::ContentManager ();
+
+	vector<Image> images;
+	mRegions.clear ();
+	for (const string& asset : mAssets) {
+		Image image = contentManager.LoadImage (asset);
+		CHECKMSG (image != nullptr, "TextureAtlas::Build () - Cannot load image!");
+
+		images.push_back (image);
+		mRegions.push_back ({ 0, 0, contentManager.GetWidth (image), contentManager.GetHeight (image), 0.0f, 0.0f, 0.0f, 0.0f });
+	}
+
+	//The smallest atlas (the width of the widest image doubled up to the texture size limit, the narrowest of the same areas)
+	GLint maxSize = 0;
+	glGetIntegerv (GL_MAX_TEXTURE_SIZE, &maxSize);
+	if (maxSize <= 0)
+		maxSize = 2048;
+
+	int minWidth = 0;
+	for (const Region& region : mRegions)
+		minWidth = max (minWidth, region.width + 2 * Padding);
+
+	int bestWidth = 0;
+	int bestHeight = 0;
+	for (int width = minWidth; width <= maxSize; width = width < 64 ? 64 : width * 2) {
+		vector<Region> regions (mRegions);
+		int height = Pack (width, regions);
+		if (height <= 0 || height > maxSize)
+			continue;
+
+		if (bestWidth == 0 || (int64_t) width * height < (int64_t) bestWidth * bestHeight) {
+			bestWidth = width;
+			bestHeight = height;
+		}
+	}
+
+	CHECKMSG (bestWidth > 0, "TextureAtlas::Build () - The images do not fit into one texture!");
+
+	mWidth = bestWidth;
+	mHeight = bestHeight;
+	Pack (mWidth, mRegions);
+
+	//Copy the images with their edges repeated into the padding
+	vector<uint8_t> pixels ((size_t) mWidth * mHeight * 4, 0);
+	for (size_t i = 0; i < images.size (); ++i) {
+		Region& region = mRegions[i];
+		const uint8_t* src = contentManager.LockPixels (images[i]);
+
+		for (int y = -Padding; y < region.height + Padding; ++y) {
+			int srcY = min (max (y, 0), region.height - 1);
+			for (int x = -Padding; x < region.width + Padding; ++x) {
+				int srcX = min (max (x, 0), region.width - 1);
+				memcpy (&pixels[((size_t) (region.y + y) * mWidth + region.x + x) * 4], src + ((size_t) srcY * region.width + srcX) * 4, 4);
+			}
+		}
+
+		contentManager.UnlockPixels (images[i]);
+		contentManager.UnloadImage (images[i]);
+
+		region.u0 = (float) region.x / (float) mWidth;
+		region.v0 = (float) region.y / (float) mHeight;
+		region.u1 = (float) (region.x + region.width) / (float) mWidth;
+		region.v1 = (float) (region.y + region.height) / (float) mHeight;
+	}
+
+	glGenTextures (1, &mTex);
+	GLState::Get ().BindTexture (mTex);
+	glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, mWidth, mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void TextureAtlas::Shutdown () {
+	if (mTex > 0) {
+		GLState::Get ().DeleteTextures (1, &mTex);
+		mTex = 0;
+	}
+
+	mRegions.clear ();
+	mWidth = 0;
+	mHeight = 0;
+}
+
+int TextureAtlas::Pack (int width, vector<Region>& regions) {
+	vector<size_t> order (regions.size ());
+	for (size_t i = 0; i < order.size (); ++i)
+		order[i] = i;
+
+	//Taller first, so each shelf wastes less height (keeping the order of the same heights)
+	stable_sort (order.begin (), order.end (), [&regions] (size_t a, size_t b) -> bool {
+		return regions[a].height > regions[b].height;
+	});
+
+	int shelfX = 0;
+	int shelfY = 0;
+	int shelfHeight = 0;
+	for (size_t i : order) {
+		Region& region = regions[i];
+		int paddedWidth = region.width + 2 * Padding;
+		int paddedHeight = region.height + 2 * Padding;
+		if (paddedWidth > width)
+			return 0;
+
+		if (shelfX + paddedWidth > width) { //Next shelf
+			shelfY += shelfHeight;
+			shelfX = 0;
+			shelfHeight = 0;
+		}
+
+		region.x = shelfX + Padding;
+		region.y = shelfY + Padding;
+		shelfX += paddedWidth;
+		shelfHeight = max (shelfHeight, paddedHeight);
+	}
+
+	return shelfY + shelfHeight;
+}
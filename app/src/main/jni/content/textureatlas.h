@@ -0,0 +1,71 @@
+#pragma once
+
+///
+/// Packs image assets into one texture at load time.
+///
+/// The images are placed on shelves (rows sorted by height) with a padding of their repeated edge pixels, so the linear
+/// filtering never samples the neighbour image. The texture coordinates of each image are in the region table.
+class TextureAtlas {
+//Definitions
+public:
+	/// The place of an image in the atlas (texture coordinates of the top left and bottom right corners).
+	struct Region {
+		int x;
+		int y;
+		int width;
+		int height;
+
+		float u0;
+		float v0;
+		float u1;
+		float v1;
+	};
+
+	enum : int {
+		Padding = 1 ///< The pixels repeated around each image.
+	};
+
+//Data
+private:
+	vector<string> mAssets;
+	vector<Region> mRegions;
+
+	GLuint mTex;
+	int mWidth;
+	int mHeight;
+
+//Construction
+public:
+	TextureAtlas () : mTex (0), mWidth (0), mHeight (0) {}
+
+//Interface
+public:
+	/// Add an image before Build (returns the index of its region).
+	uint32_t Add (const string& asset);
+
+	/// Load the added images and create the texture of them (on the GL thread).
+	void Build ();
+	void Shutdown ();
+
+	bool IsBuilt () const {
+		return mTex > 0;
+	}
+
+	GLuint GetTexture () const { return mTex; }
+	int GetWidth () const { return mWidth; }
+	int GetHeight () const { return mHeight; }
+
+	uint32_t GetRegionCount () const {
+		return (uint32_t) mRegions.size ();
+	}
+
+	const Region& GetRegion (uint32_t index) const {
+		assert (index < mRegions.size ());
+		return mRegions[index];
+	}
+
+//Helper methods
+private:
+	/// Place the regions on shelves of the given width (returns the height of the atlas, 0 when an image is wider).
+	static int Pack (int width, vector<Region>& regions);
+};
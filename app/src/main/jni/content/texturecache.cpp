@@ -0,0 +1,115 @@
+#include "../pch.h"
+#include "texturecache.h"
+#include "textureloader.h"
+#include "../management/glstate.h"
+
+GLuint TextureCache::Acquire (const string& asset) {
+	auto itAsset = mAssets.find (asset);
+	if (itAsset != mAssets.end ()) {
+		++mHitCount;
+
+		Entry& entry = mEntries[itAsset->second];
+		if (entry.refCount == 0)
+			mUnused.erase (entry.unused);
+		++entry.refCount;
+		return entry.tex;
+	}
+
+	++mMissCount;
+
+	//The placeholder is drawn until the loader uploads the asset
+	GLuint tex = TextureLoader::NewPlaceholder ();
+
+	Entry& entry = mEntries[tex];
+	entry.asset = asset;
+	entry.tex = tex;
+	entry.bytes = 0;
+	entry.refCount = 1;
+	entry.unused = mUnused.end ();
+
+	mAssets[asset] = tex;
+
+	TextureLoader::Get ().Load (tex, asset, [this] (GLuint tex, int, int, uint64_t bytes) {
+		auto it = mEntries.find (tex);
+		if (it == mEntries.end ())
+			return;
+
+		it->second.bytes = bytes;
+		mBytes += it->second.bytes;
+		Evict (mBudget);
+	});
+
+	return tex;
+}
+
+void TextureCache::Release (GLuint tex) {
+	auto it = mEntries.find (tex);
+	assert (it != mEntries.end () && it->second.refCount > 0);
+	if (it == mEntries.end () || it->second.refCount == 0)
+		return;
+
+	Entry& entry = it->second;
+	if (--entry.refCount > 0)
+		return;
+
+	entry.unused = mUnused.insert (mUnused.end (), tex);
+	Evict (mBudget);
+}
+
+void TextureCache::SetBudget (uint64_t budget) {
+	mBudget = budget;
+	Evict (mBudget);
+}
+
+void TextureCache::Trim () {
+	Evict (0);
+}
+
+TextureCache::Stats TextureCache::GetStats () const {
+	Stats stats;
+	stats.textureCount = (uint32_t) mEntries.size ();
+	stats.referencedCount = (uint32_t) (mEntries.size () - mUnused.size ());
+	stats.bytes = mBytes;
+	stats.budget = mBudget;
+	stats.hitCount = mHitCount;
+	stats.missCount = mMissCount;
+	stats.evictionCount = mEvictionCount;
+	return stats;
+}
+
+void TextureCache::ResetStats () {
+	mHitCount = 0;
+	mMissCount = 0;
+	mEvictionCount = 0;
+}
+
+string TextureCache::ToJSON () const {
+	Stats stats = GetStats ();
+
+	stringstream ss;
+	ss << "{" <<
+		"\"textures\":" << stats.textureCount <<
+		",\"referenced\":" << stats.referencedCount <<
+		",\"bytes\":" << stats.bytes <<
+		",\"budget\":" << stats.budget <<
+		",\"hits\":" << stats.hitCount <<
+		",\"misses\":" << stats.missCount <<
+		",\"evictions\":" << stats.evictionCount << "}";
+	return ss.str ();
+}
+
+void TextureCache::Evict (uint64_t budget) {
+	while (mBytes > budget && !mUnused.empty ()) {
+		auto it = mEntries.find (mUnused.front ());
+		mUnused.pop_front ();
+
+		Entry& entry = it->second;
+		TextureLoader::Get ().Cancel (entry.tex);
+		GLState::Get ().DeleteTextures (1, &entry.tex);
+		mBytes -= entry.bytes;
+		mAssets.erase (entry.asset);
+		mEntries.erase (it);
+
+		++mEvictionCount;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+///
+/// The textures of the image assets, shared by the meshes and kept over the scene rebuilds (layout changes).
+///
+/// Each asset is loaded once (by the TextureLoader, the texture is a placeholder until the upload), the meshes hold
+/// references to it. The textures without references stay in the cache, while the size of all cached textures fits
+/// into the GPU memory budget; over the budget the least recently released ones are deleted. GL thread only.
+class TextureCache {
+//Definitions
+public:
+	enum : uint64_t {
+		DefaultBudget = 32 * 1024 * 1024 ///< Both of the full screen backgrounds (the two layouts) fit into it.
+	};
+
+	struct Stats {
+		uint32_t textureCount; ///< The cached textures (with or without references).
+		uint32_t referencedCount; ///< The textures used by meshes.
+		uint64_t bytes; ///< The size of the cached textures (the uploaded ones).
+		uint64_t budget;
+		uint64_t hitCount; ///< Acquires served by a cached texture.
+		uint64_t missCount; ///< Acquires started the load of the asset.
+		uint64_t evictionCount;
+	};
+
+private:
+	struct Entry {
+		string asset;
+		GLuint tex;
+		uint64_t bytes; ///< 0 until the upload.
+		uint32_t refCount;
+		list<GLuint>::iterator unused; ///< The place in the unused list (valid, when refCount is 0).
+	};
+
+//Data
+private:
+	map<string, GLuint> mAssets; ///< The textures by asset path.
+	map<GLuint, Entry> mEntries;
+	list<GLuint> mUnused; ///< The textures without references (the least recently released first).
+
+	uint64_t mBytes;
+	uint64_t mBudget;
+	uint64_t mHitCount;
+	uint64_t mMissCount;
+	uint64_t mEvictionCount;
+
+//Construction
+private:
+	TextureCache () : mBytes (0), mBudget (DefaultBudget), mHitCount (0), mMissCount (0), mEvictionCount (0) {}
+
+public:
+	static TextureCache& Get () {
+		static TextureCache inst;
+		return inst;
+	}
+
+//Interface
+public:
+	/// The texture of the image asset (a new reference, release it by Release).
+	GLuint Acquire (const string& asset);
+	void Release (GLuint tex);
+
+	/// The size limit of the cached textures in bytes (the referenced textures are kept over it).
+	void SetBudget (uint64_t budget);
+	uint64_t GetBudget () const {
+		return mBudget;
+	}
+
+	/// Delete the textures without references.
+	void Trim ();
+
+	Stats GetStats () const;
+	void ResetStats ();
+
+	/// The statistics as a JSON object: {"textures":..,"referenced":..,"bytes":..,"budget":..,"hits":..,"misses":..,"evictions":..}
+	string ToJSON () const;
+
+//Helper methods
+private:
+	void Evict (uint64_t budget);
+};
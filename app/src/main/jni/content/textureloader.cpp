@@ -0,0 +1,361 @@
+#include "../pch.h"
+#include "textureloader.h"
+#include "../management/game.h"
+#include "../management/glstate.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+constexpr double TextureLoader::DefaultUploadMillis;
+
+//The process wide switch of the asynchronous loading
+static atomic<bool> s_texture_loader_enabled (true);
+
+//The process wide switch of the ETC1 textures
+static atomic<bool> s_etc1_textures_enabled (true);
+
+TextureLoader::TextureLoader () :
+	mStopping (false),
+	mUploadBytes (DefaultUploadBytes),
+	mUploadMillis (DefaultUploadMillis) {
+	ResetStats ();
+}
+
+TextureLoader::~TextureLoader () {
+	Shutdown ();
+}
+
+GLuint TextureLoader::NewPlaceholder () {
+	GLuint tex = 0;
+	glGenTextures (1, &tex);
+	GLState::Get ().BindTexture (tex);
+
+	const uint8_t transparent[4] = { 0, 0, 0, 0 };
+	glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	return tex;
+}
+
+void TextureLoader::Load (GLuint tex, const string& asset, const Callback& onUploaded) {
+	assert (tex > 0 && !IsPending (tex));
+
+	++mLoadCount;
+
+	shared_ptr<Job> job (new Job (tex, asset, onUploaded));
+	job->etc1 = IsETC1Enabled () && HasETC1 ();
+	if (!IsEnabled ()) { //Decode and upload at once
+		Decode (*job, Game::ContentManager ());
+		if (job->decoded)
+			Upload (*job, job->Bytes ());
+		Finish (*job);
+		return;
+	}
+
+	StartWorkers ();
+
+	mJobs[tex] = job;
+
+	lock_guard<mutex> lock (mLock);
+	mQueue.push_back (job);
+	mSignal.notify_one ();
+}
+
+void TextureLoader::Cancel (GLuint tex) {
+	auto it = mJobs.find (tex);
+	if (it == mJobs.end ())
+		return;
+
+	//The workers and Update skip it
+	it->second->cancelled.store (true, memory_order_relaxed);
+	mJobs.erase (it);
+}
+
+void TextureLoader::Update () {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+	uint64_t bytes = 0;
+	uint32_t count = 0;
+
+	while (true) {
+		if (count > 0) {
+			double millis = chrono::duration<double, milli> (chrono::steady_clock::now () - start).count ();
+			if (bytes >= mUploadBytes || millis >= mUploadMillis) //Over the budget of the frame
+				break;
+		}
+
+		shared_ptr<Job> job;
+		{
+			lock_guard<mutex> lock (mLock);
+			if (mDecoded.empty ())
+				break;
+
+			job = mDecoded.front ();
+		}
+
+		bool cancelled = job->cancelled.load (memory_order_relaxed);
+		if (!cancelled && job->decoded) {
+			//The next image is uploaded whole in the next frame, when it does not fit into the rest of the budget
+			if (job->uploadedRows == 0 && count > 0 && job->Bytes () > mUploadBytes - bytes)
+				break;
+
+			bytes += Upload (*job, mUploadBytes - bytes);
+			++count;
+			if (job->uploadedRows < job->height)
+				continue;
+		}
+
+		{
+			lock_guard<mutex> lock (mLock);
+			mDecoded.pop_front ();
+		}
+
+		if (!cancelled) {
+			mJobs.erase (job->tex);
+			Finish (*job);
+		}
+	}
+
+	if (count > 0) {
+		++mUploadFrameCount;
+		mMaxFrameUploadMillis = max (mMaxFrameUploadMillis, chrono::duration<double, milli> (chrono::steady_clock::now () - start).count ());
+	}
+}
+
+void TextureLoader::Shutdown () {
+	{
+		lock_guard<mutex> lock (mLock);
+		mStopping = true;
+		mSignal.notify_all ();
+	}
+
+	for (thread& worker : mWorkers)
+		worker.join ();
+	mWorkers.clear ();
+
+	for (auto& it : mJobs)
+		it.second->cancelled.store (true, memory_order_relaxed);
+	mJobs.clear ();
+
+	lock_guard<mutex> lock (mLock);
+	mQueue.clear ();
+	mDecoded.clear ();
+	mStopping = false;
+}
+
+void TextureLoader::SetUploadBudget (uint64_t bytes, double millis) {
+	mUploadBytes = bytes;
+	mUploadMillis = millis;
+}
+
+TextureLoader::Stats TextureLoader::GetStats () const {
+	Stats stats;
+	stats.loadCount = mLoadCount;
+	stats.decodeCount = mDecodeCount.load (memory_order_relaxed);
+	stats.decodeMillis = (double) mDecodeNanos.load (memory_order_relaxed) / 1e6;
+	stats.uploadCount = mUploadCount;
+	stats.compressedCount = mCompressedCount;
+	stats.uploadBytes = mUploadedBytes;
+	stats.uploadFrameCount = mUploadFrameCount;
+	stats.maxFrameUploadMillis = mMaxFrameUploadMillis;
+	stats.pendingCount = (uint32_t) mJobs.size ();
+	return stats;
+}
+
+void TextureLoader::ResetStats () {
+	mLoadCount = 0;
+	mDecodeCount.store (0, memory_order_relaxed);
+	mDecodeNanos.store (0, memory_order_relaxed);
+	mUploadCount = 0;
+	mCompressedCount = 0;
+	mUploadedBytes = 0;
+	mUploadFrameCount = 0;
+	mMaxFrameUploadMillis = 0;
+}
+
+string TextureLoader::ToJSON () const {
+	Stats stats = GetStats ();
+
+	stringstream ss;
+	ss << fixed << setprecision (2) << "{" <<
+		"\"loads\":" << stats.loadCount <<
+		",\"decodes\":" << stats.decodeCount <<
+		",\"decodeMillis\":" << stats.decodeMillis <<
+		",\"uploads\":" << stats.uploadCount <<
+		",\"compressed\":" << stats.compressedCount <<
+		",\"uploadBytes\":" << stats.uploadBytes <<
+		",\"uploadFrames\":" << stats.uploadFrameCount <<
+		",\"maxFrameUploadMillis\":" << stats.maxFrameUploadMillis <<
+		",\"pending\":" << stats.pendingCount << "}";
+	return ss.str ();
+}
+
+bool TextureLoader::IsEnabled () {
+	return s_texture_loader_enabled.load (memory_order_relaxed);
+}
+
+void TextureLoader::SetEnabled (bool enabled) {
+	s_texture_loader_enabled.store (enabled, memory_order_relaxed);
+}
+
+bool TextureLoader::IsETC1Enabled () {
+	return s_etc1_textures_enabled.load (memory_order_relaxed);
+}
+
+void TextureLoader::SetETC1Enabled (bool enabled) {
+	s_etc1_textures_enabled.store (enabled, memory_order_relaxed);
+}
+
+void TextureLoader::StartWorkers () {
+	if (!mWorkers.empty ())
+		return;
+
+	//The GL thread and the emulator keep two cores busy
+	uint32_t cores = thread::hardware_concurrency ();
+	uint32_t count = cores > 3 ? 2 : 1;
+	for (uint32_t i = 0; i < count; ++i)
+		mWorkers.push_back (thread (&TextureLoader::Work, this, &Game::ContentManager ()));
+}
+
+void TextureLoader::Work (IContentManager* contentManager) {
+	bool decoded = false;
+
+	unique_lock<mutex> lock (mLock);
+	while (true) {
+		mSignal.wait (lock, [this] () -> bool {
+			return mStopping || !mQueue.empty ();
+		});
+
+		if (mStopping)
+			break;
+
+		shared_ptr<Job> job = mQueue.front ();
+		mQueue.pop_front ();
+		if (job->cancelled.load (memory_order_relaxed))
+			continue;
+
+		lock.unlock ();
+		Decode (*job, *contentManager);
+		decoded = true;
+		lock.lock ();
+
+		mDecoded.push_back (job);
+	}
+	lock.unlock ();
+
+	if (decoded)
+		contentManager->ReleaseImageThread ();
+}
+
+bool TextureLoader::HasETC1 () {
+	//The extensions of the device (the first call is on the GL thread with a current context)
+	static const bool supported = [] () -> bool {
+		const char* extensions = (const char*) glGetString (GL_EXTENSIONS);
+		return extensions != nullptr && strstr (extensions, "GL_OES_compressed_ETC1_RGB8_texture") != nullptr;
+	} ();
+
+	return supported;
+}
+
+void TextureLoader::Decode (Job& job, IContentManager& contentManager) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+
+	Image image = nullptr;
+	if (!job.etc1 || !DecodeETC1 (job, contentManager))
+		image = contentManager.LoadImage (job.asset);
+
+	if (image != nullptr) {
+		job.width = contentManager.GetWidth (image);
+		job.height = contentManager.GetHeight (image);
+
+		const uint8_t* pixels = contentManager.LockPixels (image);
+		job.pixels.assign (pixels, pixels + (size_t) job.width * job.height * 4);
+		contentManager.UnlockPixels (image);
+
+		contentManager.UnloadImage (image);
+		job.decoded = true;
+	}
+
+	mDecodeCount.fetch_add (1, memory_order_relaxed);
+	mDecodeNanos.fetch_add ((uint64_t) chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now () - start).count (), memory_order_relaxed);
+}
+
+bool TextureLoader::DecodeETC1 (Job& job, IContentManager& contentManager) {
+	vector<uint8_t> data = contentManager.ReadAsset (ETC1Texture::ContainerOf (job.asset));
+	if (data.empty ())
+		return false;
+
+	if (!job.compressed.Read (&data[0], data.size ())) {
+		LOGE ("TextureLoader::DecodeETC1 () - Invalid container of asset: %s", job.asset.c_str ());
+		return false;
+	}
+
+	job.width = job.compressed.width;
+	job.height = job.compressed.height;
+	job.decoded = true;
+	return true;
+}
+
+uint64_t TextureLoader::UploadETC1 (Job& job) {
+	ETC1Texture& texture = job.compressed;
+	GLState::Get ().BindTexture (job.tex);
+	glCompressedTexImage2D (GL_TEXTURE_2D, 0, GL_ETC1_RGB8_OES, texture.width, texture.height, 0, (GLsizei) texture.color.size (), &texture.color[0]);
+
+	if (!texture.alpha.empty ()) {
+		GLuint plane = 0;
+		glGenTextures (1, &plane);
+		GLState::Get ().BindTexture (plane);
+		glTexImage2D (GL_TEXTURE_2D, 0, GL_ALPHA, texture.width, texture.height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &texture.alpha[0]);
+
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		GLState::Get ().SetAlphaPlane (job.tex, plane);
+	}
+
+	job.uploadedRows = job.height;
+	++mCompressedCount;
+	mUploadedBytes += texture.Bytes ();
+	return texture.Bytes ();
+}
+
+uint64_t TextureLoader::Upload (Job& job, uint64_t budget) {
+	if (!job.compressed.color.empty ())
+		return UploadETC1 (job);
+
+	GLState::Get ().BindTexture (job.tex);
+
+	size_t rowBytes = (size_t) job.width * 4;
+	if (job.uploadedRows == 0 && job.pixels.size () <= budget) {
+		glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, job.width, job.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &job.pixels[0]);
+		job.uploadedRows = job.height;
+		mUploadedBytes += job.pixels.size ();
+		return job.pixels.size ();
+	}
+
+	//Over the budget: the storage at first, then the rows in strips (the rest of the texture stays undefined till then)
+	if (job.uploadedRows == 0)
+		glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA, job.width, job.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	int rows = min (job.height - job.uploadedRows, max (1, (int) (budget / rowBytes)));
+	glTexSubImage2D (GL_TEXTURE_2D, 0, 0, job.uploadedRows, job.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, &job.pixels[job.uploadedRows * rowBytes]);
+	job.uploadedRows += rows;
+
+	uint64_t bytes = (uint64_t) rows * rowBytes;
+	mUploadedBytes += bytes;
+	return bytes;
+}
+
+void TextureLoader::Finish (Job& job) {
+	if (!job.decoded) //The placeholder stays
+		return;
+
+	++mUploadCount;
+
+	uint64_t bytes = job.Bytes ();
+	vector<uint8_t> ().swap (job.pixels);
+	job.compressed = ETC1Texture ();
+	if (job.onUploaded)
+		job.onUploaded (job.tex, job.width, job.height, bytes);
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "etc1texture.h"
+
+class IContentManager;
+
+///
+/// Loads the image assets into textures without stalling the GL thread.
+///
+/// The texture is created at once as a placeholder (one transparent pixel), so it can be drawn right away. The asset
+/// is decoded by a pool of worker threads, and the decoded image is uploaded into the texture by Update on the GL
+/// thread. Update uploads at most the budget of bytes and time each frame; an image larger than the byte budget is
+/// uploaded in strips of rows over more frames. The uploaded callback of the load reports the size of the texture.
+///
+/// When the device has ETC1 (GL_OES_compressed_ETC1_RGB8_texture), the ETC1 container of the asset is uploaded instead
+/// of the PNG image, if there is one (ETC1Texture, made by the texture_converter tool). It is uploaded whole (ETC1 has no
+/// partial uploads), with its alpha plane (GLState::SetAlphaPlane).
+class TextureLoader {
+//Definitions
+public:
+	typedef function<void (GLuint tex, int width, int height, uint64_t bytes)> Callback; ///< bytes: the GPU memory of the texture.
+
+	enum : uint64_t {
+		DefaultUploadBytes = 4 * 1024 * 1024 ///< The bytes uploaded in a frame (about a quarter of a full screen background).
+	};
+
+	static constexpr double DefaultUploadMillis = 4.0; ///< The time of uploads in a frame.
+
+	struct Stats {
+		uint64_t loadCount;
+		uint64_t decodeCount; ///< The decoded images (worker threads).
+		double decodeMillis; ///< The total time of the decodes.
+		uint64_t uploadCount; ///< The images uploaded completely.
+		uint64_t compressedCount; ///< The uploads of ETC1 textures.
+		uint64_t uploadBytes;
+		uint32_t uploadFrameCount; ///< The frames with uploads.
+		double maxFrameUploadMillis; ///< The longest upload time of a frame.
+		uint32_t pendingCount; ///< The loads not uploaded yet.
+	};
+
+private:
+	struct Job {
+		GLuint tex;
+		string asset;
+		Callback onUploaded;
+		atomic<bool> cancelled;
+		bool etc1; ///< The ETC1 container is loaded, when there is one.
+
+		//The decoded image (written by the worker)
+		bool decoded;
+		int width;
+		int height;
+		vector<uint8_t> pixels;
+		ETC1Texture compressed; ///< The loaded container (empty, when the PNG image is decoded).
+
+		int uploadedRows; ///< The rows in the texture (GL thread).
+
+		Job (GLuint tex, const string& asset, const Callback& onUploaded) :
+			tex (tex), asset (asset), onUploaded (onUploaded), cancelled (false), etc1 (false), decoded (false), width (0), height (0), uploadedRows (0) {}
+
+		/// The bytes of the upload.
+		uint64_t Bytes () const {
+			return compressed.color.empty () ? pixels.size () : compressed.Bytes ();
+		}
+	};
+
+//Data
+private:
+	mutex mLock;
+	condition_variable mSignal;
+	deque<shared_ptr<Job>> mQueue; ///< The jobs to decode.
+	deque<shared_ptr<Job>> mDecoded; ///< The jobs to upload.
+	vector<thread> mWorkers;
+	bool mStopping;
+
+	map<GLuint, shared_ptr<Job>> mJobs; ///< The pending loads by texture (GL thread).
+
+	uint64_t mUploadBytes;
+	double mUploadMillis;
+
+	//Statistics
+	uint64_t mLoadCount;
+	atomic<uint64_t> mDecodeCount;
+	atomic<uint64_t> mDecodeNanos;
+	uint64_t mUploadCount;
+	uint64_t mCompressedCount;
+	uint64_t mUploadedBytes;
+	uint32_t mUploadFrameCount;
+	double mMaxFrameUploadMillis;
+
+//Construction
+private:
+	TextureLoader ();
+
+public:
+	~TextureLoader ();
+
+	static TextureLoader& Get () {
+		static TextureLoader inst;
+		return inst;
+	}
+
+//Interface
+public:
+	/// A new texture with the placeholder pixel (on the GL thread).
+	static GLuint NewPlaceholder ();
+
+	/// Load the asset into the texture (a placeholder, the callback is called on the GL thread after the upload).
+	void Load (GLuint tex, const string& asset, const Callback& onUploaded);
+
+	/// Drop the load of the texture (call it before the texture is deleted).
+	void Cancel (GLuint tex);
+
+	bool IsPending (GLuint tex) const {
+		return mJobs.find (tex) != mJobs.end ();
+	}
+
+	/// Upload the decoded images in the budget of the frame (GL thread, once in each frame).
+	void Update ();
+
+	/// Stop the worker threads (the pending loads are dropped, their textures keep the placeholder). Call it before the
+	/// game and its content manager are destroyed, the workers release their threads by the content manager.
+	void Shutdown ();
+
+	void SetUploadBudget (uint64_t bytes, double millis);
+
+	Stats GetStats () const;
+	void ResetStats ();
+
+	/// The statistics as a JSON object: {"loads":..,"decodes":..,"decodeMillis":..,"uploads":..,"compressed":..,"uploadBytes":..,"uploadFrames":..,"maxFrameUploadMillis":..,"pending":..}
+	string ToJSON () const;
+
+	/// The loads are asynchronous (process wide switch, else Load decodes and uploads at once).
+	static bool IsEnabled ();
+	static void SetEnabled (bool enabled);
+
+	/// The ETC1 containers are loaded, when the device has ETC1 (process wide switch, else the PNG images).
+	static bool IsETC1Enabled ();
+	static void SetETC1Enabled (bool enabled);
+
+//Helper methods
+private:
+	/// Start the workers with the content manager of the game (it has to outlive them, see Shutdown).
+	void StartWorkers ();
+	void Work (IContentManager* contentManager);
+
+	/// The device has ETC1 (GL thread).
+	static bool HasETC1 ();
+
+	void Decode (Job& job, IContentManager& contentManager);
+
+	/// Read the ETC1 container of the asset, returns false, when it has none.
+	bool DecodeETC1 (Job& job, IContentManager& contentManager);
+
+	/// Upload the ETC1 texture and its alpha plane, returns the uploaded bytes.
+	uint64_t UploadETC1 (Job& job);
+
+	/// Upload the image (whole, if it fits into the budget, else the next strip of rows), returns the uploaded bytes.
+	uint64_t Upload (Job& job, uint64_t budget);
+
+	/// The image is in the texture (the callback of the load).
+	void Finish (Job& job);
+};
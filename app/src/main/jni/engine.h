@@ -1,11 +1,30 @@
 #pragma once
 
+#include "management/triplebuffer.h"
+#include "management/framebarrier.h"
+#include "management/pcmstream.h"
+#include "management/pcmautotuner.h"
+
+#ifdef __ANDROID__
 class AndroidContentManager;
+typedef AndroidContentManager PlatformContentManager;
+#else
+class HostContentManager;
+typedef HostContentManager PlatformContentManager;
+#endif //__ANDROID__
 class MayhemGame;
 
+/// Pixel formats of the emulator canvas (shared with the emulator through the format negotiating init callback).
+enum canvas_format_e {
+	CANVAS_FORMAT_BGRA8888 = 0, ///< The native format of the emulator (needs conversion before upload).
+	CANVAS_FORMAT_RGBA8888 = 1, ///< GL ready RGBA.
+	CANVAS_FORMAT_RGB565 = 2, ///< GL ready 16 bit RGB.
+	CANVAS_FORMAT_INDEXED8 = 3 ///< Palette indexes (not accepted: GLES 1.x cannot update paletted textures partially).
+};
+
 struct engine_s {
 	//Game data
-	unique_ptr<AndroidContentManager> contentManager;
+	unique_ptr<PlatformContentManager> contentManager;
 	unique_ptr<MayhemGame> game;
 	unique_ptr<set<int32_t>> pointerIDs;
 	double lastUpdateTime;
@@ -18,34 +37,31 @@ struct engine_s {
 	string diskImage;
 
 	//Emulator display data
-	recursive_mutex canvas_lock;
-
 	volatile bool canvas_inited;
 	uint32_t canvas_width;
 	uint32_t canvas_height;
 	uint32_t canvas_bit_per_pixel;
 	uint32_t canvas_pitch;
+	uint32_t canvas_format; //one of canvas_format_e
 
 	uint32_t visible_width;
 	uint32_t visible_height;
 
-	vector<uint8_t> canvas; //screen pixels in BGR format
-	volatile bool canvas_dirty;
+	vector<uint8_t> canvas; //screen pixels in BGR format (owned by the emulator thread)
+	TripleBuffer canvas_frames; //completed frames handed over from the emulator to the game thread (visible rows of canvas), tagged with emulator_frame
+	uint32_t emulator_frame; //the frame emulated now (owned by the emulator thread), its picture and its sound are tagged with it
 
 	//Emulator sound data
-	recursive_mutex pcm_lock;
-
 	uint32_t deviceSamplingRate;
 	uint32_t deviceBufferFrames;
 	uint32_t deviceBufferCount;
+	PCMAutoTuner pcm_tuner; //the device buffer configuration of the PCM output (learned from the values above)
 	uint32_t pcm_sampleRate;
 	uint32_t pcm_bytesPerSec;
 	uint32_t pcm_numChannels;
 
-	deque<vector<uint8_t>> pcm;
-	volatile bool pcm_dirty;
+	PCMStream pcm; //PCM bytes of the emulator (written by the emulator thread, read by the game thread or directly by the audio callback), the format fields above are published by it
 
 	//Emulator syncronization data
-	recursive_mutex vsync_lock;
-	volatile bool run_game;
+	FrameBarrier frame_barrier; //one game frame for each emulator frame (when not in warp mode)
 };
@@ -2,10 +2,19 @@
 #include "gamescene.h"
 #include "../engine.h"
 #include "../management/game.h"
+#include "../management/frametimer.h"
+#include "../management/avsync.h"
+#include "../management/glstate.h"
 #include "../content/texanimmesh.h"
 #include "../content/coloredmesh.h"
 #include "../content/imagemesh.h"
 #include "../content/animation.h"
+#include "../content/pixelkernels.h"
+#include "../content/spritebatch.h"
+#include "../content/textureatlas.h"
+#include "../content/atlasmesh.h"
+#include "../content/geometryregistry.h"
+#include "../content/textureloader.h"
 
 extern engine_s g_engine;
 extern "C" void keyboard_key_pressed (signed long key);
@@ -28,6 +37,10 @@ extern "C" int resources_set_int (const char *name, int value);
 
 void GameScene::Init (float width, float height) {
 	mC64Screen.reset (); //created in update phase
+	mC64TextureValid = false;
+	mC64FramePresent = false;
+	mC64Frame = 0;
+	mIsDirectPCM = false;
 	mBackground.reset ();
 
 	mRedSum = 0;
@@ -58,6 +71,11 @@ void GameScene::Shutdown () {
 	DestroyButtons ();
 	DestroyAnims ();
 
+	if (mAnimAtlas) {
+		mAnimAtlas->Shutdown ();
+		mAnimAtlas.reset ();
+	}
+
 	if (mBackground) {
 		mBackground->Shutdown ();
 		mBackground.reset ();
@@ -66,6 +84,14 @@ void GameScene::Shutdown () {
 	if (mC64Screen)
 		mC64Screen->Shutdown ();
 	mC64Screen.reset ();
+
+	if (mSpriteBatch) {
+		mSpriteBatch->Shutdown ();
+		mSpriteBatch.reset ();
+	}
+
+	//The shared geometry released by the meshes
+	GeometryRegistry::Get ().Trim ();
 }
 
 void GameScene::Pause () {
@@ -99,6 +125,7 @@ void GameScene::Update (float elapsedTime) {
 
 		mC64Screen.reset (new TexAnimMesh (g_engine.visible_width, g_engine.visible_height, g_engine.canvas_bit_per_pixel));
 		mC64Screen->Init ();
+		mC64TextureValid = false;
 
 		if (game.Width () <= game.Height ())
 			InitVerticalLayout (false);
@@ -119,18 +146,22 @@ void GameScene::Update (float elapsedTime) {
 
 	//Update C64 screen texture
 	if (mC64Screen) {
-		if (g_engine.canvas_dirty || IsDirtyState ()) { //Something changed on the screen, so we need to refresh the texture
+		bool frameArrived = g_engine.canvas_frames.Acquire (); //Take the newest frame of the emulator (if any)
+		if (frameArrived || IsDirtyState ()) { //Something changed on the screen, so we need to refresh the texture
 //			Game::ContentManager ().Log ("dirty");
 
 			mRedSum = 0;
 			mGreenSum = 0;
 			mBlueSum = 0;
 
-			//Trim screen pixel buffer to visible size (convert BGR to RGB)
-			if (mState == GameStates::Game)
-				ConvertBGRAInGame ();
-			else
-				ConvertBGRADuringLoad ();
+			//Trim screen pixel buffer to visible size (convert BGR to RGB, when the emulator renders in the legacy format)
+			{
+				FramePhaseTimer timer (FramePhase::PixelConversion);
+				if (mState == GameStates::Game)
+					UpdatePixelsInGame ();
+				else
+					UpdatePixelsDuringLoad ();
+			}
 
 //			stringstream ss;
 //			ss << "draw -> R: " << mRedSum << ", G: " << mGreenSum << ", B: " << mBlueSum;
@@ -139,11 +170,24 @@ void GameScene::Update (float elapsedTime) {
 			//Handle game state transitions during initialization (C64 load process)
 			ExecStateTransitions ();
 
-			//Draw the screen of the game
+			//Draw the screen of the game (upload only the changed rows, when the texture is up to date)
 			if (mState == GameStates::Game) {
-				mC64Screen->SetPixels (g_engine.visible_width, g_engine.visible_height, g_engine.canvas_bit_per_pixel, &mC64Pixels[0]);
+				FramePhaseTimer timer (FramePhase::TextureUpload);
+				if (mC64TextureValid) {
+					mC64Screen->SetPixelRows (mC64DirtyRows, g_engine.canvas_bit_per_pixel, &mC64Pixels[0]);
+				} else {
+					mC64Screen->SetPixels (g_engine.visible_width, g_engine.visible_height, g_engine.canvas_bit_per_pixel, &mC64Pixels[0]);
+					mC64TextureValid = true;
+				}
+
+				//The frame of the emulator is presented by the next render (A/V sync)
+				if (frameArrived) {
+					mC64FramePresent = true;
+					mC64Frame = g_engine.canvas_frames.ReadTag ();
+				}
+			} else {
+				mC64TextureValid = false;
 			}
-			g_engine.canvas_dirty = false;
 		}
 	}
 
@@ -154,6 +198,8 @@ void GameScene::Update (float elapsedTime) {
 				mMayhemAnim->Start ();
 
 			mMayhemAnim->Update (elapsedTime);
+			if (mMayhemAnimMesh)
+				mMayhemAnimMesh->SetFrame (mMayhemAnim->Frame ());
 		}
 
 		if (mStartingAnim) {
@@ -161,6 +207,8 @@ void GameScene::Update (float elapsedTime) {
 				mStartingAnim->Start ();
 
 			mStartingAnim->Update (elapsedTime);
+			if (mStartingAnimMesh)
+				mStartingAnimMesh->SetFrame (mStartingAnim->Frame ());
 		}
 	} else { //In game state hide the starting anims
 		if (mMayhemAnim && mMayhemAnim->IsStarted ())
@@ -170,32 +218,46 @@ void GameScene::Update (float elapsedTime) {
 			mStartingAnim->Stop ();
 	}
 
-	//Update C64 sound
-	if (g_engine.pcm_dirty) {
-		IContentManager& contentManager = Game::ContentManager ();
+	//Update C64 sound (muted before the game state)
+	g_engine.pcm.SetMuted (mState != GameStates::Game);
 
-		if (!contentManager.IsOpenedPCM ())
-			contentManager.OpenPCM (1.0f, g_engine.pcm_numChannels, g_engine.pcm_sampleRate, g_engine.pcm_bytesPerSec, g_engine.deviceBufferFrames, g_engine.deviceBufferCount);
+	IContentManager& contentManager = Game::ContentManager ();
+	bool isDirectPCM = g_engine.pcm.IsDirect ();
+	if (contentManager.IsOpenedPCM () && isDirectPCM != mIsDirectPCM) //Switch the sound path
+		contentManager.ClosePCM ();
 
-		{
-			lock_guard <recursive_mutex> lock (g_engine.pcm_lock);
+	PCMAutoTuner& tuner = g_engine.pcm_tuner;
+	if (contentManager.IsOpenedPCM () && tuner.Update (contentManager, !g_engine.pcm.IsMuted (), contentManager.GetTime ())) //Reopen with the new buffer configuration
+		contentManager.ClosePCM ();
 
-//			stringstream ss;
-//			ss << "pcm size: " << g_engine.pcm.size ();
-//			Game::ContentManager ().Log (ss.str ());
+	if (g_engine.pcm.Available () > 0) {
+		FramePhaseTimer timer (FramePhase::PCMDrain);
 
-			while (g_engine.pcm.size () > 0) {
-				if (mState == GameStates::Game) {
-					const vector <uint8_t>& data = g_engine.pcm[0];
-					contentManager.WritePCM (&data[0], data.size ());
-				}
-				g_engine.pcm.pop_front ();
-			}
+		if (!contentManager.IsOpenedPCM ()) {
+			mIsDirectPCM = isDirectPCM;
+			contentManager.SetPCMStream (&g_engine.pcm);
+			contentManager.OpenPCM (1.0f, g_engine.pcm_numChannels, g_engine.pcm_sampleRate, g_engine.pcm_bytesPerSec, tuner.BufferFrames (), tuner.BufferCount ());
+			tuner.Start (contentManager.GetTime ());
+			AVSync::Get ().Restart ();
 		}
 
-		g_engine.pcm_dirty = false;
+		//Drain the ring in place write by write, so each keeps its stamp (the direct stream is read by the audio callback)
+		if (!mIsDirectPCM) {
+			bool isPlaying = !g_engine.pcm.IsMuted ();
+			PCMStamp stamp = { 0, 0 };
+			auto consumer = [&contentManager, isPlaying, &stamp] (const uint8_t* data, uint32_t size) {
+				if (isPlaying)
+					contentManager.WritePCM (data, size, stamp);
+			};
+
+			while (g_engine.pcm.Read (g_engine.pcm.Capacity (), consumer, stamp) > 0)
+				;
+		}
 	}
 
+	//Match the sound with the presented frames
+	AVSync::Get ().Update ();
+
 	//Handle reset
 	if (mIsResetInProgress) {
 		IContentManager& contentManager = Game::ContentManager ();
@@ -243,32 +305,48 @@ void GameScene::Update (float elapsedTime) {
 }
 
 void GameScene::Render () {
+	//The decoded images of the textures loaded in the background
+	TextureLoader::Get ().Update ();
+
 	//glClearColor (1.0f, 0.5f, 0.5f, 1.0f);
 	glClearColor (0.0f, 0.0f, 0.0f, 1.0f);
 	glClear (GL_COLOR_BUFFER_BIT);
 
-	glMatrixMode (GL_MODELVIEW);
+	GLState::Get ().MatrixMode (GL_MODELVIEW);
 	glLoadIdentity ();
 
+	//Collect the quads of the meshes into one batch (drawn at the end of the frame)
+	SpriteBatch* batch = nullptr;
+	if (SpriteBatch::IsEnabled ()) {
+		if (!mSpriteBatch) {
+			mSpriteBatch.reset (new SpriteBatch ());
+			mSpriteBatch->Init ();
+		}
+
+		batch = mSpriteBatch.get ();
+	}
+
 	if (mBackground)
-		mBackground->Render ();
+		mBackground->Render (batch);
 
-	if (mC64Screen)
-		mC64Screen->Render ();
+	if (mC64Screen) {
+		mC64Screen->Render (batch);
+
+		if (mC64FramePresent) {
+			AVSync::Get ().Present (mC64Frame);
+			mC64FramePresent = false;
+		}
+	}
 
 	if (mState != GameStates::Game) { //If not in game state, then show starting anims
 		if (mTitle)
-			mTitle->Render ();
+			mTitle->Render (batch);
 
-		if (mMayhemAnim) {
-			uint32_t frame = mMayhemAnim->Frame () % mMayhemAnimFrames.size ();
-			mMayhemAnimFrames[frame]->Render ();
-		}
+		if (mMayhemAnimMesh)
+			mMayhemAnimMesh->Render (batch);
 
-		if (mStartingAnim) {
-			uint32_t frame = mStartingAnim->Frame () % mStartingAnimFrames.size ();
-			mStartingAnimFrames[frame]->Render ();
-		}
+		if (mStartingAnimMesh)
+			mStartingAnimMesh->Render (batch);
 	}
 
 //	for (auto it = mButtons.begin ();it != mButtons.end ();++it) {
@@ -277,17 +355,20 @@ void GameScene::Render () {
 //	}
 
 	if (mButtonStates & (uint32_t)Buttons::Left)
-		mButtonPresses[Buttons::Left]->Render ();
+		mButtonPresses[Buttons::Left]->Render (batch);
 	if (mButtonStates & (uint32_t)Buttons::Right)
-		mButtonPresses[Buttons::Right]->Render ();
+		mButtonPresses[Buttons::Right]->Render (batch);
 	if (mButtonStates & (uint32_t)Buttons::Up)
-		mButtonPresses[Buttons::Up]->Render ();
+		mButtonPresses[Buttons::Up]->Render (batch);
 	if (mButtonStates & (uint32_t)Buttons::Down)
-		mButtonPresses[Buttons::Down]->Render ();
+		mButtonPresses[Buttons::Down]->Render (batch);
 	if (mButtonStates & (uint32_t)Buttons::Fire)
-		mButtonPresses[Buttons::Fire]->Render ();
+		mButtonPresses[Buttons::Fire]->Render (batch);
 	if (mButtonStates & (uint32_t)Buttons::C64)
-		mButtonPresses[Buttons::C64]->Render ();
+		mButtonPresses[Buttons::C64]->Render (batch);
+
+	if (batch)
+		batch->Flush ();
 }
 
 void GameScene::TouchDown (int fingerID, const Vector2D& pos) {
@@ -347,9 +428,7 @@ void GameScene::TouchMove (int fingerID, const Vector2D& pos) {
 	HandleResetProgressMove (fingerID, pos);
 }
 
-void GameScene::ConvertBGRADuringLoad () {
-	lock_guard <recursive_mutex> lock (g_engine.canvas_lock);
-
+void GameScene::UpdatePixelsDuringLoad () {
 	assert (g_engine.visible_height <= g_engine.canvas_height);
 
 	uint32_t bytePerPixel = g_engine.canvas_bit_per_pixel / 8;
@@ -357,41 +436,36 @@ void GameScene::ConvertBGRADuringLoad () {
 	uint32_t pitch_dest = g_engine.visible_width * bytePerPixel;
 	assert (mC64Pixels.size () == pitch_dest * g_engine.visible_height);
 
+	//Convert (or copy) and sum the color components in one pass (red, green, blue)
+	uint32_t sums[3] = { 0, 0, 0 };
+
+	const PixelKernels& kernels = PixelKernels::Get ();
+	const uint8_t* frame = g_engine.canvas_frames.ReadBuffer ();
 	for (uint32_t y = 0, yEnd = g_engine.visible_height; y < yEnd; ++y) {
-		uint64_t* src_pixel = (uint64_t*) (&g_engine.canvas[y * pitch_src]);
-		uint64_t* dst_pixel = (uint64_t*) (&mC64Pixels[y * pitch_dest]);
-
-		for (uint32_t x = 0, xEnd = g_engine.visible_width; x < xEnd; x += 8) {
-			uint64_t src = *src_pixel++;
-			mRedSum +=		(uint8_t)((src & 0x00FF000000000000ull) >> 48) + (uint8_t)((src & 0x0000000000FF0000ull) >> 16);
-			mGreenSum +=	(uint8_t)((src & 0x0000FF0000000000ull) >> 40) + (uint8_t)((src & 0x000000000000FF00ull) >> 8);
-			mBlueSum +=		(uint8_t)((src & 0x000000FF00000000ull) >> 32) + (uint8_t)(src & 0x00000000000000FFull);
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
-
-			src = *src_pixel++;
-			mRedSum +=		(uint8_t)((src & 0x00FF000000000000ull) >> 48) + (uint8_t)((src & 0x0000000000FF0000ull) >> 16);
-			mGreenSum +=	(uint8_t)((src & 0x0000FF0000000000ull) >> 40) + (uint8_t)((src & 0x000000000000FF00ull) >> 8);
-			mBlueSum +=		(uint8_t)((src & 0x000000FF00000000ull) >> 32) + (uint8_t)(src & 0x00000000000000FFull);
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
-
-			src = *src_pixel++;
-			mRedSum +=		(uint8_t)((src & 0x00FF000000000000ull) >> 48) + (uint8_t)((src & 0x0000000000FF0000ull) >> 16);
-			mGreenSum +=	(uint8_t)((src & 0x0000FF0000000000ull) >> 40) + (uint8_t)((src & 0x000000000000FF00ull) >> 8);
-			mBlueSum +=		(uint8_t)((src & 0x000000FF00000000ull) >> 32) + (uint8_t)(src & 0x00000000000000FFull);
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
-
-			src = *src_pixel++;
-			mRedSum +=		(uint8_t)((src & 0x00FF000000000000ull) >> 48) + (uint8_t)((src & 0x0000000000FF0000ull) >> 16);
-			mGreenSum +=	(uint8_t)((src & 0x0000FF0000000000ull) >> 40) + (uint8_t)((src & 0x000000000000FF00ull) >> 8);
-			mBlueSum +=		(uint8_t)((src & 0x000000FF00000000ull) >> 32) + (uint8_t)(src & 0x00000000000000FFull);
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+		const uint8_t* src = &frame[y * pitch_src];
+		uint8_t* dest = &mC64Pixels[y * pitch_dest];
+
+		switch (g_engine.canvas_format) {
+		case CANVAS_FORMAT_RGBA8888:
+			memcpy (dest, src, pitch_dest);
+			kernels.SumRGBA (src, g_engine.visible_width, sums);
+			break;
+		case CANVAS_FORMAT_RGB565:
+			memcpy (dest, src, pitch_dest);
+			kernels.SumRGB565 (src, g_engine.visible_width, sums);
+			break;
+		default:
+			kernels.ConvertBGRASum (src, dest, g_engine.visible_width, sums);
+			break;
 		}
 	}
-}
 
-void GameScene::ConvertBGRAInGame () {
-	lock_guard <recursive_mutex> lock (g_engine.canvas_lock);
+	mRedSum += sums[0];
+	mGreenSum += sums[1];
+	mBlueSum += sums[2];
+}
 
+void GameScene::UpdatePixelsInGame () {
 	assert (g_engine.visible_height <= g_engine.canvas_height);
 
 	uint32_t bytePerPixel = g_engine.canvas_bit_per_pixel / 8;
@@ -399,24 +473,40 @@ void GameScene::ConvertBGRAInGame () {
 	uint32_t pitch_dest = g_engine.visible_width * bytePerPixel;
 	assert (mC64Pixels.size () == pitch_dest * g_engine.visible_height);
 
-	for (uint32_t y = 0, yEnd = g_engine.visible_height; y < yEnd; ++y) {
-		uint64_t* src_pixel = (uint64_t*) (&g_engine.canvas[y * pitch_src]);
-		uint64_t* dst_pixel = (uint64_t*) (&mC64Pixels[y * pitch_dest]);
+	//mC64Pixels holds the previous frame, so the changed rows can be collected during the conversion
+	mC64DirtyRows.clear ();
 
-		for (uint32_t x = 0, xEnd = g_engine.visible_width; x < xEnd; x += 8) {
-			uint64_t src = *src_pixel++;
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+	const PixelKernels& kernels = PixelKernels::Get ();
+	const uint8_t* frame = g_engine.canvas_frames.ReadBuffer ();
+	bool isDirectFormat = g_engine.canvas_format != CANVAS_FORMAT_BGRA8888;
+	for (uint32_t y = 0, yEnd = g_engine.visible_height; y < yEnd; ++y) {
+		const uint8_t* src = &frame[y * pitch_src];
+		uint8_t* dest = &mC64Pixels[y * pitch_dest];
 
-			src = *src_pixel++;
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+		if (isDirectFormat) { //The emulator renders in the format of the texture already
+			if (memcmp (dest, src, pitch_dest) != 0) {
+				memcpy (dest, src, pitch_dest);
+				AddDirtyRow (y);
+			}
+		} else if (kernels.ConvertBGRA (src, dest, g_engine.visible_width)) {
+			AddDirtyRow (y);
+		}
+	}
+}
 
-			src = *src_pixel++;
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+void GameScene::AddDirtyRow (uint32_t row) {
+	//Rows closer than this to the previous span are merged into it (one bigger upload is cheaper than many small ones)
+	const uint32_t mergeDistance = 4;
 
-			src = *src_pixel++;
-			*dst_pixel++ = (src & 0x00FF000000FF0000ull) >> 16 | (src & 0x0000FF000000FF00ull) | (src & 0x000000FF000000FFull) << 16 | 0xFF000000FF000000;
+	if (mC64DirtyRows.size () > 0) {
+		pair<uint32_t, uint32_t>& last = mC64DirtyRows.back ();
+		if (row <= last.first + last.second + mergeDistance) {
+			last.second = row - last.first + 1;
+			return;
 		}
 	}
+
+	mC64DirtyRows.push_back (make_pair (row, 1u));
 }
 
 bool GameScene::IsDirtyState () const {
@@ -626,15 +716,17 @@ void GameScene::DestroyAnims () {
 		mTitle.reset ();
 	}
 
-	for (size_t i = 0;i < mMayhemAnimFrames.size ();++i)
-		mMayhemAnimFrames[i]->Shutdown ();
-	mMayhemAnimFrames.clear ();
+	if (mMayhemAnimMesh) {
+		mMayhemAnimMesh->Shutdown ();
+		mMayhemAnimMesh.reset ();
+	}
 
 	mMayhemAnim.reset ();
 
-	for (size_t i = 0;i < mStartingAnimFrames.size ();++i)
-		mStartingAnimFrames[i]->Shutdown ();
-	mStartingAnimFrames.clear ();
+	if (mStartingAnimMesh) {
+		mStartingAnimMesh->Shutdown ();
+		mStartingAnimMesh.reset ();
+	}
 
 	mStartingAnim.reset ();
 }
@@ -649,31 +741,43 @@ void GameScene::InitAnims (const Vector2D& titlePos, const Vector2D& startingPos
 	mTitle->Pos = screenRefPos + titlePos * screenRefScale;
 	mTitle->Scale = game.RefToLocal (192 * 4, 111 * 4) * screenRefScale;
 
-	for (int i = 2;i <= 11;++i)
-		mMayhemAnimFrames.push_back (LoadAnimFrame ("mayhem_anim/mayhem_", i, ".png", mayhemPos, game.RefToLocal (48 * 4, 42 * 4)));
+	//All of the frames are in one texture (built once, the layout changes keep it)
+	if (!mAnimAtlas) {
+		mAnimAtlas.reset (new TextureAtlas ());
+		mMayhemAnimRegions = AddAnimFrames ("mayhem_anim/mayhem_", 2, 11, ".png");
+		mStartingAnimRegions = AddAnimFrames ("ss_anim/ss_", 1, 3, ".png");
+		mAnimAtlas->Build ();
+	}
 
+	mMayhemAnimMesh = CreateAnimMesh (mMayhemAnimRegions, mayhemPos, game.RefToLocal (48 * 4, 42 * 4));
 	mMayhemAnim = shared_ptr<FrameAnimation> (new FrameAnimation (0.1f));
 
-	for (int i = 1;i <= 3;++i)
-		mStartingAnimFrames.push_back (LoadAnimFrame ("ss_anim/ss_", i, ".png", startingPos, game.RefToLocal (579, 58)));
-
+	mStartingAnimMesh = CreateAnimMesh (mStartingAnimRegions, startingPos, game.RefToLocal (579, 58));
 	mStartingAnim = shared_ptr<FrameAnimation> (new FrameAnimation (0.2f));
 }
 
-shared_ptr<ImageMesh> GameScene::LoadAnimFrame (const string& asset, int idx, const string& assetPostfix, const Vector2D& pos, const Vector2D& scale) const {
-	stringstream name;
-	name << asset << setw (2) << setfill('0') << idx << assetPostfix;
+vector<uint32_t> GameScene::AddAnimFrames (const string& asset, int firstIdx, int lastIdx, const string& assetPostfix) {
+	vector<uint32_t> regions;
+	for (int idx = firstIdx;idx <= lastIdx;++idx) {
+		stringstream name;
+		name << asset << setw (2) << setfill('0') << idx << assetPostfix;
+		regions.push_back (mAnimAtlas->Add (name.str ()));
+	}
+
+	return regions;
+}
 
+shared_ptr<AtlasMesh> GameScene::CreateAnimMesh (const vector<uint32_t>& regions, const Vector2D& pos, const Vector2D& scale) const {
 	Game& game = Game::Get ();
 	Vector2D screenRefScale = game.ScreenRefScale () * game.AspectScaleFactor ();
 	Vector2D screenRefPos = game.ScreenRefPos ();
 
-	shared_ptr<ImageMesh> frame (new ImageMesh (name.str ()));
-	frame->Init ();
-	frame->Pos = screenRefPos + pos * screenRefScale;
-	frame->Scale = scale * screenRefScale;
+	shared_ptr<AtlasMesh> mesh (new AtlasMesh (mAnimAtlas, regions));
+	mesh->Init ();
+	mesh->Pos = screenRefPos + pos * screenRefScale;
+	mesh->Scale = scale * screenRefScale;
 
-	return frame;
+	return mesh;
 }
 
 Vector2D GameScene::ConvertRefPercentCoordToLocal (bool isVerticalLayout, Vector2D percentCoord) const {
@@ -8,6 +8,9 @@ class TexAnimMesh;
 class ColoredMesh;
 class ImageMesh;
 class FrameAnimation;
+class SpriteBatch;
+class TextureAtlas;
+class AtlasMesh;
 
 class GameScene : public Scene {
 //Definitions
@@ -48,6 +51,11 @@ private:
 	//C64 emulator specific data
 	shared_ptr<TexAnimMesh> mC64Screen;
 	vector<uint8_t> mC64Pixels;
+	vector<pair<uint32_t, uint32_t>> mC64DirtyRows; ///< Changed row spans (first row, row count) of the last in game conversion.
+	bool mC64TextureValid; ///< True, when the texture of mC64Screen holds the content of mC64Pixels.
+	bool mC64FramePresent; ///< A new emulator frame is uploaded, the next render presents it.
+	uint32_t mC64Frame; ///< The emulator frame in the texture (the tag of the triple buffer).
+	bool mIsDirectPCM; ///< The sound path of the opened PCM output (the audio callback reads the emulator stream directly).
 
 	uint32_t mRedSum;
 	uint32_t mGreenSum;
@@ -61,12 +69,17 @@ private:
 	shared_ptr<ImageMesh> mBackground;
 	shared_ptr<ImageMesh> mTitle;
 
-	vector<shared_ptr<ImageMesh>> mMayhemAnimFrames;
-	vector<shared_ptr<ImageMesh>> mStartingAnimFrames;
+	shared_ptr<TextureAtlas> mAnimAtlas; ///< The frames of the starting anims (kept until shutdown).
+	vector<uint32_t> mMayhemAnimRegions; ///< The atlas regions of the frames.
+	vector<uint32_t> mStartingAnimRegions;
+	shared_ptr<AtlasMesh> mMayhemAnimMesh;
+	shared_ptr<AtlasMesh> mStartingAnimMesh;
 
 	shared_ptr<FrameAnimation> mMayhemAnim;
 	shared_ptr<FrameAnimation> mStartingAnim;
 
+	shared_ptr<SpriteBatch> mSpriteBatch; ///< Draws the meshes of a frame (created by the first render).
+
 	//Button data
 	map<Buttons, shared_ptr<ColoredMesh>> mButtons;
 	uint32_t mButtonStates;
@@ -107,8 +120,9 @@ public:
 
 //Helper methods
 private:
-	void ConvertBGRADuringLoad ();
-	void ConvertBGRAInGame ();
+	void UpdatePixelsDuringLoad ();
+	void UpdatePixelsInGame ();
+	void AddDirtyRow (uint32_t row);
 
 	bool IsDirtyState () const;
 	void ExecStateTransitions ();
@@ -119,7 +133,8 @@ private:
 	void DestroyAnims ();
 	void InitAnims (const Vector2D& titlePos, const Vector2D& startingPos, const Vector2D& mayhemPos);
 
-	shared_ptr<ImageMesh> LoadAnimFrame (const string& asset, int idx, const string& assetPostfix, const Vector2D& pos, const Vector2D& scale) const;
+	vector<uint32_t> AddAnimFrames (const string& asset, int firstIdx, int lastIdx, const string& assetPostfix);
+	shared_ptr<AtlasMesh> CreateAnimMesh (const vector<uint32_t>& regions, const Vector2D& pos, const Vector2D& scale) const;
 
 	Vector2D ConvertRefPercentCoordToLocal (bool isVerticalLayout, Vector2D percentCoord) const;
 
@@ -5,6 +5,12 @@
 #include "platform/androidcontentmanager.h"
 #include "platform/audiomanager.h"
 #include "management/game.h"
+#include "management/frametimer.h"
+#include "management/avsync.h"
+#include "management/glstate.h"
+#include "content/spritebatch.h"
+#include "content/texturecache.h"
+#include "content/textureloader.h"
 
 //c64emu declarations
 extern "C" int main_program (int argc, char **argv);
@@ -20,6 +26,12 @@ extern "C" void ui_android_init_callbacks (t_fn_ui_event_callback eventCallback)
 typedef int (*t_fn_init_canvas) (uint32_t width, uint32_t height, uint32_t bpp, uint32_t visible_width, uint32_t visible_height, uint8_t** buffer, uint32_t* pitch);
 extern "C" void video_android_set_init_callback (t_fn_init_canvas init_canvas);
 
+//Format negotiating init callback: the emulator offers its output formats (canvas_format_e), the callback chooses one
+//and a pitch, the emulator renders only the visible area then. (Weak, because older emulator builds do not have it.)
+typedef int (*t_fn_init_canvas_format) (uint32_t width, uint32_t height, uint32_t visible_width, uint32_t visible_height,
+										const uint32_t* formats, uint32_t format_count, uint32_t* format, uint32_t* bpp, uint8_t** buffer, uint32_t* pitch);
+extern "C" void video_android_set_init_format_callback (t_fn_init_canvas_format init_canvas) __attribute__ ((weak));
+
 typedef void (*t_fn_lock_canvas) ();
 extern "C" void video_android_set_locking_callbacks (t_fn_lock_canvas lock_canvas, t_fn_lock_canvas unlock_canvas);
 
@@ -39,61 +51,59 @@ extern "C" void sound_android_set_pcm_callbacks (t_fn_get_sample_rate get_sample
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 engine_s g_engine; ///< The one and only global object of the game!
 
+//The size of the emulator PCM ring (~370 ms of 16 bit stereo sound at 44.1 kHz)
+static const uint32_t s_pcm_ring_capacity = 64 * 1024;
+
+//The waits of the frame handshake wake up at least this often to check the warp state
+static const chrono::milliseconds s_frame_barrier_timeout (20);
+
 struct s_auto_vsync_lock {
-	s_auto_vsync_lock () {
+	bool entered;
+
+	s_auto_vsync_lock () : entered (false) {
+		if (g_engine.is_warp)
+			return;
+
+		FramePhaseTimer timer (FramePhase::HandshakeWait);
 		while (!g_engine.is_warp) {
-			{
-				lock_guard <recursive_mutex> lock (g_engine.vsync_lock);
-				if (g_engine.run_game)
-					break;
+			if (g_engine.frame_barrier.EnterGameFrame (s_frame_barrier_timeout)) {
+				entered = true;
+				break;
 			}
-
-			sched_yield ();
 		}
 	}
 
 	~s_auto_vsync_lock () {
-		if (!g_engine.is_warp) {
-			lock_guard <recursive_mutex> lock (g_engine.vsync_lock);
-			g_engine.run_game = false;
-		}
+		if (entered)
+			g_engine.frame_barrier.LeaveGameFrame ();
 	}
 };
 
 static void UIEventCallback () {
-	//Try to set run_game flag to true (only if the value was false before!)
+	//Start a game frame (only if the previous one ended!)
+	bool started = false;
 	while (!g_engine.is_warp) {
-		{
-			lock_guard <recursive_mutex> lock (g_engine.vsync_lock);
-			if (!g_engine.run_game) {
-//				LOGD ("enter UI callback");
-				g_engine.run_game = true;
-				break;
-			}
+		if (g_engine.frame_barrier.StartGameFrame (s_frame_barrier_timeout)) {
+//			LOGD ("enter UI callback");
+			started = true;
+			break;
 		}
-
-		sched_yield ();
 	}
 
 	//... Here runs the overlay game code ...
 
-	//Wait until run_game flag will be false again
-	while (!g_engine.is_warp) {
-		{
-			lock_guard <recursive_mutex> lock (g_engine.vsync_lock);
-			if (!g_engine.run_game) {
-//				LOGD ("quit UI callback");
-				break;
-			}
+	//Wait until the game frame ends
+	while (started && !g_engine.is_warp) {
+		if (g_engine.frame_barrier.WaitGameFrame (s_frame_barrier_timeout)) {
+//			LOGD ("quit UI callback");
+			break;
 		}
-
-		sched_yield ();
 	}
 }
 
-static int InitCanvas (uint32_t width, uint32_t height, uint32_t bpp, uint32_t visible_width, uint32_t visible_height, uint8_t** buffer, uint32_t* pitch) {
-	CHECKMSG (buffer != nullptr, "InitCanvas () - buffer cannot be nullptr!");
-	CHECKMSG (pitch != nullptr, "InitCanvas () - pitch cannot be nullptr!");
+static void SetupCanvas (uint32_t format, uint32_t width, uint32_t height, uint32_t bpp, uint32_t visible_width, uint32_t visible_height, uint8_t** buffer, uint32_t* pitch) {
+	CHECKMSG (buffer != nullptr, "SetupCanvas () - buffer cannot be nullptr!");
+	CHECKMSG (pitch != nullptr, "SetupCanvas () - pitch cannot be nullptr!");
 
 	uint32_t bytePerPixel = bpp / 8;
 
@@ -101,6 +111,7 @@ static int InitCanvas (uint32_t width, uint32_t height, uint32_t bpp, uint32_t v
 	g_engine.canvas_height = height;
 	g_engine.canvas_bit_per_pixel = bpp;
 	g_engine.canvas_pitch = width * bytePerPixel;
+	g_engine.canvas_format = format;
 
 	g_engine.visible_width = visible_width;
 	g_engine.visible_height = visible_height;
@@ -110,20 +121,52 @@ static int InitCanvas (uint32_t width, uint32_t height, uint32_t bpp, uint32_t v
 	g_engine.canvas.resize (g_engine.canvas_pitch * height);
 	*buffer = &g_engine.canvas[0];
 
-	g_engine.canvas_dirty = false;
-	g_engine.run_game = false;
-
+	g_engine.canvas_frames.Resize (g_engine.canvas_pitch * visible_height);
+	g_engine.frame_barrier.Reset (); //A game frame started on the previous canvas is not waited for
 	g_engine.canvas_inited = true;
+}
+
+static int InitCanvas (uint32_t width, uint32_t height, uint32_t bpp, uint32_t visible_width, uint32_t visible_height, uint8_t** buffer, uint32_t* pitch) {
+	//Compatibility path: the emulator renders its whole canvas in BGRA
+	SetupCanvas (CANVAS_FORMAT_BGRA8888, width, height, bpp, visible_width, visible_height, buffer, pitch);
+	return 0;
+}
+
+static int InitCanvasFormat (uint32_t width, uint32_t height, uint32_t visible_width, uint32_t visible_height,
+							 const uint32_t* formats, uint32_t format_count, uint32_t* format, uint32_t* bpp, uint8_t** buffer, uint32_t* pitch) {
+	CHECKMSG (formats != nullptr || format_count == 0, "InitCanvasFormat () - formats cannot be nullptr!");
+	CHECKMSG (format != nullptr, "InitCanvasFormat () - format cannot be nullptr!");
+	CHECKMSG (bpp != nullptr, "InitCanvasFormat () - bpp cannot be nullptr!");
+
+	//Choose the first offered format which can be uploaded to GL without conversion (BGRA is always available)
+	const uint32_t preferredFormats[] = { CANVAS_FORMAT_RGBA8888, CANVAS_FORMAT_RGB565 };
+
+	*format = CANVAS_FORMAT_BGRA8888;
+	for (uint32_t preferred : preferredFormats) {
+		if (find (formats, formats + format_count, preferred) != formats + format_count) {
+			*format = preferred;
+			break;
+		}
+	}
+
+	*bpp = *format == CANVAS_FORMAT_RGB565 ? 16 : 32;
+
+	//The pitch matches the visible crop, so the canvas contains only the visible area
+	SetupCanvas (*format, visible_width, visible_height, *bpp, visible_width, visible_height, buffer, pitch);
 	return 0;
 }
 
 static void LockCanvas () {
-	g_engine.canvas_lock.lock ();
+	//Nothing to do, the canvas is owned by the emulator thread (frames are handed over in UnlockCanvas)
 }
 
 static void UnlockCanvas () {
-	g_engine.canvas_dirty = true;
-	g_engine.canvas_lock.unlock ();
+	//Copy the visible rows of the finished frame into the writer slot, then publish it to the game thread (never waits for the renderer)
+	memcpy (g_engine.canvas_frames.WriteBuffer (), &g_engine.canvas[0], g_engine.canvas_frames.Size ());
+	g_engine.canvas_frames.Publish (g_engine.emulator_frame);
+
+	//The sound written from now on belongs to the next frame
+	++g_engine.emulator_frame;
 }
 
 static void DisplaySpeed (double speed, double frame_rate, int warp_enabled) {
@@ -139,6 +182,59 @@ static void DisplaySpeed (double speed, double frame_rate, int warp_enabled) {
 		Game::ContentManager ().DisplayStatus (ss.str ());
 #endif //PRODUCTION_VERSION
 	}
+
+#ifndef PRODUCTION_VERSION
+	//Log the frame handshake wait times since the last speed report
+	static uint64_t last_wait_nanos[2] = { 0, 0 };
+
+	const FrameBarrier::WaitStats& emulatorStats = g_engine.frame_barrier.Stats (FrameBarrier::Side::Emulator);
+	const FrameBarrier::WaitStats& gameStats = g_engine.frame_barrier.Stats (FrameBarrier::Side::Game);
+	uint64_t emulatorWaitNanos = emulatorStats.waitNanos.load (memory_order_relaxed);
+	uint64_t gameWaitNanos = gameStats.waitNanos.load (memory_order_relaxed);
+
+	LOGD ("frame handshake wait - emulator: %.2f ms (max: %.2f ms, timeouts: %llu), game: %.2f ms (max: %.2f ms, timeouts: %llu)",
+		  (double) (emulatorWaitNanos - last_wait_nanos[0]) / 1e6, (double) emulatorStats.maxWaitNanos.load (memory_order_relaxed) / 1e6,
+		  (unsigned long long) emulatorStats.timeoutCount.load (memory_order_relaxed),
+		  (double) (gameWaitNanos - last_wait_nanos[1]) / 1e6, (double) gameStats.maxWaitNanos.load (memory_order_relaxed) / 1e6,
+		  (unsigned long long) gameStats.timeoutCount.load (memory_order_relaxed));
+
+	last_wait_nanos[0] = emulatorWaitNanos;
+	last_wait_nanos[1] = gameWaitNanos;
+
+	//Log the sound dropped by the PCM ring (the game thread did not drain it in time)
+	static uint32_t last_pcm_overflow_count = 0;
+
+	uint32_t pcmOverflowCount = g_engine.pcm.OverflowCount ();
+	if (pcmOverflowCount != last_pcm_overflow_count) {
+		LOGD ("pcm ring overflow - writes: %u, bytes: %llu (total)", pcmOverflowCount, (unsigned long long) g_engine.pcm.OverflowBytes ());
+		last_pcm_overflow_count = pcmOverflowCount;
+	}
+
+	//Log the telemetry of the PCM output (totals since the output was opened)
+	PCMStats pcmStats = Game::ContentManager ().GetPCMStats ();
+	if (pcmStats.callbackCount > 0) {
+		LOGD ("pcm output - callbacks: %u, underruns: %u (%llu bytes), overruns: %u (%llu bytes), jitter: %.0f/%.0f/%.0f us (mean/p99/max), queue depth: %.2f (max: %u), fill: %.1f ms, ratio: %.4f",
+			  pcmStats.callbackCount, pcmStats.underrunCount, (unsigned long long) pcmStats.underrunBytes,
+			  pcmStats.overrunCount, (unsigned long long) pcmStats.overrunBytes,
+			  pcmStats.jitterMeanMicros, pcmStats.jitterP99Micros, pcmStats.jitterMaxMicros,
+			  pcmStats.queueDepthMean, pcmStats.queueDepthMax, pcmStats.fillMeanMillis, pcmStats.ratio);
+	}
+
+	//Log the offset of the sound to the picture (totals since the last reset)
+	AVSync::Stats syncStats = AVSync::Get ().Summarize ();
+	if (syncStats.count > 0) {
+		LOGD ("a/v sync - offset: %.1f ms (mean: %.1f ms, min: %.1f ms, max: %.1f ms, p99: %.1f ms), correction: %.1f ms, skipped frames: %u, unmatched: %u",
+			  syncStats.smoothedMicros / 1000.0, syncStats.meanMicros / 1000.0, syncStats.minMicros / 1000.0, syncStats.maxMicros / 1000.0,
+			  syncStats.absolute.p99Micros / 1000.0, syncStats.correctionMicros / 1000.0, syncStats.skippedCount, syncStats.unmatchedCount);
+	}
+
+	//Log the GL state calls of the last frame (issued to the driver and filtered by the state tracker)
+	GLState::Stats glStats = GLState::Get ().GetStats ();
+	LOGD ("gl state - issued: %u, filtered: %u (last frame), issued: %.1f, filtered: %.1f (per frame)",
+		  glStats.lastIssuedCount, glStats.lastFilteredCount,
+		  glStats.frameCount > 0 ? (double) glStats.issuedCount / (double) glStats.frameCount : 0.0,
+		  glStats.frameCount > 0 ? (double) glStats.filteredCount / (double) glStats.frameCount : 0.0);
+#endif //PRODUCTION_VERSION
 }
 
 static int SoundGetSampleRate () {
@@ -146,32 +242,24 @@ static int SoundGetSampleRate () {
 }
 
 static void SoundInit (int numChannels, int sampleRate, int bytesPerSec) {
-	lock_guard <recursive_mutex> lock (g_engine.pcm_lock);
-
 	g_engine.pcm_sampleRate = (uint32_t)sampleRate;
 	g_engine.pcm_bytesPerSec = (uint32_t)bytesPerSec;
 	g_engine.pcm_numChannels = (uint32_t)numChannels;
 
-	g_engine.pcm.clear ();
-	g_engine.pcm_dirty = false;
+	g_engine.pcm.Discard ();
 }
 
 static void SoundClose () {
-	lock_guard <recursive_mutex> lock (g_engine.pcm_lock);
-
 	g_engine.pcm_sampleRate = 0;
 	g_engine.pcm_bytesPerSec = 0;
 	g_engine.pcm_numChannels = 0;
 
-	g_engine.pcm.clear ();
-	g_engine.pcm_dirty = false;
+	g_engine.pcm.Discard ();
 }
 
 static void SoundWrite (const uint8_t* buffer, size_t size) {
-	lock_guard <recursive_mutex> lock (g_engine.pcm_lock);
-
-	g_engine.pcm.push_back (vector<uint8_t> (buffer, buffer + size));
-	g_engine.pcm_dirty = true;
+	//Never blocks and never allocates: when the game thread falls behind, the rest is dropped (counted by the ring)
+	g_engine.pcm.Write (buffer, (uint32_t) size, g_engine.emulator_frame);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -182,6 +270,8 @@ extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_init (JNI
 	CHECKMSG (g_engine.contentManager != nullptr, "g_engine.contentManager must be initialized before GameLib init!");
 	CHECKMSG (g_engine.pointerIDs != nullptr, "g_engine.pointerIDs must be initialized before GameLib init!");
 
+	GLState::Get ().Invalidate (); //A new context (the tracked state is of the previous one)
+
 	if (!g_engine.game) {
 		g_engine.game.reset (new MayhemGame (*(g_engine.contentManager)));
 		g_engine.game->Init (screenWidth, screenHeight, refWidth, refHeight);
@@ -196,20 +286,22 @@ extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_init (JNI
 	g_engine.canvas_height = 0;
 	g_engine.canvas_bit_per_pixel = 0;
 	g_engine.canvas_pitch = 0;
+	g_engine.canvas_format = CANVAS_FORMAT_BGRA8888;
 
 	g_engine.visible_width = 0;
 	g_engine.visible_height = 0;
 
-	g_engine.canvas_dirty = false;
-
 	g_engine.deviceSamplingRate = (uint32_t) deviceSamplingRate;
 	g_engine.deviceBufferFrames = (uint32_t) deviceBufferFrames;
 	g_engine.deviceBufferCount = (uint32_t) deviceBufferCount;
+	g_engine.pcm_tuner.Init (g_engine.deviceSamplingRate, g_engine.deviceBufferFrames, g_engine.deviceBufferCount);
+	g_engine.pcm_tuner.Load (*g_engine.contentManager);
 	g_engine.pcm_sampleRate = 0;
 	g_engine.pcm_bytesPerSec = 0;
 	g_engine.pcm_numChannels = 0;
 
-	g_engine.pcm_dirty = false;
+	if (g_engine.pcm.Capacity () == 0) //Allocated once, before the emulator thread starts
+		g_engine.pcm.Reset (s_pcm_ring_capacity);
 
 	glViewport (0, 0, screenWidth, screenHeight);
 }
@@ -237,10 +329,16 @@ extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_step (JNI
 	if (ui_emulation_is_paused ()) //Handle pause
 		return;
 
-	g_engine.game->Update ((float)elapsedTime);
+	{
+		FramePhaseTimer timer (FramePhase::Update);
+		g_engine.game->Update ((float)elapsedTime);
+	}
 
 	//Render the game
-	g_engine.game->Render ();
+	{
+		FramePhaseTimer timer (FramePhase::Render);
+		g_engine.game->Render ();
+	}
 }
 
 extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_pause (JNIEnv* env, jclass type) {
@@ -248,11 +346,15 @@ extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_pause (JN
 
 	g_engine.game->Pause ();
 	ui_pause_emulation ();
+
+	//The surface view releases the GL context, so the cached textures are not kept over the pause
+	TextureCache::Get ().Trim ();
 }
 
 extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resume (JNIEnv* env, jclass type) {
 	g_engine.lastUpdateTime = -1;
 
+	GLState::Get ().Invalidate (); //A new context
 	g_engine.game->Continue ();
 	ui_continue_emulation ();
 
@@ -263,6 +365,12 @@ extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isPau
 	return ui_emulation_is_paused () ? JNI_TRUE : JNI_FALSE;
 }
 
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_shutdown (JNIEnv* env, jclass type) {
+	//The activity is destroyed (the GL thread is paused already): the texture loader workers are stopped while the game
+	//and its content manager are alive, not by the static destructor at the exit of the process
+	TextureLoader::Get ().Shutdown ();
+}
+
 extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resize (JNIEnv* env, jclass clazz, jint newScreenWidth, jint newScreenHeight) {
 	//Sync game to vsync, when not in warp mode
 	s_auto_vsync_lock autoVsyncLock;
@@ -274,6 +382,129 @@ extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resize (J
 		g_engine.game->Resize (newScreenWidth, newScreenHeight);
 }
 
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getFrameTimings (JNIEnv* env, jclass clazz) {
+	return env->NewStringUTF (FrameTimer::Get ().ToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetFrameTimings (JNIEnv* env, jclass clazz) {
+	FrameTimer::Get ().Reset ();
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_dumpFrameTimings (JNIEnv* env, jclass clazz, jstring fileName) {
+	//One JSON line for each dump, so the file collects the snapshots of a session
+	if (g_engine.contentManager)
+		g_engine.contentManager->WriteTextFile (JavaString (fileName).getString (), FrameTimer::Get ().ToJSON () + "\n", true);
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setSpriteBatch (JNIEnv* env, jclass clazz, jboolean enabled) {
+	SpriteBatch::SetEnabled (enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isSpriteBatch (JNIEnv* env, jclass clazz) {
+	return SpriteBatch::IsEnabled () ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setGLStateFilter (JNIEnv* env, jclass clazz, jboolean enabled) {
+	GLState::SetEnabled (enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isGLStateFilter (JNIEnv* env, jclass clazz) {
+	return GLState::IsEnabled () ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getGLState (JNIEnv* env, jclass clazz) {
+	return env->NewStringUTF (GLState::Get ().ToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetGLState (JNIEnv* env, jclass clazz) {
+	GLState::Get ().ResetStats ();
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setTextureCacheBudget (JNIEnv* env, jclass clazz, jint megabytes) {
+	TextureCache::Get ().SetBudget ((uint64_t) max (megabytes, 0) * 1024 * 1024);
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getTextureCache (JNIEnv* env, jclass clazz) {
+	return env->NewStringUTF (TextureCache::Get ().ToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetTextureCache (JNIEnv* env, jclass clazz) {
+	TextureCache::Get ().ResetStats ();
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setTextureLoader (JNIEnv* env, jclass clazz, jboolean async) {
+	TextureLoader::SetEnabled (async == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isTextureLoader (JNIEnv* env, jclass clazz) {
+	return TextureLoader::IsEnabled () ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getTextureLoader (JNIEnv* env, jclass clazz) {
+	return env->NewStringUTF (TextureLoader::Get ().ToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetTextureLoader (JNIEnv* env, jclass clazz) {
+	TextureLoader::Get ().ResetStats ();
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setETC1Textures (JNIEnv* env, jclass clazz, jboolean enabled) {
+	TextureLoader::SetETC1Enabled (enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isETC1Textures (JNIEnv* env, jclass clazz) {
+	return TextureLoader::IsETC1Enabled () ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setNativeImageDecode (JNIEnv* env, jclass clazz, jboolean enabled) {
+	AndroidContentManager::SetNativeImageDecode (enabled == JNI_TRUE);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isNativeImageDecode (JNIEnv* env, jclass clazz) {
+	return AndroidContentManager::IsNativeImageDecode () ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getImageLoads (JNIEnv* env, jclass clazz) {
+	CHECKMSG (g_engine.contentManager != nullptr, "g_engine.contentManager must be initialized before getImageLoads!");
+	return env->NewStringUTF (static_cast<AndroidContentManager*> (g_engine.contentManager.get ())->ImageStatsToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetImageLoads (JNIEnv* env, jclass clazz) {
+	CHECKMSG (g_engine.contentManager != nullptr, "g_engine.contentManager must be initialized before resetImageLoads!");
+	static_cast<AndroidContentManager*> (g_engine.contentManager.get ())->ResetImageStats ();
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_benchmarkImageLoads (JNIEnv* env, jclass clazz) {
+	CHECKMSG (g_engine.contentManager != nullptr, "g_engine.contentManager must be initialized before benchmarkImageLoads!");
+	return env->NewStringUTF (static_cast<AndroidContentManager*> (g_engine.contentManager.get ())->BenchmarkImages ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_setDirectPCM (JNIEnv* env, jclass clazz, jboolean direct) {
+	//The game thread reopens the audio output on the new path
+	g_engine.pcm.SetDirect (direct == JNI_TRUE);
+	g_engine.pcm.ResetLatency ();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_isDirectPCM (JNIEnv* env, jclass clazz) {
+	return g_engine.pcm.IsDirect () ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getPCMLatency (JNIEnv* env, jclass clazz) {
+	return env->NewStringUTF (g_engine.pcm.LatencyToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetPCMLatency (JNIEnv* env, jclass clazz) {
+	g_engine.pcm.ResetLatency ();
+}
+
+extern "C" JNIEXPORT jstring JNICALL Java_com_mayheminmonsterland_GameLib_getAVSync (JNIEnv* env, jclass clazz) {
+	return env->NewStringUTF (AVSync::Get ().ToJSON ().c_str ());
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_mayheminmonsterland_GameLib_resetAVSync (JNIEnv* env, jclass clazz) {
+	AVSync::Get ().Reset ();
+}
+
 extern "C" JNIEXPORT jboolean JNICALL Java_com_mayheminmonsterland_GameLib_hasPointerID (JNIEnv* env, jclass clazz, jint id) {
 	return g_engine.pointerIDs && g_engine.pointerIDs->find (id) != g_engine.pointerIDs->end () ? JNI_TRUE : JNI_FALSE;
 }
@@ -350,6 +581,8 @@ extern "C" JNIEXPORT jint JNICALL Java_com_mayheminmonsterland_GameLib_runEmulat
 	//Set callbacks of engine
 	ui_android_init_callbacks (&UIEventCallback);
 	video_android_set_init_callback (&InitCanvas);
+	if (video_android_set_init_format_callback != nullptr) //The emulator is able to render GL ready formats
+		video_android_set_init_format_callback (&InitCanvasFormat);
 	video_android_set_locking_callbacks (&LockCanvas, &UnlockCanvas);
 	vsyncarch_android_set_speed_callback (&DisplaySpeed);
 	sound_android_set_pcm_callbacks (&SoundGetSampleRate, &SoundInit, &SoundClose, &SoundWrite);
@@ -2,6 +2,25 @@
 
 typedef void* Image;
 
+class PCMStream;
+struct PCMStamp;
+
+/// Telemetry of the PCM output (totals since OpenPCM).
+struct PCMStats {
+	uint32_t callbackCount; ///< The buffers enqueued to the device.
+	uint32_t underrunCount; ///< The buffers not filled completely by the sound source (padded with silence).
+	uint64_t underrunBytes; ///< The bytes of the padding silence.
+	uint32_t overrunCount; ///< The writes dropped (partly), because the sound source was full.
+	uint64_t overrunBytes; ///< The dropped bytes.
+	double jitterMeanMicros; ///< The deviation of the callback intervals from the buffer duration.
+	double jitterP99Micros;
+	double jitterMaxMicros;
+	double queueDepthMean; ///< The buffers in the device queue at the callbacks.
+	uint32_t queueDepthMax;
+	double fillMeanMillis; ///< The sound waiting in the source at the callbacks.
+	double ratio; ///< The resampling ratio of the clock drift compensation (input / output).
+};
+
 /// The interface of the OS specific content managers.
 class IContentManager {
 //Image interface
@@ -14,6 +33,12 @@ public:
 	virtual int GetWidth (const Image image) const = 0;
 	virtual int GetHeight (const Image image) const = 0;
 
+	/// Release the resources of a thread loaded images (at the end of the threads other than the GL thread).
+	virtual void ReleaseImageThread () = 0;
+
+	/// The content of an asset (the compressed textures, empty when the asset is missing, any thread).
+	virtual vector<uint8_t> ReadAsset (const string& asset) const = 0;
+
 //Sound interface
 public:
 	virtual int LoadSound (const string& asset) = 0;
@@ -29,7 +54,14 @@ public:
 	virtual void ClosePCM () = 0;
 	virtual bool IsOpenedPCM () const = 0;
 
-	virtual void WritePCM (const uint8_t* buffer, size_t size) = 0;
+	/// Set the stream of the emulator sound before OpenPCM: a direct stream is read by the audio callback, else the sound is pushed by WritePCM (the latency is recorded into the stream in both cases).
+	virtual void SetPCMStream (PCMStream* stream) = 0;
+
+	/// The telemetry of the audio output (any thread).
+	virtual PCMStats GetPCMStats () const = 0;
+
+	/// Push sound to the audio output, stamp is the stamp of the bytes in the stream (its time is 0 when unknown).
+	virtual void WritePCM (const uint8_t* buffer, size_t size, const PCMStamp& stamp) = 0;
 
 //Utility interface
 public:
@@ -0,0 +1,47 @@
+#pragma once
+
+/// The format of a PCM output stream.
+struct AudioFormat {
+	uint32_t numChannels;
+	uint32_t sampleRate;
+	uint32_t bytesPerSec;
+	uint32_t bufferSize; ///< The bytes in one device buffer.
+	uint32_t bufferCount; ///< The buffers in the device queue.
+};
+
+///
+/// The audio device under the PCM output: a queue of buffers played one after the other.
+///
+/// The output enqueues its buffers, and the backend calls the buffer callback each time the device finished one
+/// (on its own audio thread), so the output can refill and enqueue the next one. The buffer memory belongs to the
+/// output and must stay valid until its callback.
+class IAudioBackend {
+//Definitions
+public:
+	typedef void (*BufferCallback) (void* context);
+
+//Construction
+public:
+	virtual ~IAudioBackend () {}
+
+//Interface
+public:
+	virtual const char* Name () const = 0;
+
+	/// Create the output stream in the paused state. Returns false, when the device cannot play the format.
+	virtual bool Open (const AudioFormat& format, BufferCallback callback, void* context) = 0;
+
+	/// Stop and release the output stream (no callback is called after it returns).
+	virtual void Close () = 0;
+
+	/// Start playing the enqueued buffers.
+	virtual void Start () = 0;
+
+	virtual bool Enqueue (const uint8_t* buffer, uint32_t size) = 0;
+
+	/// The count of the buffers waiting in the device queue (the played one included).
+	virtual uint32_t QueuedCount () const = 0;
+
+	/// The clock of the device in nanoseconds (the steady clock of PCMStream::Now for real devices).
+	virtual uint64_t Now () const = 0;
+};
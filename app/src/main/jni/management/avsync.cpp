@@ -0,0 +1,200 @@
+#include "../pch.h"
+#include "avsync.h"
+#include "pcmstream.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+constexpr double AVSync::Smoothing;
+constexpr double AVSync::Gain;
+constexpr int64_t AVSync::MaxStep;
+constexpr int64_t AVSync::MaxLead;
+constexpr int64_t AVSync::MaxLag;
+constexpr int64_t AVSync::MaxAdvance;
+constexpr int64_t AVSync::MaxDelay;
+
+AVSync::AVSync () :
+	mClock (&AVSync::SteadyClock),
+	mClockContext (nullptr),
+	mHasPresented (false),
+	mLastPresented (0),
+	mStartedWriteIndex (0),
+	mStartedReadIndex (0),
+	mHasStarted (false),
+	mLastStarted (0),
+	mHasOffset (false),
+	mCorrecting (false),
+	mOffset (0),
+	mCorrection (0),
+	mSmoothedOffset (0) {
+	for (Event& presented : mPresented)
+		presented = { 0, 0 };
+
+	Reset ();
+}
+
+void AVSync::SetClock (Clock clock, void* context) {
+	mClock = clock != nullptr ? clock : &AVSync::SteadyClock;
+	mClockContext = clock != nullptr ? context : nullptr;
+}
+
+uint64_t AVSync::Now () const {
+	return mClock (mClockContext);
+}
+
+void AVSync::Present (uint32_t frame) {
+	if (mHasPresented) {
+		int32_t gap = (int32_t) (frame - mLastPresented);
+		if (gap <= 0) //Presented already
+			return;
+
+		if (gap > 1)
+			mSkippedCount.fetch_add ((uint32_t) gap - 1, memory_order_relaxed);
+	}
+
+	mPresented[frame % HistoryCount] = { frame, Now () };
+	mHasPresented = true;
+	mLastPresented = frame;
+	mPresentedCount.fetch_add (1, memory_order_relaxed);
+}
+
+void AVSync::Start (uint32_t frame, uint64_t playTime) {
+	//The sound of a frame spans more device buffers, only its first one starts the frame
+	if (mHasStarted && (int32_t) (frame - mLastStarted) <= 0)
+		return;
+
+	mHasStarted = true;
+	mLastStarted = frame;
+
+	uint32_t writeIndex = mStartedWriteIndex.load (memory_order_relaxed);
+	if (writeIndex - mStartedReadIndex.load (memory_order_acquire) >= EventCount) {
+		mDroppedCount.fetch_add (1, memory_order_relaxed);
+		return;
+	}
+
+	mStarted[writeIndex % EventCount] = { frame, playTime };
+	mStartedWriteIndex.store (writeIndex + 1, memory_order_release);
+}
+
+void AVSync::Update () {
+	uint32_t readIndex = mStartedReadIndex.load (memory_order_relaxed);
+	uint32_t writeIndex = mStartedWriteIndex.load (memory_order_acquire);
+	while (readIndex != writeIndex) {
+		const Event& started = mStarted[readIndex % EventCount];
+		if (!mHasPresented || (int32_t) (started.frame - mLastPresented) > 0) //The sound is ahead of the picture, wait for its presentation
+			break;
+
+		Match (started);
+		++readIndex;
+	}
+
+	mStartedReadIndex.store (readIndex, memory_order_release);
+}
+
+void AVSync::Restart () {
+	mStartedReadIndex.store (mStartedWriteIndex.load (memory_order_acquire), memory_order_release);
+
+	for (Event& presented : mPresented)
+		presented = { 0, 0 };
+
+	mHasPresented = false;
+	mLastPresented = 0;
+	mHasOffset = false;
+	mCorrecting = false;
+	mOffset = 0;
+	mSmoothedOffset.store (0, memory_order_relaxed);
+}
+
+void AVSync::Reset () {
+	mSampleCount.store (0, memory_order_relaxed);
+	mOffsetSum.store (0, memory_order_relaxed);
+	mMinOffset.store (0, memory_order_relaxed);
+	mMaxOffset.store (0, memory_order_relaxed);
+	mAbsOffset.Reset ();
+	mPresentedCount.store (0, memory_order_relaxed);
+	mSkippedCount.store (0, memory_order_relaxed);
+	mUnmatchedCount.store (0, memory_order_relaxed);
+	mDroppedCount.store (0, memory_order_relaxed);
+}
+
+AVSync::Stats AVSync::Summarize () const {
+	Stats stats;
+	stats.count = mSampleCount.load (memory_order_relaxed);
+	stats.meanMicros = stats.count > 0 ? (double) mOffsetSum.load (memory_order_relaxed) / 1000.0 / (double) stats.count : 0;
+	stats.minMicros = (double) mMinOffset.load (memory_order_relaxed) / 1000.0;
+	stats.maxMicros = (double) mMaxOffset.load (memory_order_relaxed) / 1000.0;
+	stats.smoothedMicros = (double) mSmoothedOffset.load (memory_order_relaxed) / 1000.0;
+	stats.absolute = mAbsOffset.Summarize ();
+	stats.correctionMicros = (double) Correction () / 1000.0;
+	stats.presentedCount = mPresentedCount.load (memory_order_relaxed);
+	stats.skippedCount = mSkippedCount.load (memory_order_relaxed);
+	stats.unmatchedCount = mUnmatchedCount.load (memory_order_relaxed);
+	stats.droppedCount = mDroppedCount.load (memory_order_relaxed);
+	return stats;
+}
+
+string AVSync::ToJSON () const {
+	Stats stats = Summarize ();
+
+	stringstream ss;
+	ss << fixed << setprecision (1) << "{" <<
+		"\"count\":" << stats.count <<
+		",\"mean\":" << stats.meanMicros <<
+		",\"min\":" << stats.minMicros <<
+		",\"max\":" << stats.maxMicros <<
+		",\"smoothed\":" << stats.smoothedMicros <<
+		",\"p50\":" << stats.absolute.p50Micros <<
+		",\"p95\":" << stats.absolute.p95Micros <<
+		",\"p99\":" << stats.absolute.p99Micros <<
+		",\"correction\":" << stats.correctionMicros <<
+		",\"presented\":" << stats.presentedCount <<
+		",\"skipped\":" << stats.skippedCount <<
+		",\"unmatched\":" << stats.unmatchedCount <<
+		",\"dropped\":" << stats.droppedCount << "}";
+	return ss.str ();
+}
+
+void AVSync::Match (const Event& started) {
+	const Event& presented = mPresented[started.frame % HistoryCount];
+	if (presented.frame != started.frame || presented.time == 0) { //The picture was skipped (or is too old)
+		mUnmatchedCount.fetch_add (1, memory_order_relaxed);
+		return;
+	}
+
+	int64_t offset = (int64_t) (started.time - presented.time);
+
+	uint64_t count = mSampleCount.fetch_add (1, memory_order_relaxed);
+	mOffsetSum.fetch_add (offset, memory_order_relaxed);
+	if (count == 0 || offset < mMinOffset.load (memory_order_relaxed))
+		mMinOffset.store (offset, memory_order_relaxed);
+	if (count == 0 || offset > mMaxOffset.load (memory_order_relaxed))
+		mMaxOffset.store (offset, memory_order_relaxed);
+	mAbsOffset.Record ((uint64_t) (offset < 0 ? -offset : offset));
+
+	Correct (offset);
+}
+
+void AVSync::Correct (int64_t offset) {
+	mOffset = mHasOffset ? mOffset + ((double) offset - mOffset) * Smoothing : (double) offset;
+	mHasOffset = true;
+	mSmoothedOffset.store ((int64_t) mOffset, memory_order_relaxed);
+
+	//Start correcting out of the tolerated window, stop in the middle half of it (no hunting around its edges)
+	if (mOffset < (double) -MaxLead || mOffset > (double) MaxLag)
+		mCorrecting = true;
+	else if (mOffset > (double) -MaxLead / 2 && mOffset < (double) MaxLag / 2)
+		mCorrecting = false;
+
+	if (!mCorrecting)
+		return;
+
+	//Towards the center of the window: a late sound (positive offset) needs less delay
+	double center = (double) (MaxLag - MaxLead) / 2;
+	int64_t step = max (-MaxStep, min (MaxStep, (int64_t) ((mOffset - center) * Gain)));
+	int64_t correction = max (-MaxAdvance, min (MaxDelay, Correction () - step));
+	mCorrection.store (correction, memory_order_relaxed);
+}
+
+uint64_t AVSync::SteadyClock (void* context) {
+	return PCMStream::Now ();
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "frametimer.h"
+
+///
+/// Measures and corrects the offset between the picture and the sound of the emulator (A/V sync).
+///
+/// Both streams are tagged with the emulator frame: the picture by the triple buffer, the sound by the stamps of the PCM
+/// stream. The game thread reports the presentation of each frame, the audio output reports the playback start of the
+/// sound of each frame (from the audio thread, through a lock-free queue), and the game thread matches them. The offset
+/// is the start of the sound minus the presentation of the picture of the same frame (positive: the sound is late).
+///
+/// The offset is corrected by the audio rate: the correction moves the fill target of the drift compensation of the PCM
+/// output, which reaches it by a small (inaudible) resampling ratio change, so the sound plays earlier or later. The
+/// picture is never held back, the triple buffer presents the newest frame of the emulator always.
+class AVSync {
+//Definitions
+public:
+	/// The time base of the presentation and the playback times (nanoseconds).
+	typedef uint64_t (*Clock) (void* context);
+
+	static constexpr double Smoothing = 0.1; ///< Weight of the new offset sample.
+	static constexpr double Gain = 0.05; ///< The part of the smoothed offset corrected after each sample...
+	static constexpr int64_t MaxStep = 50000; ///< ... but at most 50 us (2.5 ms/s at 50 Hz, slower than the drift compensation follows).
+	static constexpr int64_t MaxLead = 20000000; ///< The sound may be 20 ms early...
+	static constexpr int64_t MaxLag = 40000000; ///< ... and 40 ms late without correction (inside the 40 ms lead and 60 ms lag of EBU R37).
+	static constexpr int64_t MaxAdvance = 5000000; ///< The sound plays at most 5 ms earlier than with the base latency of the output (the fill margin)...
+	static constexpr int64_t MaxDelay = 100000000; ///< ... and at most 100 ms later.
+
+	/// The offset statistics (since Reset, times in microseconds).
+	struct Stats {
+		uint64_t count; ///< The matched frames (offset samples).
+		double meanMicros;
+		double minMicros;
+		double maxMicros;
+		double smoothedMicros; ///< The current (smoothed) offset.
+		LatencyHistogram::Summary absolute; ///< The distribution of the offset magnitude.
+		double correctionMicros; ///< The current delay correction of the sound (negative: earlier).
+		uint32_t presentedCount; ///< The presented frames.
+		uint32_t skippedCount; ///< The frames of the emulator never presented (replaced by a newer one in the triple buffer).
+		uint32_t unmatchedCount; ///< The sound starts without a presented picture.
+		uint32_t droppedCount; ///< The sound starts lost, because the game thread did not take them in time.
+	};
+
+private:
+	enum : uint32_t {
+		HistoryCount = 64, ///< The presented frames kept for matching (more than a second at 50 Hz).
+		EventCount = 64 ///< The sound starts waiting for the game thread.
+	};
+
+	struct Event {
+		uint32_t frame;
+		uint64_t time;
+	};
+
+//Data
+private:
+	Clock mClock;
+	void* mClockContext;
+
+	Event mPresented[HistoryCount]; ///< The presentations indexed by frame (game thread).
+	bool mHasPresented;
+	uint32_t mLastPresented; ///< The last presented frame.
+
+	Event mStarted[EventCount]; ///< The sound starts (written by the audio thread).
+	atomic<uint32_t> mStartedWriteIndex; ///< Advanced by the audio thread only.
+	atomic<uint32_t> mStartedReadIndex; ///< Advanced by the game thread only.
+	bool mHasStarted;
+	uint32_t mLastStarted; ///< The frame of the last reported sound start (audio thread).
+
+	bool mHasOffset;
+	bool mCorrecting; ///< The offset left the tolerated window (until it gets back to the middle of it).
+	double mOffset; ///< The smoothed offset in nanoseconds (game thread).
+	atomic<int64_t> mCorrection; ///< The delay correction of the sound in nanoseconds (read by the audio thread).
+
+	atomic<uint64_t> mSampleCount;
+	atomic<int64_t> mOffsetSum;
+	atomic<int64_t> mMinOffset;
+	atomic<int64_t> mMaxOffset;
+	atomic<int64_t> mSmoothedOffset;
+	LatencyHistogram mAbsOffset;
+	atomic<uint32_t> mPresentedCount;
+	atomic<uint32_t> mSkippedCount;
+	atomic<uint32_t> mUnmatchedCount;
+	atomic<uint32_t> mDroppedCount;
+
+//Construction
+private:
+	AVSync ();
+
+public:
+	static AVSync& Get () {
+		static AVSync inst;
+		return inst;
+	}
+
+//Interface
+public:
+	/// Set the time base (nullptr: the steady clock of PCMStream::Now). It has to be the clock of the audio backend.
+	void SetClock (Clock clock, void* context);
+
+	uint64_t Now () const;
+
+	/// The picture of the frame is presented now. (Game thread)
+	void Present (uint32_t frame);
+
+	/// The sound of the frame starts playing at playTime (only the first report of each frame is used). (Audio thread)
+	void Start (uint32_t frame, uint64_t playTime);
+
+	/// Match the sound starts with the presented frames and update the correction. (Game thread)
+	void Update ();
+
+	/// Forget the frames not matched yet (after a discontinuity of the streams). The correction is kept. (Game thread)
+	void Restart ();
+
+	/// The delay of the sound to add to the base latency of the audio output in nanoseconds (negative: earlier, any thread).
+	int64_t Correction () const {
+		return mCorrection.load (memory_order_relaxed);
+	}
+
+	/// Clear the statistics.
+	void Reset ();
+
+	Stats Summarize () const;
+
+	/// The statistics as a JSON object: {"count":..,"mean":..,"min":..,"max":..,"smoothed":..,"p50":..,"p95":..,"p99":..,
+	/// "correction":..,"presented":..,"skipped":..,"unmatched":..,"dropped":..} (times in microseconds, the percentiles of the magnitude)
+	string ToJSON () const;
+
+//Helper methods
+private:
+	void Match (const Event& started);
+	void Correct (int64_t offset);
+
+	static uint64_t SteadyClock (void* context);
+};
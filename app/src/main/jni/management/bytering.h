@@ -0,0 +1,151 @@
+#pragma once
+
+///
+/// Lock-free single producer, single consumer byte ring.
+///
+/// The buffer is allocated by Reset only, Write and Read never allocate and never wait (wait-free on both sides).
+/// The positions grow continuously (mod 2^32), the capacity is a power of two, so the offsets are masked positions.
+/// When the ring is full, Write drops the bytes not fitting in and counts them as overflow.
+class ByteRing {
+//Data
+private:
+	vector<uint8_t> mBuffer;
+	uint32_t mMask;
+
+	atomic<uint32_t> mWritePos; ///< Advanced by the producer only.
+	atomic<uint32_t> mReadPos; ///< Advanced by the consumer only.
+	atomic<uint32_t> mDiscardPos; ///< Set by the producer: everything before this position is skipped by the consumer.
+	atomic<uint32_t> mDiscardEpoch; ///< Advanced by the producer after mDiscardPos is set (the count of the discards).
+	uint32_t mTakenEpoch; ///< The last discard taken by the consumer.
+
+	atomic<uint64_t> mOverflowBytes;
+	atomic<uint32_t> mOverflowCount;
+
+//Construction
+public:
+	ByteRing () : mMask (0), mWritePos (0), mReadPos (0), mDiscardPos (0), mDiscardEpoch (0), mTakenEpoch (0), mOverflowBytes (0), mOverflowCount (0) {}
+
+//Interface
+public:
+	/// Allocate the ring (rounded up to a power of two) and clear the counters. (Not thread safe, call it only when none of the sides use the ring!)
+	void Reset (uint32_t capacity) {
+		uint32_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+
+		mBuffer.assign (size, 0);
+		mMask = size - 1;
+
+		mWritePos.store (0, memory_order_relaxed);
+		mReadPos.store (0, memory_order_relaxed);
+		mDiscardPos.store (0, memory_order_relaxed);
+		mDiscardEpoch.store (0, memory_order_relaxed);
+		mTakenEpoch = 0;
+		mOverflowBytes.store (0, memory_order_relaxed);
+		mOverflowCount.store (0, memory_order_release);
+	}
+
+	uint32_t Capacity () const {
+		return (uint32_t) mBuffer.size ();
+	}
+
+	/// The count of the bytes readable by the consumer (any thread, approximate on the producer side).
+	uint32_t Available () const {
+		return mWritePos.load (memory_order_acquire) - mReadPos.load (memory_order_acquire);
+	}
+
+	/// The stream position after the last written byte. (Producer thread)
+	uint32_t WritePosition () const {
+		return mWritePos.load (memory_order_relaxed);
+	}
+
+	/// The stream position of the next byte read (the discarded bytes are skipped). (Consumer thread)
+	uint32_t ReadPosition () {
+		return SkipDiscarded ();
+	}
+
+	/// Append bytes to the ring. Returns the count of the written bytes (less than size on overflow). (Producer thread)
+	uint32_t Write (const uint8_t* src, uint32_t size) {
+		uint32_t writePos = mWritePos.load (memory_order_relaxed);
+		uint32_t freeSize = Capacity () - (writePos - mReadPos.load (memory_order_acquire));
+
+		uint32_t count = min (size, freeSize);
+		if (count < size) {
+			mOverflowBytes.fetch_add (size - count, memory_order_relaxed);
+			mOverflowCount.fetch_add (1, memory_order_relaxed);
+			if (count == 0)
+				return 0;
+		}
+
+		uint32_t offset = writePos & mMask;
+		uint32_t firstPart = min (count, Capacity () - offset);
+		memcpy (&mBuffer[offset], src, firstPart);
+		if (count > firstPart)
+			memcpy (&mBuffer[0], src + firstPart, count - firstPart);
+
+		mWritePos.store (writePos + count, memory_order_release);
+		return count;
+	}
+
+	/// Make the consumer skip everything written so far (like a clear, but without touching the read position). (Producer thread)
+	void Discard () {
+		mDiscardPos.store (mWritePos.load (memory_order_relaxed), memory_order_relaxed);
+		mDiscardEpoch.store (mDiscardEpoch.load (memory_order_relaxed) + 1, memory_order_release);
+	}
+
+	/// Consume up to maxSize bytes in place: consumer (const uint8_t* data, uint32_t size) is called with the (at most two) contiguous parts. (Consumer thread)
+	template<class Consumer>
+	uint32_t Read (uint32_t maxSize, Consumer consumer) {
+		uint32_t readPos = SkipDiscarded ();
+		uint32_t count = min (maxSize, mWritePos.load (memory_order_acquire) - readPos);
+		if (count == 0)
+			return 0;
+
+		uint32_t offset = readPos & mMask;
+		uint32_t firstPart = min (count, Capacity () - offset);
+		consumer ((const uint8_t*) &mBuffer[offset], firstPart);
+		if (count > firstPart)
+			consumer ((const uint8_t*) &mBuffer[0], count - firstPart);
+
+		mReadPos.store (readPos + count, memory_order_release);
+		return count;
+	}
+
+	/// Copy up to maxSize bytes out of the ring. Returns the count of the copied bytes. (Consumer thread)
+	uint32_t Read (uint8_t* dest, uint32_t maxSize) {
+		return Read (maxSize, [&dest] (const uint8_t* data, uint32_t size) {
+			memcpy (dest, data, size);
+			dest += size;
+		});
+	}
+
+	/// The count of the bytes dropped by Write, because the ring was full.
+	uint64_t OverflowBytes () const {
+		return mOverflowBytes.load (memory_order_relaxed);
+	}
+
+	/// The count of the Write calls dropping bytes.
+	uint32_t OverflowCount () const {
+		return mOverflowCount.load (memory_order_relaxed);
+	}
+
+//Helper methods
+private:
+	uint32_t SkipDiscarded () {
+		uint32_t readPos = mReadPos.load (memory_order_relaxed);
+		uint32_t epoch = mDiscardEpoch.load (memory_order_acquire);
+		if (epoch == mTakenEpoch)
+			return readPos;
+
+		//A discard is taken once: its position is at most a capacity away from the read position, so the signed distance
+		//is valid (an old discard position would be far behind after 2^31 bytes, its distance turning positive)
+		mTakenEpoch = epoch;
+		uint32_t discardPos = mDiscardPos.load (memory_order_relaxed);
+		if ((int32_t) (discardPos - readPos) > 0) {
+			readPos = discardPos;
+			mReadPos.store (readPos, memory_order_release);
+		}
+
+		return readPos;
+	}
+};
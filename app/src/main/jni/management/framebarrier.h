@@ -0,0 +1,102 @@
+#pragma once
+
+///
+/// Blocking frame handshake between the emulator thread and the game (GL) thread.
+///
+/// The emulator starts a game frame and waits until the game finishes it, the game waits for the start
+/// of the frame and leaves it at the end. The waiting side sleeps on a condition variable instead of spinning.
+class FrameBarrier {
+//Definitions
+public:
+	enum class Side {
+		Emulator = 0,
+		Game = 1
+	};
+
+	/// Handshake wait counters of one side (readable from any thread).
+	struct WaitStats {
+		atomic<uint64_t> waitCount;
+		atomic<uint64_t> waitNanos;
+		atomic<uint64_t> maxWaitNanos;
+		atomic<uint64_t> timeoutCount;
+
+		WaitStats () : waitCount (0), waitNanos (0), maxWaitNanos (0), timeoutCount (0) {}
+	};
+
+//Data
+private:
+	mutex mLock;
+	condition_variable mCondition;
+	bool mGameTurn; ///< True between the start of a game frame and its end.
+
+	WaitStats mStats[2];
+
+//Construction
+public:
+	FrameBarrier () : mGameTurn (false) {}
+
+//Interface
+public:
+	/// Give the turn to the game thread. Returns false, when the previous game frame did not end in time. (Emulator thread)
+	bool StartGameFrame (chrono::milliseconds timeout) {
+		unique_lock<mutex> lock (mLock);
+		if (!Wait (lock, Side::Emulator, timeout, false))
+			return false;
+
+		mGameTurn = true;
+		mCondition.notify_all ();
+		return true;
+	}
+
+	/// Wait for the end of the started game frame. Returns false on timeout. (Emulator thread)
+	bool WaitGameFrame (chrono::milliseconds timeout) {
+		unique_lock<mutex> lock (mLock);
+		return Wait (lock, Side::Emulator, timeout, false);
+	}
+
+	/// Wait for the start of a game frame. Returns false on timeout. (Game thread)
+	bool EnterGameFrame (chrono::milliseconds timeout) {
+		unique_lock<mutex> lock (mLock);
+		return Wait (lock, Side::Game, timeout, true);
+	}
+
+	/// End the entered game frame and give the turn back to the emulator. (Game thread)
+	void LeaveGameFrame () {
+		lock_guard<mutex> lock (mLock);
+		mGameTurn = false;
+		mCondition.notify_all ();
+	}
+
+	/// Give the turn back to the emulator and wake up the waiting sides (when the canvas is reinitialized). The counters are kept.
+	void Reset () {
+		lock_guard<mutex> lock (mLock);
+		mGameTurn = false;
+		mCondition.notify_all ();
+	}
+
+	const WaitStats& Stats (Side side) const {
+		return mStats[(int) side];
+	}
+
+//Helper methods
+private:
+	bool Wait (unique_lock<mutex>& lock, Side side, chrono::milliseconds timeout, bool gameTurn) {
+		if (mGameTurn == gameTurn) //No need to wait (not counted)
+			return true;
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+		bool result = mCondition.wait_for (lock, timeout, [this, gameTurn] () { return mGameTurn == gameTurn; });
+		uint64_t waitNanos = (uint64_t) chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now () - start).count ();
+
+		//Only the owner thread of the side writes its counters
+		WaitStats& stats = mStats[(int) side];
+		stats.waitCount.fetch_add (1, memory_order_relaxed);
+		stats.waitNanos.fetch_add (waitNanos, memory_order_relaxed);
+		if (waitNanos > stats.maxWaitNanos.load (memory_order_relaxed))
+			stats.maxWaitNanos.store (waitNanos, memory_order_relaxed);
+		if (!result)
+			stats.timeoutCount.fetch_add (1, memory_order_relaxed);
+
+		return result;
+	}
+};
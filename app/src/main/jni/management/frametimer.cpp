@@ -0,0 +1,127 @@
+#include "../pch.h"
+#include "frametimer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// LatencyHistogram implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void LatencyHistogram::Record (uint64_t nanos) {
+	uint64_t micros = nanos / 1000;
+	mBuckets[BucketIndex (micros > 0xFFFFFFFFull ? 0xFFFFFFFFu : (uint32_t) micros)].fetch_add (1, memory_order_relaxed);
+
+	mCount.fetch_add (1, memory_order_relaxed);
+	mTotalNanos.fetch_add (nanos, memory_order_relaxed);
+
+	uint64_t maxNanos = mMaxNanos.load (memory_order_relaxed);
+	while (nanos > maxNanos && !mMaxNanos.compare_exchange_weak (maxNanos, nanos, memory_order_relaxed))
+		;
+}
+
+void LatencyHistogram::Reset () {
+	for (auto& bucket : mBuckets)
+		bucket.store (0, memory_order_relaxed);
+
+	mCount.store (0, memory_order_relaxed);
+	mTotalNanos.store (0, memory_order_relaxed);
+	mMaxNanos.store (0, memory_order_relaxed);
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize () const {
+	uint32_t buckets[BucketCount];
+	uint64_t count = 0;
+	for (uint32_t i = 0; i < BucketCount; ++i) {
+		buckets[i] = mBuckets[i].load (memory_order_relaxed);
+		count += buckets[i];
+	}
+
+	Summary summary;
+	summary.count = count;
+	summary.meanMicros = count > 0 ? (double) mTotalNanos.load (memory_order_relaxed) / 1000.0 / (double) mCount.load (memory_order_relaxed) : 0;
+	summary.maxMicros = (double) mMaxNanos.load (memory_order_relaxed) / 1000.0;
+
+	//Walk the buckets once for all of the percentiles (nearest rank)
+	const double percentiles[3] = { 0.50, 0.95, 0.99 };
+	double* results[3] = { &summary.p50Micros, &summary.p95Micros, &summary.p99Micros };
+
+	uint64_t seen = 0;
+	uint32_t bucket = 0;
+	for (int i = 0; i < 3; ++i) {
+		uint64_t rank = (uint64_t) ceil (percentiles[i] * (double) count);
+		while (bucket < BucketCount && (seen + buckets[bucket] < rank || buckets[bucket] == 0)) {
+			seen += buckets[bucket];
+			++bucket;
+		}
+
+		*results[i] = count > 0 && bucket < BucketCount ? min (BucketValue (bucket), summary.maxMicros) : 0;
+	}
+
+	return summary;
+}
+
+uint32_t LatencyHistogram::BucketIndex (uint32_t micros) {
+	if (micros < LinearBucketCount)
+		return micros;
+
+	uint32_t exponent = 31 - (uint32_t) __builtin_clz (micros); //5..31
+	uint32_t subBucket = (micros >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+	return LinearBucketCount + (exponent - 5) * SubBucketCount + subBucket;
+}
+
+double LatencyHistogram::BucketValue (uint32_t index) {
+	if (index < LinearBucketCount)
+		return (double) index;
+
+	//The middle of the bucket
+	uint32_t exponent = (index - LinearBucketCount) / SubBucketCount + 5;
+	uint32_t subBucket = (index - LinearBucketCount) % SubBucketCount;
+	double lower = (double) ((uint64_t) (SubBucketCount + subBucket) << (exponent - SubBucketBits));
+	double width = (double) (1ull << (exponent - SubBucketBits));
+	return lower + width / 2.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameTimer implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void FrameTimer::Reset () {
+	for (auto& histogram : mHistograms)
+		histogram.Reset ();
+}
+
+const char* FrameTimer::PhaseName (FramePhase phase) {
+	switch (phase) {
+		case FramePhase::HandshakeWait:
+			return "handshakeWait";
+		case FramePhase::Update:
+			return "update";
+		case FramePhase::PixelConversion:
+			return "pixelConversion";
+		case FramePhase::TextureUpload:
+			return "textureUpload";
+		case FramePhase::PCMDrain:
+			return "pcmDrain";
+		case FramePhase::Render:
+			return "render";
+		default:
+			return "unknown";
+	}
+}
+
+string FrameTimer::ToJSON () const {
+	stringstream ss;
+	ss << fixed << setprecision (1) << "{";
+
+	for (int i = 0; i < (int) FramePhase::Count; ++i) {
+		FramePhase phase = (FramePhase) i;
+		LatencyHistogram::Summary summary = Summarize (phase);
+
+		ss << (i > 0 ? "," : "") << "\"" << PhaseName (phase) << "\":{" <<
+			"\"count\":" << summary.count <<
+			",\"mean\":" << summary.meanMicros <<
+			",\"p50\":" << summary.p50Micros <<
+			",\"p95\":" << summary.p95Micros <<
+			",\"p99\":" << summary.p99Micros <<
+			",\"max\":" << summary.maxMicros << "}";
+	}
+
+	ss << "}";
+	return ss.str ();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+/// The measured phases of a frame. (Update contains the conversion, upload and PCM phases.)
+enum class FramePhase {
+	HandshakeWait = 0, ///< Waiting for the emulator frame (frame barrier).
+	Update, ///< Game::Update
+	PixelConversion, ///< Conversion (or copy) of the C64 screen pixels.
+	TextureUpload, ///< Upload of the C64 screen texture.
+	PCMDrain, ///< Moving the emulator sound to the audio output.
+	Render, ///< Game::Render
+
+	Count
+};
+
+///
+/// Lock-free latency histogram.
+///
+/// Log-linear buckets over microseconds: exact below 32 us, then 16 buckets in each power of two (max. 6% error).
+/// Any thread can record, the percentiles are read from a (not atomic as a whole) snapshot of the buckets.
+class LatencyHistogram {
+//Definitions
+public:
+	enum : uint32_t {
+		LinearBucketCount = 32,
+		SubBucketBits = 4,
+		SubBucketCount = 1 << SubBucketBits,
+		BucketCount = LinearBucketCount + (32 - 5) * SubBucketCount
+	};
+
+	struct Summary {
+		uint64_t count;
+		double meanMicros;
+		double p50Micros;
+		double p95Micros;
+		double p99Micros;
+		double maxMicros;
+	};
+
+//Data
+private:
+	atomic<uint32_t> mBuckets[BucketCount];
+	atomic<uint64_t> mCount;
+	atomic<uint64_t> mTotalNanos;
+	atomic<uint64_t> mMaxNanos;
+
+//Construction
+public:
+	LatencyHistogram () {
+		Reset ();
+	}
+
+//Interface
+public:
+	void Record (uint64_t nanos);
+	void Reset ();
+	Summary Summarize () const;
+
+//Helper methods
+private:
+	static uint32_t BucketIndex (uint32_t micros);
+	static double BucketValue (uint32_t index);
+};
+
+///
+/// The per-phase frame time histograms of the game.
+class FrameTimer {
+//Data
+private:
+	LatencyHistogram mHistograms[(int) FramePhase::Count];
+
+//Construction
+private:
+	FrameTimer () {}
+
+public:
+	static FrameTimer& Get () {
+		static FrameTimer inst;
+		return inst;
+	}
+
+//Interface
+public:
+	void Record (FramePhase phase, uint64_t nanos) {
+		mHistograms[(int) phase].Record (nanos);
+	}
+
+	LatencyHistogram::Summary Summarize (FramePhase phase) const {
+		return mHistograms[(int) phase].Summarize ();
+	}
+
+	void Reset ();
+
+	static const char* PhaseName (FramePhase phase);
+
+	/// The summary of all phases as a JSON object: {"update":{"count":..,"mean":..,"p50":..,"p95":..,"p99":..,"max":..},...} (times in microseconds)
+	string ToJSON () const;
+};
+
+///
+/// Records the time of its scope into the histogram of a frame phase.
+class FramePhaseTimer {
+//Data
+private:
+	FramePhase mPhase;
+	chrono::steady_clock::time_point mStart;
+
+//Construction
+public:
+	FramePhaseTimer (FramePhase phase) : mPhase (phase), mStart (chrono::steady_clock::now ()) {}
+
+	~FramePhaseTimer () {
+		uint64_t nanos = (uint64_t) chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now () - mStart).count ();
+		FrameTimer::Get ().Record (mPhase, nanos);
+	}
+};
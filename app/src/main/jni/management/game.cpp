@@ -1,5 +1,6 @@
 #include "../pch.h"
 #include "game.h"
+#include "glstate.h"
 
 Game* Game::mGame = nullptr;
 
@@ -63,6 +64,8 @@ void Game::Update (float elapsedTime) {
 void Game::Render () {
 	if (mCurrentScene != nullptr)
 		mCurrentScene->Render ();
+
+	GLState::Get ().EndFrame ();
 }
 
 void Game::SetCurrentScene (shared_ptr < Scene > scene) {
@@ -96,7 +99,7 @@ void Game::InitProjection (int screenWidth, int screenHeight) {
 	mScreenWidth = screenWidth;
 	mScreenHeight = screenHeight;
 
-	glMatrixMode (GL_PROJECTION);
+	GLState::Get ().MatrixMode (GL_PROJECTION);
 	glLoadIdentity ();
 
 	float min = (float) std::min (screenWidth, screenHeight);
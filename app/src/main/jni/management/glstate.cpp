@@ -0,0 +1,249 @@
+#include "../pch.h"
+#include "glstate.h"
+
+//The process wide switch of the filtering
+static atomic<bool> s_gl_state_filter_enabled (true);
+
+GLState::GLState () {
+	Invalidate ();
+	ResetStats ();
+}
+
+void GLState::Invalidate () {
+	mTexture = Unknown;
+	mAlphaPlane = Unknown;
+	mAlphaPlanes.clear (); //The textures of the previous context
+	mArrayBuffer = Unknown;
+	mElementBuffer = Unknown;
+	for (uint32_t& value : mSwitches)
+		value = Unknown;
+	mBlendSrc = Unknown;
+	mBlendDst = Unknown;
+	mMatrixMode = Unknown;
+}
+
+void GLState::BindTexture (GLuint texture) {
+	if (Change (mTexture, texture))
+		glBindTexture (GL_TEXTURE_2D, texture);
+
+	if (!mAlphaPlanes.empty () || mAlphaPlane != 0) {
+		auto it = mAlphaPlanes.find (texture);
+		BindAlphaPlane (it == mAlphaPlanes.end () ? 0 : it->second);
+	}
+}
+
+void GLState::BindBuffer (GLenum target, GLuint buffer) {
+	assert (target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER);
+
+	if (Change (target == GL_ARRAY_BUFFER ? mArrayBuffer : mElementBuffer, buffer))
+		glBindBuffer (target, buffer);
+}
+
+void GLState::SetAlphaPlane (GLuint texture, GLuint alphaTexture) {
+	if (alphaTexture != 0)
+		mAlphaPlanes[texture] = alphaTexture;
+	else
+		mAlphaPlanes.erase (texture);
+
+	if (texture == mTexture) //Bound with the plane of the next BindTexture
+		mTexture = Unknown;
+}
+
+void GLState::TexCoordPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+	glTexCoordPointer (size, type, stride, pointer);
+
+	//The second unit draws from the same coordinates (while there are planes, it may be switched on by any bind)
+	if (!mAlphaPlanes.empty ()) {
+		glClientActiveTexture (GL_TEXTURE1);
+		glTexCoordPointer (size, type, stride, pointer);
+		glClientActiveTexture (GL_TEXTURE0);
+	}
+}
+
+void GLState::Enable (GLenum cap) {
+	Switch item = SwitchOfCap (cap);
+	if (item == SwitchCount ? !IsRedundant (false) : Change (mSwitches[item], 1))
+		glEnable (cap);
+}
+
+void GLState::Disable (GLenum cap) {
+	Switch item = SwitchOfCap (cap);
+	if (item == SwitchCount ? !IsRedundant (false) : Change (mSwitches[item], 0))
+		glDisable (cap);
+}
+
+void GLState::EnableClientState (GLenum array) {
+	Switch item = SwitchOfArray (array);
+	if (item == SwitchCount ? !IsRedundant (false) : Change (mSwitches[item], 1))
+		glEnableClientState (array);
+}
+
+void GLState::DisableClientState (GLenum array) {
+	Switch item = SwitchOfArray (array);
+	if (item == SwitchCount ? !IsRedundant (false) : Change (mSwitches[item], 0))
+		glDisableClientState (array);
+}
+
+void GLState::BlendFunc (GLenum src, GLenum dst) {
+	if (IsRedundant (mBlendSrc == src && mBlendDst == dst))
+		return;
+
+	mBlendSrc = src;
+	mBlendDst = dst;
+	glBlendFunc (src, dst);
+}
+
+void GLState::MatrixMode (GLenum mode) {
+	if (Change (mMatrixMode, mode))
+		glMatrixMode (mode);
+}
+
+void GLState::DeleteTextures (GLsizei n, const GLuint* textures) {
+	for (GLsizei i = 0; i < n; ++i) {
+		if (textures[i] == mTexture)
+			mTexture = 0;
+
+		auto it = mAlphaPlanes.find (textures[i]);
+		if (it != mAlphaPlanes.end ()) {
+			if (it->second == mAlphaPlane) //The unit stays on with texture 0
+				mAlphaPlane = Unknown;
+
+			glDeleteTextures (1, &it->second);
+			mAlphaPlanes.erase (it);
+		}
+	}
+
+	glDeleteTextures (n, textures);
+}
+
+void GLState::DeleteBuffers (GLsizei n, const GLuint* buffers) {
+	for (GLsizei i = 0; i < n; ++i) {
+		if (buffers[i] == mArrayBuffer)
+			mArrayBuffer = 0;
+		if (buffers[i] == mElementBuffer)
+			mElementBuffer = 0;
+	}
+
+	glDeleteBuffers (n, buffers);
+}
+
+void GLState::EndFrame () {
+	mFrameCount.fetch_add (1, memory_order_relaxed);
+	mTotalIssuedCount.fetch_add (mIssuedCount, memory_order_relaxed);
+	mTotalFilteredCount.fetch_add (mFilteredCount, memory_order_relaxed);
+	mLastIssuedCount.store (mIssuedCount, memory_order_relaxed);
+	mLastFilteredCount.store (mFilteredCount, memory_order_relaxed);
+
+	mIssuedCount = 0;
+	mFilteredCount = 0;
+}
+
+void GLState::ResetStats () {
+	mIssuedCount = 0;
+	mFilteredCount = 0;
+
+	mFrameCount.store (0, memory_order_relaxed);
+	mTotalIssuedCount.store (0, memory_order_relaxed);
+	mTotalFilteredCount.store (0, memory_order_relaxed);
+	mLastIssuedCount.store (0, memory_order_relaxed);
+	mLastFilteredCount.store (0, memory_order_relaxed);
+}
+
+GLState::Stats GLState::GetStats () const {
+	Stats stats;
+	stats.frameCount = mFrameCount.load (memory_order_relaxed);
+	stats.issuedCount = mTotalIssuedCount.load (memory_order_relaxed);
+	stats.filteredCount = mTotalFilteredCount.load (memory_order_relaxed);
+	stats.lastIssuedCount = mLastIssuedCount.load (memory_order_relaxed);
+	stats.lastFilteredCount = mLastFilteredCount.load (memory_order_relaxed);
+	return stats;
+}
+
+string GLState::ToJSON () const {
+	Stats stats = GetStats ();
+	double frames = stats.frameCount > 0 ? (double) stats.frameCount : 1.0;
+
+	stringstream ss;
+	ss << fixed << setprecision (1) << "{" <<
+		"\"frames\":" << stats.frameCount <<
+		",\"issued\":" << stats.issuedCount <<
+		",\"filtered\":" << stats.filteredCount <<
+		",\"issuedPerFrame\":" << (double) stats.issuedCount / frames <<
+		",\"filteredPerFrame\":" << (double) stats.filteredCount / frames <<
+		",\"lastIssued\":" << stats.lastIssuedCount <<
+		",\"lastFiltered\":" << stats.lastFilteredCount << "}";
+	return ss.str ();
+}
+
+bool GLState::IsEnabled () {
+	return s_gl_state_filter_enabled.load (memory_order_relaxed);
+}
+
+void GLState::SetEnabled (bool enabled) {
+	s_gl_state_filter_enabled.store (enabled, memory_order_relaxed);
+}
+
+GLState::Switch GLState::SwitchOfCap (GLenum cap) {
+	switch (cap) {
+	case GL_BLEND:
+		return Blend;
+	case GL_TEXTURE_2D:
+		return Texture2D;
+	default:
+		return SwitchCount;
+	}
+}
+
+GLState::Switch GLState::SwitchOfArray (GLenum array) {
+	switch (array) {
+	case GL_VERTEX_ARRAY:
+		return VertexArray;
+	case GL_TEXTURE_COORD_ARRAY:
+		return TexCoordArray;
+	case GL_COLOR_ARRAY:
+		return ColorArray;
+	default:
+		return SwitchCount;
+	}
+}
+
+void GLState::BindAlphaPlane (GLuint plane) {
+	uint32_t previous = mAlphaPlane;
+	if (!Change (mAlphaPlane, plane))
+		return;
+
+	glActiveTexture (GL_TEXTURE1);
+	glClientActiveTexture (GL_TEXTURE1);
+	if (plane != 0) {
+		glBindTexture (GL_TEXTURE_2D, plane);
+		if (previous == 0 || previous == Unknown) {
+			glEnable (GL_TEXTURE_2D);
+			glEnableClientState (GL_TEXTURE_COORD_ARRAY);
+		}
+	} else {
+		glDisable (GL_TEXTURE_2D);
+		glDisableClientState (GL_TEXTURE_COORD_ARRAY);
+	}
+
+	glActiveTexture (GL_TEXTURE0);
+	glClientActiveTexture (GL_TEXTURE0);
+}
+
+bool GLState::IsRedundant (bool unchanged) {
+	//The state is tracked even without filtering, so it can be switched on at any time
+	if (unchanged && IsEnabled ()) {
+		++mFilteredCount;
+		return true;
+	}
+
+	++mIssuedCount;
+	return false;
+}
+
+bool GLState::Change (uint32_t& current, uint32_t value) {
+	if (IsRedundant (current == value))
+		return false;
+
+	current = value;
+	return true;
+}
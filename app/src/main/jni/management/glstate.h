@@ -0,0 +1,126 @@
+#pragma once
+
+///
+/// Tracks the fixed function GL state set by the game and filters the calls which would not change it.
+///
+/// The tracked state: the bound texture and buffers, the enabled capabilities (blend, texture), the blend function, the
+/// client arrays and the matrix mode. All of the game code changes this state through the tracker (on the GL thread), so
+/// the tracked values match the context. Until the first call the state is unknown and the calls are issued always, the
+/// same after Invalidate (new context). The issued and filtered calls are counted for each frame.
+///
+/// The textures may have an alpha plane (the ETC1 textures, which have no alpha): a GL_ALPHA texture drawn on the second
+/// texture unit with the same texture coordinates. The default GL_MODULATE of the unit keeps the color of the first one
+/// and multiplies its alpha by the plane. BindTexture binds the plane of the texture (or switches the unit off), so the
+/// drawing code does not know about the planes.
+class GLState {
+//Definitions
+public:
+	/// The counted calls (since ResetStats).
+	struct Stats {
+		uint64_t frameCount;
+		uint64_t issuedCount; ///< The calls reached the driver.
+		uint64_t filteredCount; ///< The redundant calls dropped.
+		uint32_t lastIssuedCount; ///< The calls of the last frame.
+		uint32_t lastFilteredCount;
+	};
+
+private:
+	enum : uint32_t {
+		Unknown = 0xFFFFFFFF ///< The value of a state not known by the tracker.
+	};
+
+	/// The tracked capabilities and client arrays.
+	enum Switch : uint32_t {
+		Blend = 0,
+		Texture2D,
+		VertexArray,
+		TexCoordArray,
+		ColorArray,
+
+		SwitchCount
+	};
+
+//Data
+private:
+	GLuint mTexture;
+	GLuint mAlphaPlane; ///< The texture of the second unit (0: the unit is off).
+	map<GLuint, GLuint> mAlphaPlanes; ///< The alpha planes by the textures.
+	GLuint mArrayBuffer;
+	GLuint mElementBuffer;
+	uint32_t mSwitches[SwitchCount]; ///< 0: disabled, 1: enabled, Unknown.
+	GLenum mBlendSrc;
+	GLenum mBlendDst;
+	GLenum mMatrixMode;
+
+	uint32_t mIssuedCount; ///< The calls of the current frame.
+	uint32_t mFilteredCount;
+
+	atomic<uint64_t> mFrameCount;
+	atomic<uint64_t> mTotalIssuedCount;
+	atomic<uint64_t> mTotalFilteredCount;
+	atomic<uint32_t> mLastIssuedCount;
+	atomic<uint32_t> mLastFilteredCount;
+
+//Construction
+private:
+	GLState ();
+
+public:
+	static GLState& Get () {
+		static GLState inst;
+		return inst;
+	}
+
+//Interface
+public:
+	/// Forget the tracked state (a new GL context, or GL calls made without the tracker).
+	void Invalidate ();
+
+	void BindTexture (GLuint texture);
+	void BindBuffer (GLenum target, GLuint buffer);
+
+	/// Set the alpha plane of a texture (0: no plane), BindTexture binds it together with the texture.
+	void SetAlphaPlane (GLuint texture, GLuint alphaTexture);
+
+	/// Set the texture coordinates of the texture and of its alpha plane (the coordinates of all of the draws).
+	void TexCoordPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+
+	void Enable (GLenum cap);
+	void Disable (GLenum cap);
+	void EnableClientState (GLenum array);
+	void DisableClientState (GLenum array);
+	void BlendFunc (GLenum src, GLenum dst);
+	void MatrixMode (GLenum mode);
+
+	/// Delete the objects and forget them, when they are bound (GL binds 0 instead of them). The alpha planes of the
+	/// textures are deleted with them.
+	void DeleteTextures (GLsizei n, const GLuint* textures);
+	void DeleteBuffers (GLsizei n, const GLuint* buffers);
+
+	/// Close the counters of the frame (call it after the frame is rendered).
+	void EndFrame ();
+
+	void ResetStats ();
+	Stats GetStats () const;
+
+	/// The statistics as a JSON object: {"frames":..,"issued":..,"filtered":..,"issuedPerFrame":..,"filteredPerFrame":..,"lastIssued":..,"lastFiltered":..}
+	string ToJSON () const;
+
+	/// The filtering of the redundant calls is on (process wide switch to measure the renderer with and without it).
+	static bool IsEnabled ();
+	static void SetEnabled (bool enabled);
+
+//Helper methods
+private:
+	static Switch SwitchOfCap (GLenum cap);
+	static Switch SwitchOfArray (GLenum array);
+
+	/// Bind the texture of the second unit, switching the unit on or off.
+	void BindAlphaPlane (GLuint plane);
+
+	/// Counts the call: true, when it is filtered (it would not change the state), false when it has to be issued.
+	bool IsRedundant (bool unchanged);
+
+	/// Sets the tracked value: true, when the call has to be issued, false when it is filtered.
+	bool Change (uint32_t& current, uint32_t value);
+};
@@ -0,0 +1,142 @@
+#include "../pch.h"
+#include "pcmautotuner.h"
+#include "IContentManager.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+//The learned configuration in the data directory: "nativeFrames sampleRate frames count"
+static const char* s_tuning_file = "pcmtuning.cfg";
+
+constexpr double PCMAutoTuner::WindowSeconds;
+constexpr double PCMAutoTuner::StableSeconds;
+const uint32_t PCMAutoTuner::UnderrunThreshold;
+const uint32_t PCMAutoTuner::MinMaxCount;
+
+PCMAutoTuner::PCMAutoTuner () :
+	mSampleRate (0),
+	mNativeFrames (0),
+	mFallbackCount (0),
+	mStep (0),
+	mFailedStep (-1),
+	mWindowStart (-1),
+	mWindowUnderrunBase (0),
+	mStableStart (0),
+	mWarmUp (true) {
+}
+
+void PCMAutoTuner::Init (uint32_t sampleRate, uint32_t nativeFrames, uint32_t deviceBufferCount) {
+	mSampleRate = sampleRate;
+	mNativeFrames = nativeFrames;
+	mFallbackCount = deviceBufferCount;
+
+	mLadder.clear ();
+	mStep = 0;
+	mFailedStep = -1;
+	if (nativeFrames == 0) //Unknown native buffer size: keep the configuration of the device
+		return;
+
+	//Each step has more latency than the previous one
+	uint32_t maxCount = max (deviceBufferCount, MinMaxCount);
+	uint32_t lastLatency = 0;
+	for (uint32_t multiplier = 1; multiplier <= 4; multiplier *= 2) {
+		for (uint32_t count = 2; count <= maxCount; ++count) {
+			uint32_t latency = nativeFrames * multiplier * count;
+			if (latency > lastLatency) {
+				mLadder.push_back ({ nativeFrames * multiplier, count });
+				lastLatency = latency;
+			}
+		}
+	}
+}
+
+void PCMAutoTuner::Load (IContentManager& contentManager) {
+	if (!IsEnabled ())
+		return;
+
+	vector<uint8_t> content = contentManager.ReadFile (s_tuning_file);
+	istringstream ss (string (content.begin (), content.end ()));
+
+	uint32_t nativeFrames = 0;
+	uint32_t sampleRate = 0;
+	Config config = { 0, 0 };
+	if (!(ss >> nativeFrames >> sampleRate >> config.frames >> config.count))
+		return;
+
+	if (nativeFrames != mNativeFrames || sampleRate != mSampleRate) //Learned with another audio configuration
+		return;
+
+	for (size_t i = 0; i < mLadder.size (); ++i) {
+		if (mLadder[i].frames == config.frames && mLadder[i].count == config.count) {
+			mStep = (int) i;
+			LOGI ("PCMAutoTuner - learned buffer configuration: %u frames * %u", config.frames, config.count);
+			break;
+		}
+	}
+}
+
+void PCMAutoTuner::Start (double time) {
+	mWindowStart = -1;
+	mStableStart = time;
+	mWarmUp = true;
+}
+
+bool PCMAutoTuner::Update (IContentManager& contentManager, bool active, double time) {
+	if (!IsEnabled ())
+		return false;
+
+	//The windows are measured only while the sound is played
+	PCMStats stats = contentManager.GetPCMStats ();
+	if (!active || mWindowStart < 0) {
+		mWindowStart = active ? time : -1;
+		mWindowUnderrunBase = stats.underrunCount;
+		if (!active)
+			mStableStart = time;
+		return false;
+	}
+
+	if (time - mWindowStart < WindowSeconds)
+		return false;
+
+	uint32_t underruns = stats.underrunCount - mWindowUnderrunBase;
+	mWindowStart = time;
+	mWindowUnderrunBase = stats.underrunCount;
+
+	if (mWarmUp) { //The priming of the device and the start of the source are not measured
+		mWarmUp = false;
+		mStableStart = time;
+		return false;
+	}
+
+	if (underruns > 0)
+		mStableStart = time;
+
+	//Step up, when the device cannot keep up
+	if (underruns > UnderrunThreshold && mStep + 1 < (int) mLadder.size ()) {
+		mFailedStep = max (mFailedStep, mStep);
+		++mStep;
+
+		LOGI ("PCMAutoTuner - %u underruns in %.1f s, buffers: %u frames * %u", underruns, WindowSeconds, BufferFrames (), BufferCount ());
+		Save (contentManager);
+		return true;
+	}
+
+	//Step down after a stable period (but not to a failed configuration)
+	if (time - mStableStart >= StableSeconds && mStep > 0 && mStep - 1 > mFailedStep) {
+		--mStep;
+
+		LOGI ("PCMAutoTuner - stable for %.0f s, buffers: %u frames * %u", StableSeconds, BufferFrames (), BufferCount ());
+		Save (contentManager);
+		return true;
+	}
+
+	return false;
+}
+
+void PCMAutoTuner::Save (IContentManager& contentManager) {
+	stringstream ss;
+	ss << mNativeFrames << " " << mSampleRate << " " << BufferFrames () << " " << BufferCount () << "\n";
+
+	string content = ss.str ();
+	contentManager.WriteFile (s_tuning_file, vector<uint8_t> (content.begin (), content.end ()), false);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+class IContentManager;
+
+///
+/// Learns the lowest latency device buffer configuration of the PCM output, which plays without underruns.
+///
+/// The configurations form a ladder ordered by latency (frames * count): the native buffer size with 2..MaxCount
+/// buffers, then two and four times the native size. The tuner starts at the bottom, steps up when the underruns
+/// of a measuring window exceed the threshold, and steps down after a stable period (never back to a configuration
+/// which underran in the session). The learned configuration is saved to the data directory of the device, and
+/// it is the starting point of the next session (while the native buffer size and sampling rate are the same).
+class PCMAutoTuner {
+//Definitions
+public:
+	static constexpr double WindowSeconds = 2.0; ///< The length of the underrun measuring window.
+	static constexpr double StableSeconds = 30.0; ///< The time without underruns before stepping down.
+	static const uint32_t UnderrunThreshold = 2; ///< Underruns allowed in a window (single underruns are not worth the latency).
+	static const uint32_t MinMaxCount = 8; ///< The buffer count limit of the ladder, when the device suggests less.
+
+private:
+	struct Config {
+		uint32_t frames;
+		uint32_t count;
+	};
+
+//Data
+private:
+	uint32_t mSampleRate; ///< The native sampling rate of the device.
+	uint32_t mNativeFrames; ///< The native buffer size of the device (0: unknown, the tuner is disabled).
+	uint32_t mFallbackCount; ///< The buffer count suggested by the device (used, when the tuner is disabled).
+
+	vector<Config> mLadder;
+	int mStep;
+	int mFailedStep; ///< The highest step which underran in this session (-1: none).
+
+	double mWindowStart; ///< < 0: the window starts at the next update.
+	uint32_t mWindowUnderrunBase;
+	double mStableStart;
+	bool mWarmUp; ///< The first window after opening (the priming of the device is not measured).
+
+//Construction
+public:
+	PCMAutoTuner ();
+
+//Interface
+public:
+	/// Build the ladder from the native parameters of the device (the buffer count is the worst case suggestion of the device).
+	void Init (uint32_t sampleRate, uint32_t nativeFrames, uint32_t deviceBufferCount);
+
+	/// Continue from the configuration learned in an earlier session.
+	void Load (IContentManager& contentManager);
+
+	bool IsEnabled () const {
+		return !mLadder.empty ();
+	}
+
+	uint32_t BufferFrames () const {
+		return IsEnabled () ? mLadder[mStep].frames : mNativeFrames;
+	}
+
+	uint32_t BufferCount () const {
+		return IsEnabled () ? mLadder[mStep].count : mFallbackCount;
+	}
+
+	/// The PCM output is opened with the current configuration.
+	void Start (double time);
+
+	/// Evaluate the underruns of the open output (active: the sound is played, not muted).
+	/// Returns true, when the configuration changed, so the output has to be reopened.
+	bool Update (IContentManager& contentManager, bool active, double time);
+
+//Helper methods
+private:
+	void Save (IContentManager& contentManager);
+};
@@ -0,0 +1,389 @@
+#include "../pch.h"
+#include "pcmmixer.h"
+#ifdef __ANDROID__
+#include <android/cpu-features.h>
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+PCMMixer::PCMMixer () :
+	mMix (&PCMMixer::Mix_Scalar),
+	mName ("scalar"),
+	mNumChannels (0),
+	mSampleRate (0),
+	mNextID (1),
+	mCommandWriteIndex (0),
+	mCommandReadIndex (0),
+	mMixCount (0) {
+	for (Voice& voice : mVoices)
+		voice = { nullptr, 0, 0, false };
+
+#ifdef __ANDROID__
+	AndroidCpuFamily family = android_getCpuFamily ();
+	uint64_t features = android_getCpuFeatures ();
+	bool hasNEON = family == ANDROID_CPU_FAMILY_ARM64 || (family == ANDROID_CPU_FAMILY_ARM && (features & ANDROID_CPU_ARM_FEATURE_NEON));
+	bool hasSSSE3 = (family == ANDROID_CPU_FAMILY_X86 || family == ANDROID_CPU_FAMILY_X86_64) && (features & ANDROID_CPU_X86_FEATURE_SSSE3);
+#else //Host build
+#	if defined (__aarch64__) || defined (__ARM_NEON)
+	bool hasNEON = true;
+#	else
+	bool hasNEON = false;
+#	endif
+#	ifdef PCM_MIXER_SSSE3
+	bool hasSSSE3 = __builtin_cpu_supports ("ssse3");
+#	else
+	bool hasSSSE3 = false;
+#	endif
+#endif //__ANDROID__
+
+#ifdef PCM_MIXER_NEON
+	if (hasNEON) {
+		mMix = &PCMMixer::Mix_NEON;
+		mName = "neon";
+	}
+#endif //PCM_MIXER_NEON
+
+#ifdef PCM_MIXER_SSSE3
+	if (hasSSSE3) {
+		mMix = &PCMMixer::Mix_SSSE3;
+		mName = "ssse3";
+	}
+#endif //PCM_MIXER_SSSE3
+
+	(void) hasNEON; //Only one of them is used on each architecture
+	(void) hasSSSE3;
+
+#ifdef _DEBUG
+	SelfTest ();
+#endif //_DEBUG
+}
+
+int PCMMixer::Add (uint32_t numChannels, uint32_t sampleRate, vector<int16_t>&& samples) {
+	if ((numChannels != 1 && numChannels != 2) || sampleRate == 0 || samples.size () < numChannels)
+		return 0;
+
+	unique_ptr<Sound> sound (new Sound ());
+	sound->numChannels = numChannels;
+	sound->sampleRate = sampleRate;
+	sound->source = move (samples);
+	sound->frameCount = 0;
+	sound->playing.store (0, memory_order_relaxed);
+	if (mNumChannels > 0) //Else converted by SetFormat
+		Convert (*sound);
+
+	int soundID = mNextID++;
+	mSounds[soundID] = move (sound);
+	return soundID;
+}
+
+int PCMMixer::AddWAV (const uint8_t* data, size_t size) {
+	if (data == nullptr || size < 12 || memcmp (data, "RIFF", 4) != 0 || memcmp (data + 8, "WAVE", 4) != 0)
+		return 0;
+
+	//Walk the chunks: the format has to precede the data
+	uint32_t numChannels = 0;
+	uint32_t sampleRate = 0;
+	uint32_t bitsPerSample = 0;
+	size_t pos = 12;
+	while (pos + 8 <= size) {
+		const uint8_t* chunk = data + pos;
+		uint32_t chunkSize = (uint32_t) chunk[4] | (uint32_t) chunk[5] << 8 | (uint32_t) chunk[6] << 16 | (uint32_t) chunk[7] << 24;
+		const uint8_t* body = chunk + 8;
+		size_t bodySize = min ((size_t) chunkSize, size - pos - 8);
+
+		if (memcmp (chunk, "fmt ", 4) == 0 && bodySize >= 16) {
+			uint32_t formatTag = (uint32_t) body[0] | (uint32_t) body[1] << 8;
+			if (formatTag != 1) //Not PCM
+				return 0;
+
+			numChannels = (uint32_t) body[2] | (uint32_t) body[3] << 8;
+			sampleRate = (uint32_t) body[4] | (uint32_t) body[5] << 8 | (uint32_t) body[6] << 16 | (uint32_t) body[7] << 24;
+			bitsPerSample = (uint32_t) body[14] | (uint32_t) body[15] << 8;
+		} else if (memcmp (chunk, "data", 4) == 0) {
+			vector<int16_t> samples;
+			if (bitsPerSample == 16) {
+				samples.resize (bodySize / 2);
+				for (size_t i = 0; i < samples.size (); ++i)
+					samples[i] = (int16_t) ((uint16_t) body[i * 2] | (uint16_t) body[i * 2 + 1] << 8);
+			} else if (bitsPerSample == 8) { //Unsigned
+				samples.resize (bodySize);
+				for (size_t i = 0; i < samples.size (); ++i)
+					samples[i] = (int16_t) (((int) body[i] - 128) << 8);
+			} else {
+				return 0;
+			}
+
+			if (numChannels > 0)
+				samples.resize (samples.size () / numChannels * numChannels);
+			return Add (numChannels, sampleRate, move (samples));
+		}
+
+		pos += 8 + (size_t) chunkSize + (chunkSize & 1); //The chunks are word aligned
+	}
+
+	return 0;
+}
+
+void PCMMixer::Remove (int soundID) {
+	auto it = mSounds.find (soundID);
+	if (it == mSounds.end ())
+		return;
+
+	//Free it after the stop is mixed (a mix may be running, and the next one applies the stop)
+	Retired retired = { 0, false, move (it->second) };
+	mRetired.push_back (move (retired));
+	mSounds.erase (it);
+
+	FreeRetired (false);
+}
+
+void PCMMixer::Play (int soundID, float volume, bool looped) {
+	auto it = mSounds.find (soundID);
+	if (it == mSounds.end ())
+		return;
+
+	//Convert UI volume to linear factor (cube)
+	float vol = max (0.0f, min (1.0f, volume));
+	vol = vol * vol * vol;
+
+	Sound* sound = it->second.get ();
+	sound->playing.fetch_add (1, memory_order_relaxed);
+
+	Command command = { Command::Play, looped, (int16_t) lroundf (vol * 32767.0f), sound };
+	if (!PushCommand (command))
+		sound->playing.fetch_sub (1, memory_order_relaxed);
+}
+
+void PCMMixer::Stop (int soundID) {
+	auto it = mSounds.find (soundID);
+	if (it == mSounds.end ())
+		return;
+
+	Command command = { Command::Stop, false, 0, it->second.get () };
+	PushCommand (command);
+}
+
+bool PCMMixer::IsEnded (int soundID) const {
+	auto it = mSounds.find (soundID);
+	return it == mSounds.end () || it->second->playing.load (memory_order_relaxed) == 0;
+}
+
+void PCMMixer::SetFormat (uint32_t numChannels, uint32_t sampleRate) {
+	CHECKMSG (numChannels == 1 || numChannels == 2, "PCMMixer::SetFormat () - Number of channels must be 1 or 2!");
+	CHECKMSG (sampleRate > 0, "PCMMixer::SetFormat () - sampleRate must be greater than 0!");
+
+	if (numChannels != mNumChannels || sampleRate != mSampleRate) {
+		uint32_t oldSampleRate = mSampleRate;
+		mNumChannels = numChannels;
+		mSampleRate = sampleRate;
+
+		for (auto& it : mSounds)
+			Convert (*it.second);
+
+		//The voices continue at the same time of their sounds
+		for (Voice& voice : mVoices) {
+			if (voice.sound == nullptr)
+				continue;
+
+			voice.frame = oldSampleRate > 0 ? (uint32_t) ((uint64_t) voice.frame * sampleRate / oldSampleRate) : 0;
+			if (voice.frame >= voice.sound->frameCount)
+				voice.frame = 0;
+		}
+	}
+
+	//The plays requested before the format was known start now
+	Flush ();
+}
+
+void PCMMixer::Flush () {
+	ProcessCommands ();
+	FreeRetired (true);
+}
+
+void PCMMixer::Clear () {
+	ProcessCommands ();
+	for (Voice& voice : mVoices) {
+		if (voice.sound != nullptr)
+			EndVoice (voice);
+	}
+
+	mSounds.clear ();
+	mRetired.clear ();
+}
+
+void PCMMixer::Mix (int16_t* out, uint32_t frameCount) {
+	ProcessCommands ();
+
+	if (mNumChannels > 0) {
+		for (Voice& voice : mVoices) {
+			if (voice.sound == nullptr)
+				continue;
+
+			//The voice wraps around (looped), or ends within the block
+			uint32_t done = 0;
+			while (done < frameCount && voice.sound != nullptr) {
+				uint32_t count = min (frameCount - done, voice.sound->frameCount - voice.frame);
+				mMix (out + done * mNumChannels, &voice.sound->samples[voice.frame * mNumChannels], count * mNumChannels, voice.volume);
+
+				done += count;
+				voice.frame += count;
+				if (voice.frame >= voice.sound->frameCount) {
+					if (voice.looped)
+						voice.frame = 0;
+					else
+						EndVoice (voice);
+				}
+			}
+		}
+	}
+
+	mMixCount.fetch_add (1, memory_order_release);
+}
+
+void PCMMixer::Mix_Scalar (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume) {
+	for (uint32_t i = 0; i < sampleCount; ++i) {
+		int32_t sample = (int32_t) dst[i] + (((int32_t) src[i] * volume + 0x4000) >> 15);
+		dst[i] = (int16_t) max (-32768, min (32767, sample));
+	}
+}
+
+void PCMMixer::ProcessCommands () {
+	uint32_t readIndex = mCommandReadIndex.load (memory_order_relaxed);
+	uint32_t writeIndex = mCommandWriteIndex.load (memory_order_acquire);
+	for (; readIndex != writeIndex; ++readIndex) {
+		const Command& command = mCommands[readIndex % CommandCount];
+		if (command.type == Command::Play)
+			StartVoice (command.sound, command.volume, command.looped);
+		else
+			StopVoices (command.sound);
+	}
+
+	mCommandReadIndex.store (readIndex, memory_order_release);
+}
+
+void PCMMixer::StartVoice (Sound* sound, int16_t volume, bool looped) {
+	//Restart the voice of the sound, or take a free one
+	Voice* target = nullptr;
+	for (Voice& voice : mVoices) {
+		if (voice.sound == sound) {
+			EndVoice (voice);
+			target = &voice;
+			break;
+		}
+
+		if (target == nullptr && voice.sound == nullptr)
+			target = &voice;
+	}
+
+	if (target == nullptr || sound->frameCount == 0) { //Dropped
+		sound->playing.fetch_sub (1, memory_order_relaxed);
+		return;
+	}
+
+	*target = { sound, 0, volume, looped };
+}
+
+void PCMMixer::StopVoices (Sound* sound) {
+	for (Voice& voice : mVoices) {
+		if (voice.sound == sound)
+			EndVoice (voice);
+	}
+}
+
+void PCMMixer::EndVoice (Voice& voice) {
+	voice.sound->playing.fetch_sub (1, memory_order_relaxed);
+	voice.sound = nullptr;
+	voice.frame = 0;
+}
+
+void PCMMixer::FreeRetired (bool all) {
+	if (all) { //Nothing is mixed
+		mRetired.clear ();
+		return;
+	}
+
+	//The stop of a removed sound is applied by the first mix started after the stop is queued (the mix running at that time does not count)
+	for (Retired& retired : mRetired) {
+		if (!retired.stopped) {
+			Command command = { Command::Stop, false, 0, retired.sound.get () };
+			retired.stopped = PushCommand (command);
+			retired.mixCount = mMixCount.load (memory_order_acquire);
+		}
+	}
+
+	uint32_t mixCount = mMixCount.load (memory_order_acquire);
+	mRetired.erase (remove_if (mRetired.begin (), mRetired.end (), [mixCount] (const Retired& retired) -> bool {
+		return retired.stopped && mixCount - retired.mixCount >= 2;
+	}), mRetired.end ());
+}
+
+void PCMMixer::Convert (Sound& sound) const {
+	uint32_t numChannels = mNumChannels > 0 ? mNumChannels : sound.numChannels;
+	uint32_t sampleRate = mSampleRate > 0 ? mSampleRate : sound.sampleRate;
+
+	//Linear interpolation to the output rate, the channels are duplicated or averaged
+	uint32_t srcFrames = (uint32_t) (sound.source.size () / sound.numChannels);
+	uint32_t dstFrames = (uint32_t) (((uint64_t) srcFrames * sampleRate + sound.sampleRate - 1) / sound.sampleRate);
+	double step = (double) sound.sampleRate / (double) sampleRate;
+
+	sound.samples.resize (dstFrames * numChannels);
+	for (uint32_t i = 0; i < dstFrames; ++i) {
+		double pos = (double) i * step;
+		uint32_t index = min ((uint32_t) pos, srcFrames - 1);
+		uint32_t next = min (index + 1, srcFrames - 1);
+		float frac = (float) (pos - (double) index);
+
+		float channels[2];
+		for (uint32_t c = 0; c < sound.numChannels; ++c) {
+			float first = (float) sound.source[index * sound.numChannels + c];
+			channels[c] = first + ((float) sound.source[next * sound.numChannels + c] - first) * frac;
+		}
+
+		if (numChannels == 1)
+			sound.samples[i] = (int16_t) (sound.numChannels == 2 ? (channels[0] + channels[1]) * 0.5f : channels[0]);
+		else
+			for (uint32_t c = 0; c < 2; ++c)
+				sound.samples[i * 2 + c] = (int16_t) channels[sound.numChannels == 2 ? c : 0];
+	}
+
+	sound.frameCount = dstFrames;
+}
+
+bool PCMMixer::PushCommand (const Command& command) {
+	uint32_t writeIndex = mCommandWriteIndex.load (memory_order_relaxed);
+	if (writeIndex - mCommandReadIndex.load (memory_order_acquire) >= CommandCount) {
+		LOGD ("PCMMixer - command queue is full, the command is dropped");
+		return false;
+	}
+
+	mCommands[writeIndex % CommandCount] = command;
+	mCommandWriteIndex.store (writeIndex + 1, memory_order_release);
+	return true;
+}
+
+#ifdef _DEBUG
+void PCMMixer::SelfTest () const {
+	//Compare the selected implementation with the scalar one (odd lengths cover the remainder handling, extreme values the saturation)
+	const uint32_t maxSampleCount = 67;
+	vector<int16_t> src (maxSampleCount);
+	vector<int16_t> dst (maxSampleCount);
+	uint32_t seed = 0x12345678;
+	for (uint32_t i = 0; i < maxSampleCount; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		src[i] = (int16_t) (seed >> 16);
+		seed = seed * 1664525u + 1013904223u;
+		dst[i] = i % 5 == 0 ? (int16_t) (i % 2 ? 32767 : -32768) : (int16_t) (seed >> 16);
+	}
+
+	const int16_t volumes[] = { 0, 1, 12345, 32767 };
+	for (int16_t volume : volumes) {
+		for (uint32_t sampleCount = 0; sampleCount <= maxSampleCount; ++sampleCount) {
+			vector<int16_t> expected (dst);
+			vector<int16_t> result (dst);
+
+			Mix_Scalar (&expected[0], &src[0], sampleCount, volume);
+			mMix (&result[0], &src[0], sampleCount, volume);
+			CHECKMSG (result == expected, "PCMMixer::SelfTest () - Mix result mismatch!");
+		}
+	}
+}
+#endif //_DEBUG
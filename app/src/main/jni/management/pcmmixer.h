@@ -0,0 +1,150 @@
+#pragma once
+
+//The SIMD implementations available on the target architecture (selected at runtime by CPU features)
+#if defined (__arm__) || defined (__aarch64__)
+#	define PCM_MIXER_NEON 1
+#elif defined (__i386__) || defined (__x86_64__)
+#	define PCM_MIXER_SSSE3 1
+#endif
+
+///
+/// Software mixer of the sound effects (16 bit interleaved PCM).
+///
+/// The effects are decoded once into memory and converted to the format of the output, the audio callback adds the
+/// playing voices to the output buffer (on top of the emulator sound) with per voice volume and saturation. The game
+/// thread controls the voices by a lock-free command queue, so playing a sound allocates nothing and never blocks the
+/// callback. A sound may play in one voice: playing it again restarts it (as the OpenSL players did).
+class PCMMixer {
+//Definitions
+public:
+	enum : uint32_t {
+		MaxVoices = 16, ///< The sounds played at the same time (a play is dropped, when all voices are busy).
+		CommandCount = 64 ///< The commands waiting for the next mix (a command is dropped, when the queue is full).
+	};
+
+	/// Add sampleCount samples of src scaled by volume (Q15) to dst with saturation.
+	typedef void (*MixFunc) (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume);
+
+private:
+	struct Sound {
+		uint32_t numChannels; ///< The decoded format.
+		uint32_t sampleRate;
+		vector<int16_t> source;
+		vector<int16_t> samples; ///< The sound in the output format.
+		uint32_t frameCount; ///< The frames in samples.
+		atomic<uint32_t> playing; ///< The plays not ended yet (incremented by Play, decremented by the mixing side).
+	};
+
+	struct Voice {
+		Sound* sound; ///< nullptr: free voice.
+		uint32_t frame; ///< The next frame to mix.
+		int16_t volume;
+		bool looped;
+	};
+
+	/// A removed sound waiting until no voice can use it.
+	struct Retired {
+		uint32_t mixCount; ///< The finished mixes, when its stop was queued.
+		bool stopped; ///< The stop is queued (retried, while the queue is full).
+		unique_ptr<Sound> sound;
+	};
+
+	struct Command {
+		enum Type : uint8_t {
+			Play,
+			Stop
+		};
+
+		Type type;
+		bool looped;
+		int16_t volume;
+		Sound* sound;
+	};
+
+//Data
+private:
+	MixFunc mMix;
+	string mName;
+
+	uint32_t mNumChannels; ///< The output format (0: not set).
+	uint32_t mSampleRate;
+
+	//Game thread
+	map<int, unique_ptr<Sound>> mSounds;
+	vector<Retired> mRetired;
+	int mNextID;
+
+	//Mixing side
+	Voice mVoices[MaxVoices];
+	Command mCommands[CommandCount];
+	atomic<uint32_t> mCommandWriteIndex; ///< Advanced by the game thread only.
+	atomic<uint32_t> mCommandReadIndex; ///< Advanced by the mixing side only.
+	atomic<uint32_t> mMixCount; ///< The finished mixes.
+
+//Construction
+public:
+	PCMMixer ();
+
+//Interface
+public:
+	/// The name of the selected mixing implementation.
+	const string& Name () const {
+		return mName;
+	}
+
+	/// Add a decoded sound (16 bit interleaved PCM) and return its ID (0: invalid sound). (Game thread)
+	int Add (uint32_t numChannels, uint32_t sampleRate, vector<int16_t>&& samples);
+
+	/// Decode a RIFF WAVE file (8 or 16 bit PCM, mono or stereo) and add it. Returns 0, when the data is not a supported wave. (Game thread)
+	int AddWAV (const uint8_t* data, size_t size);
+
+	/// Stop the sound and free it, when the mixing side cannot use it anymore. (Game thread)
+	void Remove (int soundID);
+
+	/// volume: 0..1 (the UI volume, it is cubed to get the amplification). (Game thread)
+	void Play (int soundID, float volume, bool looped);
+	void Stop (int soundID);
+	bool IsEnded (int soundID) const;
+
+	/// Convert the sounds to the output format and apply the waiting commands. The playing voices continue at the same time.
+	/// (Not thread safe, call it only when Mix is not running!)
+	void SetFormat (uint32_t numChannels, uint32_t sampleRate);
+
+	/// Apply the waiting commands and free the removed sounds. (Not thread safe, call it only when Mix is not running!)
+	void Flush ();
+
+	/// Stop the voices and remove all sounds. (Not thread safe, call it only when Mix is not running!)
+	void Clear ();
+
+	/// Free the removed sounds, which cannot be used by the mixing side anymore. (Game thread)
+	void Collect () {
+		FreeRetired (false);
+	}
+
+	/// Add the playing voices to frameCount frames of the output. (Mixing side)
+	void Mix (int16_t* out, uint32_t frameCount);
+
+//Implementations
+public:
+	static void Mix_Scalar (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume);
+#ifdef PCM_MIXER_NEON
+	static void Mix_NEON (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume);
+#endif //PCM_MIXER_NEON
+#ifdef PCM_MIXER_SSSE3
+	static void Mix_SSSE3 (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume);
+#endif //PCM_MIXER_SSSE3
+
+//Helper methods
+private:
+	void ProcessCommands ();
+	void StartVoice (Sound* sound, int16_t volume, bool looped);
+	void StopVoices (Sound* sound);
+	void EndVoice (Voice& voice);
+	void FreeRetired (bool all);
+	void Convert (Sound& sound) const;
+	bool PushCommand (const Command& command);
+
+#ifdef _DEBUG
+	void SelfTest () const;
+#endif //_DEBUG
+};
@@ -0,0 +1,24 @@
+#include "../pch.h"
+#include "pcmmixer.h"
+
+#ifdef PCM_MIXER_NEON
+
+#include <arm_neon.h>
+
+void PCMMixer::Mix_NEON (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume) {
+	const int16x8_t vol = vdupq_n_s16 (volume);
+
+	//16 samples in each step: rounding Q15 multiply ((src * volume + 0x4000) >> 15), then saturating add
+	uint32_t i = 0;
+	for (; i + 16 <= sampleCount; i += 16) {
+		int16x8_t scaled0 = vqrdmulhq_s16 (vld1q_s16 (src + i), vol);
+		int16x8_t scaled1 = vqrdmulhq_s16 (vld1q_s16 (src + i + 8), vol);
+		vst1q_s16 (dst + i, vqaddq_s16 (vld1q_s16 (dst + i), scaled0));
+		vst1q_s16 (dst + i + 8, vqaddq_s16 (vld1q_s16 (dst + i + 8), scaled1));
+	}
+
+	//Remaining samples
+	Mix_Scalar (dst + i, src + i, sampleCount - i, volume);
+}
+
+#endif //PCM_MIXER_NEON
@@ -0,0 +1,26 @@
+#include "../pch.h"
+#include "pcmmixer.h"
+
+#ifdef PCM_MIXER_SSSE3
+
+#include <tmmintrin.h>
+
+//The x86 ABI baseline has no SSSE3, so only this function is compiled for it (selected at runtime)
+__attribute__ ((target ("ssse3")))
+void PCMMixer::Mix_SSSE3 (int16_t* dst, const int16_t* src, uint32_t sampleCount, int16_t volume) {
+	const __m128i vol = _mm_set1_epi16 (volume);
+
+	//16 samples in each step: rounding Q15 multiply ((src * volume + 0x4000) >> 15), then saturating add
+	uint32_t i = 0;
+	for (; i + 16 <= sampleCount; i += 16) {
+		__m128i scaled0 = _mm_mulhrs_epi16 (_mm_loadu_si128 ((const __m128i*) (src + i)), vol);
+		__m128i scaled1 = _mm_mulhrs_epi16 (_mm_loadu_si128 ((const __m128i*) (src + i + 8)), vol);
+		_mm_storeu_si128 ((__m128i*) (dst + i), _mm_adds_epi16 (_mm_loadu_si128 ((const __m128i*) (dst + i)), scaled0));
+		_mm_storeu_si128 ((__m128i*) (dst + i + 8), _mm_adds_epi16 (_mm_loadu_si128 ((const __m128i*) (dst + i + 8)), scaled1));
+	}
+
+	//Remaining samples
+	Mix_Scalar (dst + i, src + i, sampleCount - i, volume);
+}
+
+#endif //PCM_MIXER_SSSE3
@@ -0,0 +1,335 @@
+#include "../pch.h"
+#include "pcmoutput.h"
+#include "avsync.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+//The alignment of the slots (one cache line)
+static const uint32_t s_slot_alignment = 64;
+
+PCMOutput::Counters::Counters () {
+	Reset ();
+}
+
+void PCMOutput::Counters::Reset () {
+	callbackCount.store (0, memory_order_relaxed);
+	underrunCount.store (0, memory_order_relaxed);
+	underrunBytes.store (0, memory_order_relaxed);
+	queueDepthSum.store (0, memory_order_relaxed);
+	queueDepthMax.store (0, memory_order_relaxed);
+	fillSum.store (0, memory_order_relaxed);
+	ratio.store (1.0f, memory_order_relaxed);
+	lastCallbackTime.store (0, memory_order_relaxed);
+	jitter.Reset ();
+
+	overrunBase = 0;
+	overrunBytesBase = 0;
+}
+
+PCMOutput::PCMOutput () :
+	mPlaying (false),
+	mSlots (nullptr),
+	mSlotSize (0),
+	mSlotStride (0),
+	mSlotCount (0),
+	mNextSlot (0),
+	mNumChannels (0),
+	mSampleRate (0),
+	mBytesPerSec (0),
+	mVolume (0),
+	mStream (nullptr),
+	mDirect (false),
+	mResample (false),
+	mBaseFill (0),
+	mFillCorrection (0),
+	mMix (false) {
+}
+
+PCMOutput::~PCMOutput () {
+	Stop ();
+}
+
+void PCMOutput::SetBackend (unique_ptr<IAudioBackend>&& backend) {
+	CHECKMSG (!mPlaying, "PCMOutput::SetBackend () - Cannot be called while playing!");
+	mBackend = move (backend);
+}
+
+void PCMOutput::Open (float volume, int numChannels, int sampleRate, int bytesPerSec, int deviceBufferFrames, int deviceBufferCount) {
+	CHECKMSG (numChannels > 0, "PCMOutput::Open () - numChannels must be greater than 0!");
+	CHECKMSG (sampleRate > 0, "PCMOutput::Open () - sampleRate must be greater than 0!");
+	CHECKMSG (bytesPerSec > 0, "PCMOutput::Open () - bytesPerSec must be greater than 0!");
+
+	mNumChannels = numChannels;
+	mSampleRate = sampleRate;
+	mBytesPerSec = bytesPerSec;
+	mVolume = volume;
+
+	size_t bufferSize = (size_t)mBytesPerSec;
+	if (deviceBufferFrames > 0) {
+		int frameSize = bytesPerSec / sampleRate;
+		bufferSize = (size_t) (deviceBufferFrames * frameSize);
+	}
+
+	if (deviceBufferCount < 2) //Min 2 buffer needed!
+		deviceBufferCount = 2;
+	else if (deviceBufferCount > 255) //The maximum available buffer number
+		deviceBufferCount = 255;
+
+	Stop (); //Stop the callbacks before touching their buffers
+
+	//One block for all slots, each slot starts on a cache line (the only allocation of the output)
+	mSlotSize = (uint32_t) bufferSize;
+	mSlotStride = (mSlotSize + s_slot_alignment - 1) / s_slot_alignment * s_slot_alignment;
+	mSlotCount = (uint32_t) deviceBufferCount;
+	mMemory.assign (mSlotStride * mSlotCount + s_slot_alignment, 0);
+	mSlots = (uint8_t*) (((uintptr_t) &mMemory[0] + s_slot_alignment - 1) & ~(uintptr_t) (s_slot_alignment - 1));
+	mSlotStamps.assign (mSlotCount, PCMStamp { 0, 0 });
+
+	//The source is kept at one device buffer and the sound of one 50 Hz frame (the chunks of the emulator and the game thread),
+	//moved by the correction of the A/V sync
+	int frameSize = bytesPerSec / sampleRate;
+	mBaseFill = (uint32_t) (bufferSize + (size_t) (sampleRate / 50 * frameSize));
+	mFillCorrection = AVSync::Get ().Correction ();
+	mDrift.Reset (CorrectedFill (mFillCorrection));
+
+	mResample = frameSize == numChannels * 2 && (numChannels == 1 || numChannels == 2); //16 bit sound only
+	if (mResample)
+		mResampler.Init ((uint32_t) numChannels, (uint32_t) (bufferSize / frameSize), 1.0 + PCMDriftController::MaxDeviation);
+
+	//The effects are converted to the format of the output (the voices continue after reopening)
+	mMix = mResample;
+	if (mMix)
+		mMixer.SetFormat ((uint32_t) numChannels, (uint32_t) sampleRate);
+
+	//The pushed sound waits in the queue for the callback (the queue holds four times the target and the maximal delay of the sync)
+	mQueue.Reset (4 * mBaseFill + (uint32_t) ((uint64_t) AVSync::MaxDelay * (uint64_t) bytesPerSec / 1000000000ull));
+	mQueue.SetMuted (false);
+
+	//Count the drops of the emulator stream from now on
+	mCounters.Reset ();
+	if (mStream != nullptr) {
+		mCounters.overrunBase = mStream->OverflowCount ();
+		mCounters.overrunBytesBase = mStream->OverflowBytes ();
+	}
+
+	//The direct stream is read by the buffer callback, so start playing immediately
+	mDirect = mStream != nullptr && mStream->IsDirect ();
+	if (mDirect)
+		Start ();
+}
+
+void PCMOutput::Close () {
+	Stop ();
+	ReleaseSlots ();
+
+	mNumChannels = 0;
+	mSampleRate = 0;
+	mBytesPerSec = 0;
+	mVolume = 0;
+	mDirect = false;
+	mResample = false;
+	mMix = false;
+}
+
+void PCMOutput::SetStream (PCMStream* stream) {
+	CHECKMSG (!mPlaying, "PCMOutput::SetStream () - Cannot be called while playing!");
+	mStream = stream;
+}
+
+void PCMOutput::Write (const uint8_t* buffer, size_t size, const PCMStamp& stamp) {
+	CHECKMSG (buffer != nullptr, "PCMOutput::Write () - buffer cannot be nullptr!");
+	CHECKMSG (size > 0, "PCMOutput::Write () - size must be greater than 0!");
+	CHECKMSG (!mDirect, "PCMOutput::Write () - Cannot be called with a direct stream!");
+
+	mQueue.Write (buffer, (uint32_t) size, stamp);
+
+	if (!mPlaying && mQueue.Available () >= mDrift.TargetFill ()) //Start playing, when the target latency is buffered
+		Start ();
+}
+
+PCMStats PCMOutput::GetStats () const {
+	PCMStats stats = {};
+	stats.callbackCount = mCounters.callbackCount.load (memory_order_relaxed);
+	stats.underrunCount = mCounters.underrunCount.load (memory_order_relaxed);
+	stats.underrunBytes = mCounters.underrunBytes.load (memory_order_relaxed);
+
+	//The drops of the pushed sound and of the emulator stream (the latter drops, when its reader is late)
+	stats.overrunCount = mQueue.OverflowCount ();
+	stats.overrunBytes = mQueue.OverflowBytes ();
+	if (mStream != nullptr) {
+		stats.overrunCount += mStream->OverflowCount () - mCounters.overrunBase;
+		stats.overrunBytes += mStream->OverflowBytes () - mCounters.overrunBytesBase;
+	}
+
+	LatencyHistogram::Summary jitter = mCounters.jitter.Summarize ();
+	stats.jitterMeanMicros = jitter.meanMicros;
+	stats.jitterP99Micros = jitter.p99Micros;
+	stats.jitterMaxMicros = jitter.maxMicros;
+
+	if (stats.callbackCount > 0) {
+		stats.queueDepthMean = (double) mCounters.queueDepthSum.load (memory_order_relaxed) / (double) stats.callbackCount;
+		if (mBytesPerSec > 0)
+			stats.fillMeanMillis = (double) mCounters.fillSum.load (memory_order_relaxed) / (double) stats.callbackCount * 1000.0 / (double) mBytesPerSec;
+	}
+	stats.queueDepthMax = mCounters.queueDepthMax.load (memory_order_relaxed);
+	stats.ratio = (double) mCounters.ratio.load (memory_order_relaxed);
+
+	return stats;
+}
+
+void PCMOutput::Start () {
+	CHECKMSG (mBackend != nullptr, "PCMOutput::Start () - Can be called only after SetBackend ()!");
+	CHECKMSG (!mPlaying, "PCMOutput::Start () - The output plays already!");
+	CHECKMSG (mSlotCount >= 2, "PCMOutput::Start () - Can be called only with minimum two buffers created before!");
+
+	AudioFormat format;
+	format.numChannels = (uint32_t) mNumChannels;
+	format.sampleRate = (uint32_t) mSampleRate;
+	format.bytesPerSec = (uint32_t) mBytesPerSec;
+	format.bufferSize = mSlotSize;
+	format.bufferCount = mSlotCount;
+
+	bool opened = mBackend->Open (format, &PCMOutput::BufferCallback, this);
+	CHECKARG (opened, "PCMOutput::Start () - The %s backend cannot open the output!", mBackend->Name ());
+	mPlaying = true;
+
+	//Prime the device with all of the slots: the ones beyond two with silence (the depth of the device queue is the latency
+	//of the buffer configuration), then two buffers of sound. Each callback refills the oldest slot, so the depth is kept.
+	mNextSlot = 0;
+	for (uint32_t i = 2; i < mSlotCount; ++i)
+		EnqueueSilence ();
+	OnBuffer ();
+	OnBuffer ();
+	mCounters.lastCallbackTime.store (0, memory_order_relaxed); //The jitter is measured from the first device callback
+
+	mBackend->Start ();
+}
+
+void PCMOutput::Stop () {
+	if (!mPlaying)
+		return;
+
+	mBackend->Close ();
+	mPlaying = false;
+}
+
+void PCMOutput::ReleaseSlots () {
+	mMemory.clear ();
+	mMemory.shrink_to_fit ();
+	mSlots = nullptr;
+	mSlotSize = 0;
+	mSlotStride = 0;
+	mSlotCount = 0;
+	mSlotStamps.clear ();
+}
+
+void PCMOutput::FillSlot (uint32_t slot, PCMStream& source) {
+	uint8_t* buffer = Slot (slot);
+	uint32_t size = mSlotSize;
+	uint32_t fill = source.Available () + (mResample ? mResampler.BufferedBytes () : 0);
+	mCounters.fillSum.fetch_add (fill, memory_order_relaxed);
+
+	PCMStamp stamp = { 0, 0 };
+	uint32_t readSize = 0;
+	if (mResample) { //Consume a bit faster or slower than the device plays to keep the fill level of the source
+		int64_t correction = AVSync::Get ().Correction ();
+		if (correction != mFillCorrection) {
+			mFillCorrection = correction;
+			mDrift.SetTargetFill (CorrectedFill (correction));
+		}
+
+		double ratio = mDrift.Update (fill);
+		mCounters.ratio.store ((float) ratio, memory_order_relaxed);
+		uint32_t frameSize = (uint32_t) mNumChannels * (uint32_t) sizeof (int16_t);
+		readSize = mResampler.Process (source, (int16_t*) buffer, size / frameSize, ratio, stamp) * frameSize;
+	} else {
+		readSize = source.Read (buffer, size, stamp);
+	}
+
+	if (readSize < size) {
+		mCounters.underrunCount.fetch_add (1, memory_order_relaxed);
+		mCounters.underrunBytes.fetch_add (size - readSize, memory_order_relaxed);
+	}
+
+	if (source.IsMuted ()) { //Consumed, but not played
+		readSize = 0;
+		stamp.time = 0;
+	}
+
+	//Silence only the tail, where the source is late
+	if (readSize < size)
+		memset (buffer + readSize, 0, size - readSize);
+
+	//The effects on top of the emulator sound
+	if (mMix)
+		mMixer.Mix ((int16_t*) buffer, size / ((uint32_t) mNumChannels * (uint32_t) sizeof (int16_t)));
+
+	mSlotStamps[slot] = stamp;
+}
+
+uint32_t PCMOutput::CorrectedFill (int64_t correction) const {
+	//Whole frames, never below one device buffer
+	int64_t frameSize = mBytesPerSec / mSampleRate;
+	int64_t bytes = correction * mBytesPerSec / 1000000000ll / frameSize * frameSize;
+	return (uint32_t) max ((int64_t) mSlotSize, (int64_t) mBaseFill + bytes);
+}
+
+void PCMOutput::OnBuffer () {
+	//The next slot of the ring (the device has played it, or never got it)
+	uint32_t slot = mNextSlot;
+	mNextSlot = (slot + 1) % mSlotCount;
+
+	//Fill the buffer from the emulator stream directly (independent of the game thread), or from the pushed sound
+	FillSlot (slot, mDirect ? *mStream : mQueue);
+
+	//Telemetry: the depth of the device queue and the deviation of the callback interval from the buffer duration
+	uint32_t queuedCount = mBackend->QueuedCount ();
+	uint64_t bufferNanos = (uint64_t) mSlotSize * 1000000000ull / (uint64_t) mBytesPerSec;
+	uint64_t now = mBackend->Now ();
+
+	mCounters.callbackCount.fetch_add (1, memory_order_relaxed);
+	mCounters.queueDepthSum.fetch_add (queuedCount, memory_order_relaxed);
+	if (queuedCount > mCounters.queueDepthMax.load (memory_order_relaxed))
+		mCounters.queueDepthMax.store (queuedCount, memory_order_relaxed);
+
+	uint64_t lastCallbackTime = mCounters.lastCallbackTime.load (memory_order_relaxed);
+	if (lastCallbackTime > 0) {
+		uint64_t interval = now - lastCallbackTime;
+		mCounters.jitter.Record (interval > bufferNanos ? interval - bufferNanos : bufferNanos - interval);
+	}
+	mCounters.lastCallbackTime.store (now, memory_order_relaxed);
+
+	//Latency of the sound: the buffers in the queue are played before this one
+	const PCMStamp& stamp = mSlotStamps[slot];
+	uint64_t playTime = now + (uint64_t) queuedCount * bufferNanos;
+	if (mStream != nullptr)
+		mStream->RecordLatency (stamp.time, playTime);
+
+	//A/V sync: the sound of the emulator frame starts with this slot (or in the previous one, the resolution is one buffer)
+	if (stamp.time > 0)
+		AVSync::Get ().Start (stamp.frame, playTime);
+
+	//The queue can refuse the slot, when the player is stopped or cleared during the callback (not fatal on the audio thread,
+	//the slot is not played: counted as an underrun)
+	if (!mBackend->Enqueue (Slot (slot), mSlotSize)) {
+		mCounters.underrunCount.fetch_add (1, memory_order_relaxed);
+		mCounters.underrunBytes.fetch_add (mSlotSize, memory_order_relaxed);
+	}
+}
+
+void PCMOutput::EnqueueSilence () {
+	uint32_t slot = mNextSlot;
+	mNextSlot = (slot + 1) % mSlotCount;
+
+	memset (Slot (slot), 0, mSlotSize);
+	mSlotStamps[slot] = PCMStamp { 0, 0 };
+
+	bool enqueued = mBackend->Enqueue (Slot (slot), mSlotSize);
+	CHECKMSG (enqueued, "PCMOutput::EnqueueSilence () - Enqueue of the slot failed!");
+}
+
+void PCMOutput::BufferCallback (void* context) {
+	CHECKMSG (context != nullptr, "PCMOutput::BufferCallback () - context cannot be nullptr!");
+	((PCMOutput*) context)->OnBuffer ();
+}
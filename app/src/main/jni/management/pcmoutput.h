@@ -0,0 +1,123 @@
+#pragma once
+
+#include "IContentManager.h"
+#include "audiobackend.h"
+#include "pcmstream.h"
+#include "pcmresampler.h"
+#include "pcmmixer.h"
+
+///
+/// The PCM output pipeline above an audio backend: the device buffers (slots), the emulator sound source, the clock drift
+/// compensation, the effect mixer and the telemetry.
+///
+/// The emulator sound is read by the buffer callback directly from a direct stream, or it is pushed by Write (the game
+/// thread) into a queue. Each callback fills the next slot (resampled to keep the fill level of the source), mixes the
+/// effects on top of it and enqueues it to the backend. The fill level target follows the correction of the A/V sync, and
+/// the playback start of the sound of each emulator frame is reported to it. The pipeline is the same for every backend, so it can be run
+/// and measured off-device with a simulated one.
+class PCMOutput {
+//Definitions
+private:
+	/// The telemetry counters (written by the buffer callback, read by any thread).
+	struct Counters {
+		atomic<uint32_t> callbackCount;
+		atomic<uint32_t> underrunCount;
+		atomic<uint64_t> underrunBytes;
+		atomic<uint64_t> queueDepthSum;
+		atomic<uint32_t> queueDepthMax;
+		atomic<uint64_t> fillSum; ///< Bytes
+		atomic<float> ratio;
+		atomic<uint64_t> lastCallbackTime; ///< 0 before the first callback of the device.
+		LatencyHistogram jitter;
+
+		uint32_t overrunBase; ///< The overflow count of the stream at Open.
+		uint64_t overrunBytesBase;
+
+		Counters ();
+		void Reset ();
+	};
+
+//Data
+private:
+	unique_ptr<IAudioBackend> mBackend;
+	bool mPlaying; ///< The backend is opened and calls the buffer callback.
+
+	//The device buffers (slots) in one cache line aligned block (only the buffer callback touches them while playing)
+	vector<uint8_t> mMemory; ///< The block of the slots (with space for the alignment).
+	uint8_t* mSlots; ///< The first slot in mMemory.
+	uint32_t mSlotSize; ///< The bytes of sound in a slot.
+	uint32_t mSlotStride; ///< The distance of the slots (the size rounded up to cache lines).
+	uint32_t mSlotCount;
+	uint32_t mNextSlot; ///< The slot filled by the next callback.
+	vector<PCMStamp> mSlotStamps; ///< The stream stamp of the first byte in each slot (its time is 0 when unknown).
+
+	int mNumChannels;
+	int mSampleRate;
+	int mBytesPerSec;
+	float mVolume;
+	PCMStream* mStream;
+	bool mDirect;
+
+	PCMStream mQueue; ///< The sound pushed by Write (when the stream is not direct).
+	PCMResampler mResampler; ///< Clock drift compensation of 16 bit sound.
+	PCMDriftController mDrift; ///< Keeps the fill level of the source at the target by the resampling ratio.
+	bool mResample;
+	uint32_t mBaseFill; ///< The target fill without the A/V sync correction (bytes).
+	int64_t mFillCorrection; ///< The A/V sync correction applied to the target fill (nanoseconds).
+	PCMMixer mMixer; ///< The sound effects.
+	bool mMix; ///< The effects are mixed into the output (16 bit sound only).
+	Counters mCounters;
+
+//Construction
+public:
+	PCMOutput ();
+	~PCMOutput ();
+
+//Interface
+public:
+	/// Set the audio device (call it only while the output is closed).
+	void SetBackend (unique_ptr<IAudioBackend>&& backend);
+
+	IAudioBackend* Backend () const {
+		return mBackend.get ();
+	}
+
+	/// The sound effects (their voices are mixed into the output, while it plays).
+	PCMMixer& Mixer () {
+		return mMixer;
+	}
+
+	void Open (float volume, int numChannels, int sampleRate, int bytesPerSec, int deviceBufferFrames, int deviceBufferCount);
+	void Close ();
+
+	bool IsOpened () const {
+		return mSlotCount > 0;
+	}
+
+	/// The backend plays (the buffer callback may run).
+	bool IsPlaying () const {
+		return mPlaying;
+	}
+
+	/// The stream is read by the buffer callback when it is direct (set it before Open).
+	void SetStream (PCMStream* stream);
+	void Write (const uint8_t* buffer, size_t size, const PCMStamp& stamp);
+
+	PCMStats GetStats () const;
+
+//Helper methods
+private:
+	void Start ();
+	void Stop ();
+	void ReleaseSlots ();
+	void FillSlot (uint32_t slot, PCMStream& source);
+	uint32_t CorrectedFill (int64_t correction) const;
+	void OnBuffer ();
+	void EnqueueSilence (); ///< Enqueue the next slot with silence (priming).
+
+	uint8_t* Slot (uint32_t slot) const {
+		return mSlots + slot * mSlotStride;
+	}
+
+	static void BufferCallback (void* context);
+};
@@ -0,0 +1,107 @@
+#include "../pch.h"
+#include "pcmresampler.h"
+#include "pcmstream.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PCMResampler implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void PCMResampler::Init (uint32_t numChannels, uint32_t maxOutFrames, double maxRatio) {
+	CHECKMSG (numChannels == 1 || numChannels == 2, "PCMResampler::Init () - Number of channels must be 1 or 2!");
+	CHECKMSG (maxRatio > 0, "PCMResampler::Init () - maxRatio must be greater than 0!");
+
+	mNumChannels = numChannels;
+	mMaxOutFrames = maxOutFrames;
+	mMaxRatio = maxRatio;
+
+	//The kept frames, the frames passed by the block and the next frame of the interpolation (with some rounding margin)
+	uint32_t maxInFrames = MaxLeftFrames + (uint32_t) ceil ((double) maxOutFrames * maxRatio) + 2;
+	mInput.assign (maxInFrames * numChannels, 0);
+
+	Reset ();
+}
+
+void PCMResampler::Reset () {
+	mLeftFrames = 0;
+	mPhase = 0;
+}
+
+uint32_t PCMResampler::Process (PCMStream& stream, int16_t* out, uint32_t outFrames, double ratio, PCMStamp& stamp) {
+	stamp.time = 0;
+	stamp.frame = 0;
+	outFrames = min (outFrames, mMaxOutFrames);
+	ratio = min (ratio, mMaxRatio);
+	if (outFrames == 0 || mNumChannels == 0 || ratio <= 0)
+		return 0;
+
+	uint32_t frameSize = mNumChannels * (uint32_t) sizeof (int16_t);
+
+	//Read the input of the whole block: the frames passed and the right neighbour of the last output frame
+	uint32_t neededFrames = (uint32_t) (mPhase + (double) (outFrames - 1) * ratio) + 2;
+	uint32_t readFrames = neededFrames > mLeftFrames ? neededFrames - mLeftFrames : 0;
+	readFrames = min (readFrames, stream.Available () / frameSize);
+	if (readFrames > 0)
+		readFrames = stream.Read ((uint8_t*) &mInput[mLeftFrames * mNumChannels], readFrames * frameSize, stamp) / frameSize;
+
+	//The count of the output frames covered by the input (all of them, except when the stream runs out)
+	uint32_t totalFrames = mLeftFrames + readFrames;
+	uint32_t count = 0;
+	if (totalFrames >= 2 && mPhase < (double) (totalFrames - 1)) //Output frame i needs phase + i * ratio < totalFrames - 1
+		count = min (outFrames, (uint32_t) ceil (((double) (totalFrames - 1) - mPhase) / ratio));
+
+	if (count > 0) {
+		if (mNumChannels == 2)
+			InterpolateStereo (&mInput[0], out, count, mPhase, ratio);
+		else
+			InterpolateMono (&mInput[0], out, count, mPhase, ratio);
+	}
+
+	//Keep the frames not passed yet
+	double end = mPhase + (double) count * ratio;
+	uint32_t passedFrames = min ((uint32_t) end, totalFrames);
+	mLeftFrames = totalFrames - passedFrames;
+	if (mLeftFrames > 0 && passedFrames > 0)
+		memmove (&mInput[0], &mInput[passedFrames * mNumChannels], mLeftFrames * frameSize);
+	mPhase = end - (double) passedFrames;
+
+	return count;
+}
+
+void PCMResampler::InterpolateMono (const int16_t* in, int16_t* out, uint32_t count, double phase, double ratio) {
+	for (uint32_t i = 0; i < count; ++i) {
+		double pos = phase + (double) i * ratio;
+		uint32_t index = (uint32_t) pos;
+		float frac = (float) (pos - (double) index);
+
+		float first = (float) in[index];
+		float next = (float) in[index + 1];
+		out[i] = (int16_t) (first + (next - first) * frac);
+	}
+}
+
+void PCMResampler::InterpolateStereo (const int16_t* in, int16_t* out, uint32_t count, double phase, double ratio) {
+	for (uint32_t i = 0; i < count; ++i) {
+		double pos = phase + (double) i * ratio;
+		uint32_t index = (uint32_t) pos;
+		float frac = (float) (pos - (double) index);
+
+		const int16_t* frame = in + index * 2;
+		float first0 = (float) frame[0];
+		float first1 = (float) frame[1];
+		float next0 = (float) frame[2];
+		float next1 = (float) frame[3];
+		out[i * 2] = (int16_t) (first0 + (next0 - first0) * frac);
+		out[i * 2 + 1] = (int16_t) (first1 + (next1 - first1) * frac);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PCMDriftController implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+constexpr double PCMDriftController::MaxDeviation;
+constexpr double PCMDriftController::Gain;
+constexpr double PCMDriftController::IntegralGain;
+constexpr double PCMDriftController::Smoothing;
+constexpr double PCMDriftController::MaxSlew;
@@ -0,0 +1,124 @@
+#pragma once
+
+class PCMStream;
+struct PCMStamp;
+
+///
+/// Fractional resampler of 16 bit interleaved PCM (linear interpolation).
+///
+/// Reads the input from a PCMStream and produces a fixed count of output frames for each call, the ratio
+/// (input frames / output frame) may change between the calls without discontinuity. The up to two input frames
+/// not passed yet are kept for the next call. The inner loops have no branches and no divisions, the position of
+/// each output frame is computed from the block start (no accumulated error), so the compiler can vectorize them.
+class PCMResampler {
+//Definitions
+public:
+	enum : uint32_t {
+		MaxLeftFrames = 2 ///< The count of the input frames kept between the calls (at most).
+	};
+
+//Data
+private:
+	uint32_t mNumChannels;
+	uint32_t mMaxOutFrames;
+	double mMaxRatio;
+
+	vector<int16_t> mInput; ///< The kept frames, then the frames read by the current call.
+	uint32_t mLeftFrames; ///< The count of the kept frames at the start of mInput.
+	double mPhase; ///< The position of the next output frame relative to mInput[0] (0 <= mPhase < 1).
+
+//Construction
+public:
+	PCMResampler () : mNumChannels (0), mMaxOutFrames (0), mMaxRatio (1.0), mLeftFrames (0), mPhase (0) {}
+
+//Interface
+public:
+	/// Allocate the input buffer for the given output block size and ratio limit. (The only allocation.)
+	void Init (uint32_t numChannels, uint32_t maxOutFrames, double maxRatio);
+
+	/// Forget the kept frames (after a discontinuity of the input).
+	void Reset ();
+
+	/// Produce up to outFrames frames, consuming about outFrames * ratio input frames. Returns the count of the produced frames
+	/// (less than outFrames when the stream runs out), stamp receives the stamp of the first consumed byte (its time is 0 when unknown).
+	uint32_t Process (PCMStream& stream, int16_t* out, uint32_t outFrames, double ratio, PCMStamp& stamp);
+
+	/// The count of the bytes buffered inside the resampler.
+	uint32_t BufferedBytes () const {
+		return mLeftFrames * mNumChannels * (uint32_t) sizeof (int16_t);
+	}
+
+//Helper methods
+private:
+	static void InterpolateMono (const int16_t* in, int16_t* out, uint32_t count, double phase, double ratio);
+	static void InterpolateStereo (const int16_t* in, int16_t* out, uint32_t count, double phase, double ratio);
+};
+
+///
+/// Keeps the fill level of a PCM queue at a target by a small resampling ratio (clock drift compensation).
+///
+/// The fill level is measured at each audio callback and smoothed. The ratio follows the relative error (proportional
+/// part) and the integrated error (the steady clock drift), it is limited to 1 +/- MaxDeviation and its change is slew
+/// limited, so the pitch change is never audible.
+class PCMDriftController {
+//Definitions
+public:
+	static constexpr double MaxDeviation = 0.005; ///< +/- 0.5%
+	static constexpr double Gain = 0.01; ///< Ratio deviation for 100% fill error.
+	static constexpr double IntegralGain = 0.00002; ///< Ratio deviation added in each callback for 100% fill error.
+	static constexpr double Smoothing = 0.05; ///< Weight of the new fill level sample.
+	static constexpr double MaxSlew = 0.0002; ///< The maximal ratio change in one callback.
+
+//Data
+private:
+	double mTargetFill;
+	double mFill;
+	double mDrift; ///< The integral part: the estimated clock drift.
+	double mRatio;
+
+//Construction
+public:
+	PCMDriftController () : mTargetFill (0), mFill (0), mDrift (0), mRatio (1.0) {}
+
+//Interface
+public:
+	/// Start with the queue at the target fill (in bytes).
+	void Reset (uint32_t targetFill) {
+		mTargetFill = (double) targetFill;
+		mFill = mTargetFill;
+		mDrift = 0;
+		mRatio = 1.0;
+	}
+
+	/// Move the target fill (in bytes), the ratio reaches it smoothly.
+	void SetTargetFill (uint32_t targetFill) {
+		mTargetFill = (double) targetFill;
+	}
+
+	/// Feed the fill level (in bytes) measured before reading the queue and get the new ratio (input / output rate).
+	double Update (uint32_t fill) {
+		if (mTargetFill <= 0)
+			return mRatio;
+
+		mFill += ((double) fill - mFill) * Smoothing;
+
+		double error = (mFill - mTargetFill) / mTargetFill;
+		mDrift = max (-MaxDeviation, min (MaxDeviation, mDrift + error * IntegralGain));
+
+		double ratio = 1.0 + max (-MaxDeviation, min (MaxDeviation, mDrift + error * Gain));
+		mRatio += max (-MaxSlew, min (MaxSlew, ratio - mRatio));
+		return mRatio;
+	}
+
+	double Ratio () const {
+		return mRatio;
+	}
+
+	double Fill () const {
+		return mFill;
+	}
+
+	uint32_t TargetFill () const {
+		return (uint32_t) mTargetFill;
+	}
+};
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "bytering.h"
+#include "frametimer.h"
+
+/// The time stamp of emulator sound.
+struct PCMStamp {
+	uint64_t time; ///< The time of the write (steady clock nanoseconds, 0: unknown).
+	uint32_t frame; ///< The emulator frame of the sound (the video frame tagged the same, see engine_s::emulator_frame).
+};
+
+///
+/// The emulator sound stream: the PCM ring, the stamps of its bytes, the mute flag and the end-to-end latency of the sound.
+///
+/// The emulator thread writes, the audio output reads: either the game thread (pushing the sound by IContentManager::WritePCM)
+/// or the audio callback directly. Each Write stamps the written bytes with the steady clock and the emulator frame, so the
+/// reader knows how old the sound is and which picture belongs to it. The latency (from the emulator write to the estimated
+/// start of the playback) is recorded by the audio output.
+class PCMStream {
+//Definitions
+private:
+	enum : uint32_t {
+		StampCount = 256 ///< Enough for seconds of emulator writes (a stamp is dropped when the reader falls behind).
+	};
+
+	struct Stamp {
+		uint32_t endPos; ///< The stream position after the written bytes.
+		PCMStamp stamp;
+	};
+
+//Data
+private:
+	ByteRing mRing;
+
+	Stamp mStamps[StampCount];
+	atomic<uint32_t> mStampWriteIndex; ///< Advanced by the producer only.
+	atomic<uint32_t> mStampReadIndex; ///< Advanced by the consumer only.
+
+	atomic<bool> mMuted;
+	atomic<bool> mDirect;
+	LatencyHistogram mLatency;
+
+//Construction
+public:
+	PCMStream () : mStampWriteIndex (0), mStampReadIndex (0), mMuted (true), mDirect (false) {}
+
+//Interface
+public:
+	/// Allocate the ring and clear the stamps. (Not thread safe, call it only when none of the sides use the stream!)
+	void Reset (uint32_t capacity) {
+		mRing.Reset (capacity);
+		mStampWriteIndex.store (0, memory_order_relaxed);
+		mStampReadIndex.store (0, memory_order_release);
+	}
+
+	uint32_t Capacity () const {
+		return mRing.Capacity ();
+	}
+
+	uint32_t Available () const {
+		return mRing.Available ();
+	}
+
+	uint64_t OverflowBytes () const {
+		return mRing.OverflowBytes ();
+	}
+
+	uint32_t OverflowCount () const {
+		return mRing.OverflowCount ();
+	}
+
+	/// Append bytes of the given emulator frame to the stream stamped with the current time. (Producer thread)
+	uint32_t Write (const uint8_t* src, uint32_t size, uint32_t frame) {
+		PCMStamp stamp = { Now (), frame };
+		return Write (src, size, stamp);
+	}
+
+	/// Append bytes to the stream with the given stamp. (Producer thread)
+	uint32_t Write (const uint8_t* src, uint32_t size, const PCMStamp& stamp) {
+		uint32_t count = mRing.Write (src, size);
+		if (count > 0) {
+			uint32_t writeIndex = mStampWriteIndex.load (memory_order_relaxed);
+			if (writeIndex - mStampReadIndex.load (memory_order_acquire) < StampCount) {
+				Stamp& entry = mStamps[writeIndex % StampCount];
+				entry.endPos = mRing.WritePosition ();
+				entry.stamp = stamp;
+				mStampWriteIndex.store (writeIndex + 1, memory_order_release);
+			}
+		}
+
+		return count;
+	}
+
+	/// Drop the bytes written so far. (Producer thread)
+	void Discard () {
+		mRing.Discard ();
+	}
+
+	/// Consume up to maxSize bytes of one write in place (see ByteRing::Read), so all of them have the stamp received
+	/// (its time is 0 when unknown). Call it until it returns 0 to consume the bytes of more writes. (Consumer thread)
+	template<class Consumer>
+	uint32_t Read (uint32_t maxSize, Consumer consumer, PCMStamp& stamp) {
+		uint32_t pos = mRing.ReadPosition ();
+		maxSize = min (maxSize, FindStamp (pos, stamp) - pos);
+		return mRing.Read (maxSize, consumer);
+	}
+
+	/// Copy up to maxSize bytes out of the stream, stamp receives the stamp of the first byte (its time is 0 when unknown). (Consumer thread)
+	uint32_t Read (uint8_t* dest, uint32_t maxSize, PCMStamp& stamp) {
+		FindStamp (mRing.ReadPosition (), stamp);
+		return mRing.Read (dest, maxSize);
+	}
+
+	/// The sound is consumed, but not played when muted (the game plays it only in game state).
+	bool IsMuted () const {
+		return mMuted.load (memory_order_relaxed);
+	}
+
+	void SetMuted (bool muted) {
+		mMuted.store (muted, memory_order_relaxed);
+	}
+
+	/// The audio callback reads the stream directly, when set (else the game thread pushes the sound to the audio output).
+	bool IsDirect () const {
+		return mDirect.load (memory_order_relaxed);
+	}
+
+	void SetDirect (bool direct) {
+		mDirect.store (direct, memory_order_relaxed);
+	}
+
+	/// Record the latency of a played chunk: from the write of its first byte until the playback start of the chunk (any thread).
+	void RecordLatency (uint64_t writeTime, uint64_t playTime) {
+		if (writeTime > 0 && playTime > writeTime)
+			mLatency.Record (playTime - writeTime);
+	}
+
+	LatencyHistogram::Summary SummarizeLatency () const {
+		return mLatency.Summarize ();
+	}
+
+	void ResetLatency () {
+		mLatency.Reset ();
+	}
+
+	/// The latency summary as a JSON object: {"direct":..,"count":..,"mean":..,"p50":..,"p95":..,"p99":..,"max":..} (times in microseconds)
+	string LatencyToJSON () const {
+		LatencyHistogram::Summary summary = SummarizeLatency ();
+
+		stringstream ss;
+		ss << fixed << setprecision (1) << "{" <<
+			"\"direct\":" << (IsDirect () ? "true" : "false") <<
+			",\"count\":" << summary.count <<
+			",\"mean\":" << summary.meanMicros <<
+			",\"p50\":" << summary.p50Micros <<
+			",\"p95\":" << summary.p95Micros <<
+			",\"p99\":" << summary.p99Micros <<
+			",\"max\":" << summary.maxMicros << "}";
+		return ss.str ();
+	}
+
+	/// The time base of the stamps (steady clock nanoseconds).
+	static uint64_t Now () {
+		return (uint64_t) chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now ().time_since_epoch ()).count ();
+	}
+
+//Helper methods
+private:
+	/// The stamp of the byte at the given stream position (the stamps of the writes before it are released). Returns the
+	/// stream position after the write of the byte (after the written bytes, when the byte has no stamp). (Consumer thread)
+	uint32_t FindStamp (uint32_t pos, PCMStamp& stamp) {
+		uint32_t readIndex = mStampReadIndex.load (memory_order_relaxed);
+		uint32_t writeIndex = mStampWriteIndex.load (memory_order_acquire);
+		while (readIndex != writeIndex && (int32_t) (mStamps[readIndex % StampCount].endPos - pos) <= 0)
+			++readIndex;
+
+		mStampReadIndex.store (readIndex, memory_order_release);
+		if (readIndex == writeIndex) {
+			stamp.time = 0;
+			stamp.frame = 0;
+			return pos + mRing.Available ();
+		}
+
+		const Stamp& entry = mStamps[readIndex % StampCount];
+		stamp = entry.stamp;
+		return entry.endPos;
+	}
+};
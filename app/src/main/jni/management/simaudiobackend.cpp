@@ -0,0 +1,217 @@
+#include "../pch.h"
+#include "simaudiobackend.h"
+#include "pcmstream.h"
+#ifdef __ANDROID__
+#include "../jnihelper/jniload.h"
+#endif //__ANDROID__
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SimulatedAudioBackend implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+SimulatedAudioBackend::SimulatedAudioBackend (bool realTime) :
+	mRealTime (realTime),
+	mOpened (false),
+	mFormat (),
+	mCallback (nullptr),
+	mContext (nullptr),
+	mBufferNanos (0),
+	mClock (PCMStream::Now ()),
+	mNextTick (0),
+	mStarted (false),
+	mStopThread (false),
+	mPlayedBytes (0),
+	mStarveCount (0) {
+}
+
+SimulatedAudioBackend::~SimulatedAudioBackend () {
+	Close ();
+}
+
+bool SimulatedAudioBackend::Open (const AudioFormat& format, BufferCallback callback, void* context) {
+	CHECKMSG (!mOpened, "SimulatedAudioBackend::Open () - The output is opened already!");
+	CHECKMSG (callback != nullptr, "SimulatedAudioBackend::Open () - callback cannot be nullptr!");
+	CHECKMSG (format.bytesPerSec > 0 && format.bufferSize > 0, "SimulatedAudioBackend::Open () - Invalid format!");
+
+	if (!OnOpen (format))
+		return false;
+
+	mFormat = format;
+	mCallback = callback;
+	mContext = context;
+	mBufferNanos = (uint64_t) format.bufferSize * 1000000000ull / (uint64_t) format.bytesPerSec;
+	mStarted = false;
+	mOpened = true;
+	return true;
+}
+
+void SimulatedAudioBackend::Close () {
+	if (!mOpened)
+		return;
+
+	if (mThread.joinable ()) {
+		mStopThread.store (true, memory_order_relaxed);
+		mThread.join ();
+	}
+
+	{
+		lock_guard<mutex> lock (mQueueLock);
+		mQueue.clear ();
+	}
+
+	mStarted = false;
+	mOpened = false;
+	OnClose ();
+}
+
+void SimulatedAudioBackend::Start () {
+	CHECKMSG (mOpened, "SimulatedAudioBackend::Start () - The output is not opened!");
+	if (mStarted)
+		return;
+
+	mStarted = true;
+	mNextTick = Now () + mBufferNanos;
+	if (mRealTime) {
+		mStopThread.store (false, memory_order_relaxed);
+		mThread = thread (&SimulatedAudioBackend::RunThread, this);
+	}
+}
+
+bool SimulatedAudioBackend::Enqueue (const uint8_t* buffer, uint32_t size) {
+	lock_guard<mutex> lock (mQueueLock);
+	if (!mOpened || mQueue.size () >= mFormat.bufferCount)
+		return false;
+
+	mQueue.push_back (make_pair (buffer, size));
+	return true;
+}
+
+uint32_t SimulatedAudioBackend::QueuedCount () const {
+	lock_guard<mutex> lock (mQueueLock);
+	return (uint32_t) mQueue.size ();
+}
+
+uint64_t SimulatedAudioBackend::Now () const {
+	return mRealTime ? PCMStream::Now () : mClock.load (memory_order_relaxed);
+}
+
+void SimulatedAudioBackend::Advance (uint64_t nanos) {
+	CHECKMSG (!mRealTime, "SimulatedAudioBackend::Advance () - The clock of a real-time backend cannot be driven!");
+
+	uint64_t target = mClock.load (memory_order_relaxed) + nanos;
+	while (mStarted && mNextTick <= target) {
+		mClock.store (mNextTick, memory_order_relaxed);
+		mNextTick += mBufferNanos;
+		Tick ();
+	}
+
+	mClock.store (target, memory_order_relaxed);
+}
+
+void SimulatedAudioBackend::Tick () {
+	//The device finished the head of the queue
+	pair<const uint8_t*, uint32_t> head (nullptr, 0);
+	{
+		lock_guard<mutex> lock (mQueueLock);
+		if (!mQueue.empty ()) {
+			head = mQueue.front ();
+			mQueue.pop_front ();
+		}
+	}
+
+	if (head.first == nullptr) {
+		mStarveCount.fetch_add (1, memory_order_relaxed);
+		return;
+	}
+
+	Play (head.first, head.second, mFormat);
+	mPlayedBytes.fetch_add (head.second, memory_order_relaxed);
+	mCallback (mContext);
+}
+
+void SimulatedAudioBackend::RunThread () {
+	chrono::steady_clock::time_point next = chrono::steady_clock::now () + chrono::nanoseconds (mBufferNanos);
+	while (!mStopThread.load (memory_order_relaxed)) {
+		this_thread::sleep_until (next);
+		if (mStopThread.load (memory_order_relaxed))
+			break;
+
+		Tick ();
+		next += chrono::nanoseconds (mBufferNanos);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// WAVAudioBackend implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+WAVAudioBackend::WAVAudioBackend (const string& path, bool realTime) :
+	SimulatedAudioBackend (realTime),
+	mPath (path),
+	mFileFormat (),
+	mDataBytes (0) {
+}
+
+WAVAudioBackend::~WAVAudioBackend () {
+	Close (); //Update the header while this is still a WAVAudioBackend
+}
+
+void WAVAudioBackend::Play (const uint8_t* buffer, uint32_t size, const AudioFormat& format) {
+	mFile.write ((const char*) buffer, size);
+	mDataBytes += size;
+}
+
+bool WAVAudioBackend::OnOpen (const AudioFormat& format) {
+	if (mFileFormat.numChannels == 0) { //The first open creates the file
+		mFile.open (mPath, ios::binary | ios::trunc);
+		if (!mFile.good ()) {
+			LOGE ("WAVAudioBackend::OnOpen () - Cannot open file: %s", mPath.c_str ());
+			return false;
+		}
+
+		mFileFormat = format;
+		mDataBytes = 0;
+		WriteHeader ();
+		return true;
+	}
+
+	if (format.numChannels != mFileFormat.numChannels || format.sampleRate != mFileFormat.sampleRate || format.bytesPerSec != mFileFormat.bytesPerSec) {
+		LOGE ("WAVAudioBackend::OnOpen () - The format cannot change within the file: %s", mPath.c_str ());
+		return false;
+	}
+
+	return true;
+}
+
+void WAVAudioBackend::OnClose () {
+	WriteHeader ();
+	mFile.flush ();
+}
+
+void WAVAudioBackend::WriteHeader () {
+	uint32_t blockAlign = mFileFormat.bytesPerSec / mFileFormat.sampleRate;
+	uint32_t bitsPerSample = blockAlign / mFileFormat.numChannels * 8;
+
+	uint8_t header[44];
+	auto put = [&header] (uint32_t offset, uint32_t value, uint32_t size) {
+		for (uint32_t i = 0; i < size; ++i)
+			header[offset + i] = (uint8_t) (value >> (i * 8));
+	};
+
+	memcpy (header, "RIFF", 4);
+	put (4, 36 + mDataBytes, 4);
+	memcpy (header + 8, "WAVEfmt ", 8);
+	put (16, 16, 4);
+	put (20, 1, 2); //PCM
+	put (22, mFileFormat.numChannels, 2);
+	put (24, mFileFormat.sampleRate, 4);
+	put (28, mFileFormat.bytesPerSec, 4);
+	put (32, blockAlign, 2);
+	put (34, bitsPerSample, 2);
+	memcpy (header + 36, "data", 4);
+	put (40, mDataBytes, 4);
+
+	streampos end = mFile.tellp ();
+	mFile.seekp (0);
+	mFile.write ((const char*) header, sizeof (header));
+	if (mDataBytes > 0)
+		mFile.seekp (end);
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "audiobackend.h"
+
+///
+/// An audio device simulated by a clock: the head of the queue is played (consumed) each time a buffer duration passes.
+///
+/// In real-time mode a thread ticks the clock by the steady clock, like a device does (the PCM throughput and callback
+/// timing can be measured off-device). In driven mode the clock moves only by Advance, the callbacks run on the calling
+/// thread, so a run with the same input produces bit-exact the same output.
+class SimulatedAudioBackend : public IAudioBackend {
+//Data
+private:
+	bool mRealTime;
+	bool mOpened;
+
+	AudioFormat mFormat;
+	BufferCallback mCallback;
+	void* mContext;
+	uint64_t mBufferNanos; ///< The duration of one buffer.
+
+	mutable mutex mQueueLock;
+	deque<pair<const uint8_t*, uint32_t>> mQueue;
+
+	atomic<uint64_t> mClock; ///< The simulated time (driven mode).
+	uint64_t mNextTick; ///< The time, when the head of the queue is played.
+	bool mStarted;
+
+	thread mThread; ///< The audio thread (real-time mode).
+	atomic<bool> mStopThread;
+
+	atomic<uint64_t> mPlayedBytes;
+	atomic<uint32_t> mStarveCount; ///< Ticks with an empty queue.
+
+//Construction
+public:
+	explicit SimulatedAudioBackend (bool realTime);
+	virtual ~SimulatedAudioBackend ();
+
+//Interface
+public:
+	virtual bool Open (const AudioFormat& format, BufferCallback callback, void* context) override;
+	virtual void Close () override;
+	virtual void Start () override;
+	virtual bool Enqueue (const uint8_t* buffer, uint32_t size) override;
+	virtual uint32_t QueuedCount () const override;
+	virtual uint64_t Now () const override;
+
+	bool IsRealTime () const {
+		return mRealTime;
+	}
+
+	/// Move the clock forward and play the buffers due (driven mode only, the callbacks are called on this thread).
+	void Advance (uint64_t nanos);
+
+	/// The bytes played since the construction.
+	uint64_t PlayedBytes () const {
+		return mPlayedBytes.load (memory_order_relaxed);
+	}
+
+	/// The buffer durations passed with an empty queue (the device was starved).
+	uint32_t StarveCount () const {
+		return mStarveCount.load (memory_order_relaxed);
+	}
+
+//Sink interface
+protected:
+	/// A buffer is played by the device (audio thread).
+	virtual void Play (const uint8_t* buffer, uint32_t size, const AudioFormat& format) = 0;
+
+	/// The output stream is opened (Open returns false, when the sink refuses the format).
+	virtual bool OnOpen (const AudioFormat& format) {
+		return true;
+	}
+
+	/// The output stream is closed (nothing is played after it). The destructor of a subclass has to call Close to get it.
+	virtual void OnClose () {}
+
+//Helper methods
+private:
+	void Tick ();
+	void RunThread ();
+};
+
+///
+/// Simulated device, which drops the played sound (throughput and timing measurements).
+class NullAudioBackend : public SimulatedAudioBackend {
+//Construction
+public:
+	explicit NullAudioBackend (bool realTime) : SimulatedAudioBackend (realTime) {}
+
+//Interface
+public:
+	virtual const char* Name () const override {
+		return IsRealTime () ? "null (real-time)" : "null (driven)";
+	}
+
+//Sink interface
+protected:
+	virtual void Play (const uint8_t* buffer, uint32_t size, const AudioFormat& format) override {}
+};
+
+///
+/// Simulated device, which writes the played sound into a RIFF WAVE file (bit-exact comparison of the output).
+///
+/// The file is written from the first Open, the following opens have to use the same format. The header is updated
+/// at each Close, so the file is valid whenever the output is closed.
+class WAVAudioBackend : public SimulatedAudioBackend {
+//Data
+private:
+	string mPath;
+	ofstream mFile;
+	AudioFormat mFileFormat; ///< The format of the file (numChannels is 0 before the first Open).
+	uint32_t mDataBytes;
+
+//Construction
+public:
+	WAVAudioBackend (const string& path, bool realTime);
+	virtual ~WAVAudioBackend ();
+
+//Interface
+public:
+	virtual const char* Name () const override {
+		return IsRealTime () ? "wav (real-time)" : "wav (driven)";
+	}
+
+	const string& Path () const {
+		return mPath;
+	}
+
+//Sink interface
+protected:
+	virtual void Play (const uint8_t* buffer, uint32_t size, const AudioFormat& format) override;
+	virtual bool OnOpen (const AudioFormat& format) override;
+	virtual void OnClose () override;
+
+//Helper methods
+private:
+	void WriteHeader ();
+};
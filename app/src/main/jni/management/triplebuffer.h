@@ -0,0 +1,84 @@
+#pragma once
+
+///
+/// Lock-free frame exchange between one producer and one consumer thread.
+///
+/// The three slots are owned by the writer, the reader and the exchange (ready slot) respectively.
+/// Publishing swaps the writer slot with the ready slot, acquiring swaps the reader slot with the ready slot,
+/// so neither side ever waits for the other and the reader always gets the newest complete frame. Each frame carries a
+/// tag of the writer (the emulator frame), so the reader knows which frame it got.
+class TripleBuffer {
+//Definitions
+private:
+	enum : uint32_t {
+		IndexMask = 0x03, ///< The bits of the slot index stored in the exchange.
+		FreshBit = 0x04 ///< Set when the ready slot contains a frame not seen by the reader yet.
+	};
+
+//Data
+private:
+	vector<uint8_t> mSlots[3];
+	uint32_t mTags[3]; ///< The tag of the frame in each slot.
+
+	uint32_t mWriteIndex; ///< Owned by the writer thread.
+	uint32_t mReadIndex; ///< Owned by the reader thread.
+	atomic<uint32_t> mReady; ///< The exchange: index of the ready slot and the FreshBit.
+
+//Construction
+public:
+	TripleBuffer () : mTags { 0, 0, 0 }, mWriteIndex (0), mReadIndex (1), mReady (2) {}
+
+//Interface
+public:
+	/// Reallocate all of the slots. (Not thread safe, call it only when none of the sides use the buffer!)
+	void Resize (size_t size) {
+		for (auto& slot : mSlots)
+			slot.assign (size, 0);
+
+		for (auto& tag : mTags)
+			tag = 0;
+
+		mWriteIndex = 0;
+		mReadIndex = 1;
+		mReady.store (2, memory_order_release);
+	}
+
+	size_t Size () const {
+		return mSlots[0].size ();
+	}
+
+	/// The slot of the writer thread.
+	uint8_t* WriteBuffer () {
+		return &mSlots[mWriteIndex][0];
+	}
+
+	/// Publish the content of the writer slot as the newest frame with the given tag. (Writer thread)
+	void Publish (uint32_t tag = 0) {
+		mTags[mWriteIndex] = tag;
+		mWriteIndex = mReady.exchange (mWriteIndex | FreshBit, memory_order_acq_rel) & IndexMask;
+	}
+
+	/// Returns true, when there is a published frame not acquired yet.
+	bool HasFresh () const {
+		return (mReady.load (memory_order_acquire) & FreshBit) != 0;
+	}
+
+	/// Take the newest published frame into the reader slot. Returns false, when no new frame arrived since the last call. (Reader thread)
+	bool Acquire () {
+		if (!HasFresh ())
+			return false;
+
+		mReadIndex = mReady.exchange (mReadIndex, memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+
+	/// The slot of the reader thread (the last acquired frame).
+	const uint8_t* ReadBuffer () const {
+		return &mSlots[mReadIndex][0];
+	}
+
+	/// The tag of the last acquired frame.
+	uint32_t ReadTag () const {
+		return mTags[mReadIndex];
+	}
+};
@@ -3,6 +3,7 @@
 #include <map>
 #include <set>
 #include <deque>
+#include <list>
 #include <array>
 #include <stack>
 #include <tuple>
@@ -19,6 +20,8 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 using namespace std;
 
 #include <stdio.h>
@@ -27,8 +30,10 @@ using namespace std;
 #include <assert.h>
 #include <string.h>
 #include <errno.h>
+#include <float.h>
 #include <sched.h>
 
+#ifdef __ANDROID__
 //Android OS specific includes
 #include <jni.h>
 
@@ -42,3 +47,8 @@ using namespace std;
 #include <SLES/OpenSLES_Platform.h>
 #include <SLES/OpenSLES_Android.h>
 #include <SLES/OpenSLES_AndroidConfiguration.h>
+#else
+//Host (desktop) build: GL calls are recorded by the shim, logging goes to the console
+#include "platform/host/glshim.h"
+#include "platform/host/hostlog.h"
+#endif //__ANDROID__
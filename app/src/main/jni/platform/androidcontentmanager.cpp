@@ -3,6 +3,7 @@
 #include "../jnihelper/JavaString.h"
 #include "../jnihelper/JavaByteArray.h"
 #include "audiomanager.h"
+#include "../content/pngdecoder.h"
 
 #include <android/asset_manager.h>
 #include <android/asset_manager_jni.h>
@@ -135,7 +136,17 @@ class JNI_ContentManager {
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // AndroidContentManager implementation
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-AndroidContentManager::AndroidContentManager (jobject activity, jobject assetManager) {
+
+//The process wide switch of the native image decoding
+static atomic<bool> s_native_image_decode (true);
+
+AndroidContentManager::AndroidContentManager (jobject activity, jobject assetManager) :
+	mAssetManager (nullptr),
+	mNativeCount (0),
+	mNativeNanos (0),
+	mJavaCount (0),
+	mJavaNanos (0),
+	mFallbackCount (0) {
 	CHECKMSG (activity != nullptr, "Activity reference cannot be nullptr!");
 	CHECKMSG (assetManager != nullptr, "AssetManager reference cannot be nullptr!");
 
@@ -147,6 +158,8 @@ AndroidContentManager::AndroidContentManager (jobject activity, jobject assetMan
 	AAssetManager* man = AAssetManager_fromJava (JNI::GetEnv (), jni.mAssetManager);
 	CHECKMSG (man != nullptr, "Native AAssetManager reference cannot be nullptr!");
 	audioManager.Init (man);
+
+	mAssetManager = man; //Valid while the global reference of the Java asset manager is kept
 }
 
 AndroidContentManager::~AndroidContentManager () {
@@ -162,35 +175,153 @@ AndroidContentManager::~AndroidContentManager () {
 }
 
 Image AndroidContentManager::LoadImage (const string & asset) {
-	return (Image) loadBitmap (asset);
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+
+	AndroidImage* image = nullptr;
+	if (IsNativeImageDecode ()) {
+		image = loadNativeImage (asset);
+		if (image == nullptr) {
+			LOGD ("AndroidContentManager::LoadImage () - Native decode failed, decoding by BitmapFactory: %s", asset.c_str ());
+			mFallbackCount.fetch_add (1, memory_order_relaxed);
+		}
+	}
+
+	bool native = image != nullptr;
+	if (image == nullptr)
+		image = loadJavaImage (asset);
+
+	uint64_t nanos = (uint64_t) chrono::duration_cast<chrono::nanoseconds> (chrono::steady_clock::now () - start).count ();
+	if (native) {
+		mNativeCount.fetch_add (1, memory_order_relaxed);
+		mNativeNanos.fetch_add (nanos, memory_order_relaxed);
+	} else {
+		mJavaCount.fetch_add (1, memory_order_relaxed);
+		mJavaNanos.fetch_add (nanos, memory_order_relaxed);
+	}
+
+	lock_guard<mutex> lock (mImageLock);
+	mImageAssets.insert (asset);
+	return (Image) image;
 }
 
 void AndroidContentManager::UnloadImage (Image& image) {
-	jobject jimg = (jobject) image;
-	JNI::ReleaseLocalReferencedObject (jimg);
+	AndroidImage* androidImage = (AndroidImage*) image;
+	if (androidImage != nullptr) {
+		if (androidImage->bitmap != nullptr)
+			JNI::ReleaseLocalReferencedObject (androidImage->bitmap);
+		delete androidImage;
+	}
+
 	image = nullptr;
 }
 
 const uint8_t * AndroidContentManager::LockPixels (Image image) {
+	CHECKMSG (image != nullptr, "AndroidContentManager::LockPixels () - image cannot be nullptr!");
+
+	AndroidImage* androidImage = (AndroidImage*) image;
+	if (androidImage->bitmap == nullptr)
+		return &androidImage->pixels[0];
+
 	void* ptr = nullptr;
-	AndroidBitmap_lockPixels (JNI::GetEnv (), (jobject) image, &ptr);
+	AndroidBitmap_lockPixels (JNI::GetEnv (), androidImage->bitmap, &ptr);
 	return (const uint8_t *) ptr;
 }
 
 void AndroidContentManager::UnlockPixels (Image image) {
-	AndroidBitmap_unlockPixels (JNI::GetEnv (), (jobject) image);
+	AndroidImage* androidImage = (AndroidImage*) image;
+	if (androidImage != nullptr && androidImage->bitmap != nullptr)
+		AndroidBitmap_unlockPixels (JNI::GetEnv (), androidImage->bitmap);
 }
 
 int AndroidContentManager::GetWidth (const Image image) const {
-	AndroidBitmapInfo info;
-	AndroidBitmap_getInfo (JNI::GetEnv (), (jobject) image, &info);
-	return (int) info.width;
+	return image == nullptr ? 0 : ((const AndroidImage*) image)->width;
 }
 
 int AndroidContentManager::GetHeight (const Image image) const {
-	AndroidBitmapInfo info;
-	AndroidBitmap_getInfo (JNI::GetEnv (), (jobject) image, &info);
-	return (int) info.height;
+	return image == nullptr ? 0 : ((const AndroidImage*) image)->height;
+}
+
+void AndroidContentManager::ReleaseImageThread () {
+	//The thread was attached to the VM by the JNI calls of the image loading
+	JNI::GetJavaVM ()->DetachCurrentThread ();
+}
+
+vector<uint8_t> AndroidContentManager::ReadAsset (const string& asset) const {
+	AAsset* file = AAssetManager_open (mAssetManager, asset.c_str (), AASSET_MODE_BUFFER);
+	if (file == nullptr)
+		return vector<uint8_t> ();
+
+	const uint8_t* data = (const uint8_t*) AAsset_getBuffer (file);
+	size_t size = (size_t) AAsset_getLength (file);
+	vector<uint8_t> content;
+	if (data != nullptr)
+		content.assign (data, data + size);
+
+	AAsset_close (file);
+	return content;
+}
+
+AndroidContentManager::ImageStats AndroidContentManager::GetImageStats () const {
+	ImageStats stats;
+	stats.nativeCount = mNativeCount.load (memory_order_relaxed);
+	stats.nativeMillis = (double) mNativeNanos.load (memory_order_relaxed) / 1e6;
+	stats.javaCount = mJavaCount.load (memory_order_relaxed);
+	stats.javaMillis = (double) mJavaNanos.load (memory_order_relaxed) / 1e6;
+	stats.fallbackCount = mFallbackCount.load (memory_order_relaxed);
+	return stats;
+}
+
+void AndroidContentManager::ResetImageStats () {
+	mNativeCount.store (0, memory_order_relaxed);
+	mNativeNanos.store (0, memory_order_relaxed);
+	mJavaCount.store (0, memory_order_relaxed);
+	mJavaNanos.store (0, memory_order_relaxed);
+	mFallbackCount.store (0, memory_order_relaxed);
+}
+
+string AndroidContentManager::ImageStatsToJSON () const {
+	ImageStats stats = GetImageStats ();
+
+	stringstream ss;
+	ss << fixed << setprecision (2) << "{" <<
+		"\"native\":" << stats.nativeCount <<
+		",\"nativeMillis\":" << stats.nativeMillis <<
+		",\"java\":" << stats.javaCount <<
+		",\"javaMillis\":" << stats.javaMillis <<
+		",\"fallbacks\":" << stats.fallbackCount << "}";
+	return ss.str ();
+}
+
+string AndroidContentManager::BenchmarkImages () {
+	vector<string> assets;
+	{
+		lock_guard<mutex> lock (mImageLock);
+		assets.assign (mImageAssets.begin (), mImageAssets.end ());
+	}
+
+	//The Java path at first, so the native one does not gain from the warm page cache of the APK
+	double javaMillis = 0;
+	for (const string& asset : assets)
+		javaMillis += timeImageLoad (asset, false);
+
+	double nativeMillis = 0;
+	for (const string& asset : assets)
+		nativeMillis += timeImageLoad (asset, true);
+
+	stringstream ss;
+	ss << fixed << setprecision (2) << "{" <<
+		"\"images\":" << assets.size () <<
+		",\"nativeMillis\":" << nativeMillis <<
+		",\"javaMillis\":" << javaMillis << "}";
+	return ss.str ();
+}
+
+bool AndroidContentManager::IsNativeImageDecode () {
+	return s_native_image_decode.load (memory_order_relaxed);
+}
+
+void AndroidContentManager::SetNativeImageDecode (bool enabled) {
+	s_native_image_decode.store (enabled, memory_order_relaxed);
 }
 
 int AndroidContentManager::LoadSound (const string & asset) {
@@ -233,9 +364,19 @@ bool AndroidContentManager::IsOpenedPCM () const {
 	return audioManager.IsOpenedPCM ();
 }
 
-void AndroidContentManager::WritePCM (const uint8_t* buffer, size_t size) {
+void AndroidContentManager::SetPCMStream (PCMStream* stream) {
+	AudioManager& audioManager = AudioManager::Get ();
+	audioManager.SetPCMStream (stream);
+}
+
+PCMStats AndroidContentManager::GetPCMStats () const {
+	AudioManager& audioManager = AudioManager::Get ();
+	return audioManager.GetPCMStats ();
+}
+
+void AndroidContentManager::WritePCM (const uint8_t* buffer, size_t size, const PCMStamp& stamp) {
 	AudioManager& audioManager = AudioManager::Get ();
-	audioManager.WritePCM (buffer, size);
+	audioManager.WritePCM (buffer, size, stamp);
 }
 
 string AndroidContentManager::ReadTextFile (const string& fileName) const {
@@ -321,3 +462,52 @@ jobject AndroidContentManager::loadBitmap (const string & asset) const {
 
 	return bitmap;
 }
+
+AndroidContentManager::AndroidImage* AndroidContentManager::loadNativeImage (const string& asset) const {
+	AAsset* file = AAssetManager_open (mAssetManager, asset.c_str (), AASSET_MODE_BUFFER);
+	if (file == nullptr)
+		return nullptr;
+
+	//Mapped from the APK, when the asset is stored uncompressed (as the PNG files are)
+	const uint8_t* data = (const uint8_t*) AAsset_getBuffer (file);
+	size_t size = (size_t) AAsset_getLength (file);
+
+	AndroidImage* image = new AndroidImage ();
+	image->bitmap = nullptr;
+	bool decoded = data != nullptr && PNGDecoder::DecodeShared (data, size, image->pixels, image->width, image->height);
+	AAsset_close (file);
+
+	if (!decoded) {
+		delete image;
+		return nullptr;
+	}
+
+	return image;
+}
+
+AndroidContentManager::AndroidImage* AndroidContentManager::loadJavaImage (const string& asset) const {
+	jobject bitmap = loadBitmap (asset);
+
+	AndroidBitmapInfo info;
+	AndroidBitmap_getInfo (JNI::GetEnv (), bitmap, &info);
+
+	AndroidImage* image = new AndroidImage ();
+	image->bitmap = bitmap;
+	image->width = (int) info.width;
+	image->height = (int) info.height;
+	return image;
+}
+
+double AndroidContentManager::timeImageLoad (const string& asset, bool native) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now ();
+
+	Image image = (Image) (native ? loadNativeImage (asset) : loadJavaImage (asset));
+	if (image == nullptr)
+		return 0;
+
+	LockPixels (image);
+	UnlockPixels (image);
+	UnloadImage (image);
+
+	return chrono::duration<double, milli> (chrono::steady_clock::now () - start).count ();
+}
@@ -2,7 +2,47 @@
 
 #include "../management/IContentManager.h"
 
+struct AAssetManager;
+
+///
+/// Content manager of the device.
+///
+/// The PNG assets are decoded natively from the mapped asset (AAsset_getBuffer), without a Java bitmap per image. The
+/// BitmapFactory path of JNI is the fallback of the images, which the native decoder does not read, and it can be
+/// switched on for all of the images (SetNativeImageDecode) to compare the load times of the two paths.
 class AndroidContentManager : public IContentManager {
+//Definitions
+public:
+	struct ImageStats {
+		uint32_t nativeCount; ///< The images decoded natively.
+		double nativeMillis; ///< The time of the native loads.
+		uint32_t javaCount; ///< The images decoded by BitmapFactory.
+		double javaMillis;
+		uint32_t fallbackCount; ///< The native decodes failed (loaded by BitmapFactory).
+	};
+
+private:
+	struct AndroidImage {
+		jobject bitmap; ///< The Java bitmap (local reference), nullptr when decoded natively.
+		int width;
+		int height;
+		vector<uint8_t> pixels; ///< The pixels of the native decode (premultiplied RGBA).
+	};
+
+//Data
+private:
+	AAssetManager* mAssetManager;
+
+	mutex mImageLock;
+	set<string> mImageAssets; ///< The loaded image assets (for BenchmarkImages).
+
+	atomic<uint32_t> mNativeCount;
+	atomic<uint64_t> mNativeNanos;
+	atomic<uint32_t> mJavaCount;
+	atomic<uint64_t> mJavaNanos;
+	atomic<uint32_t> mFallbackCount;
+
+//Construction
 public:
 	AndroidContentManager (jobject activity, jobject assetManager);
 	~AndroidContentManager ();
@@ -16,6 +56,8 @@ public:
 	virtual void UnlockPixels (Image image) override;
 	virtual int GetWidth (const Image image) const override;
 	virtual int GetHeight (const Image image) const override;
+	virtual void ReleaseImageThread () override;
+	virtual vector<uint8_t> ReadAsset (const string& asset) const override;
 
 //Sound interface
 public:
@@ -32,7 +74,9 @@ public:
 	virtual void ClosePCM () override;
 	virtual bool IsOpenedPCM () const override;
 
-	virtual void WritePCM (const uint8_t* buffer, size_t size) override;
+	virtual void SetPCMStream (PCMStream* stream) override;
+	virtual PCMStats GetPCMStats () const override;
+	virtual void WritePCM (const uint8_t* buffer, size_t size, const PCMStamp& stamp) override;
 
 //Utility interface
 public:
@@ -47,8 +91,30 @@ public:
 	virtual void Log (const string& log) override;
 	virtual double GetTime () const override;
 
+//Image load statistics
+public:
+	ImageStats GetImageStats () const;
+	void ResetImageStats ();
+
+	/// The statistics as a JSON object: {"native":..,"nativeMillis":..,"java":..,"javaMillis":..,"fallbacks":..}
+	string ImageStatsToJSON () const;
+
+	/// Load each of the image assets loaded so far by both of the paths, the total times as a JSON object:
+	/// {"images":..,"nativeMillis":..,"javaMillis":..}
+	string BenchmarkImages ();
+
+	/// The images are decoded natively (process wide switch, else by BitmapFactory).
+	static bool IsNativeImageDecode ();
+	static void SetNativeImageDecode (bool enabled);
+
 //Helper methods
 private:
+	AndroidImage* loadNativeImage (const string& asset) const;
+	AndroidImage* loadJavaImage (const string& asset) const;
+
+	/// The time of the load of the image to the locked pixels (the load of a texture), 0 when the image is not loaded.
+	double timeImageLoad (const string& asset, bool native);
+
 	jobject openAsset (const string& asset) const;
 	void closeStream (jobject istream) const;
 	jobject loadBitmap (const string& asset) const;
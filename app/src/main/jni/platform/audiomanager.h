@@ -1,44 +1,14 @@
 #pragma once
 
+#include "../management/IContentManager.h"
+#include "../management/pcmoutput.h"
+
 struct AAssetManager;
 
+///
+/// The sound of the device: the OpenSL ES engine with the PCM output on an OpenSL backend. The sound effects are decoded
+/// from the assets and mixed into the PCM output.
 class AudioManager {
-private:
-	struct Player {
-		int soundID;
-		bool looped;
-		bool ended;
-
-		SLObjectItf player;
-		SLPlayItf play;
-		SLSeekItf seek;
-		SLVolumeItf volume;
-		SLPrefetchStatusItf prefetch;
-
-		Player (int soundID);
-		~Player ();
-	};
-
-	struct PlayerPCM {
-		int bufferIndex;
-		SLObjectItf player;
-		SLPlayItf play;
-		SLVolumeItf volume;
-		SLAndroidSimpleBufferQueueItf queue;
-
-		PlayerPCM ();
-		~PlayerPCM ();
-	};
-
-	struct PCMSample {
-		vector<uint8_t> buffer;
-		size_t pos;
-
-		PCMSample (size_t len);
-		size_t Write (const uint8_t* src, size_t size);
-		void Rewind ();
-	};
-
 //Construction
 private:
 	AudioManager ();
@@ -54,7 +24,7 @@ public:
 	bool Init (AAssetManager* assetManager);
 	void Shutdown ();
 
-//Asset player interface
+//Sound effect interface (decoded into memory and mixed into the PCM output)
 public:
 	int Load (const string& assetName);
 	void Unload (int soundID);
@@ -65,41 +35,32 @@ public:
 
 //PCM player interface (in memory)
 public:
-	void OpenPCM (float volume, int numChannels, int sampleRate, int bytesPerSec, int deviceBufferFrames, int deviceBufferCount);
-	void ClosePCM ();
+	void OpenPCM (float volume, int numChannels, int sampleRate, int bytesPerSec, int deviceBufferFrames, int deviceBufferCount) {
+		mOutput.Open (volume, numChannels, sampleRate, bytesPerSec, deviceBufferFrames, deviceBufferCount); }
+	void ClosePCM () {
+		mOutput.Close (); }
 
 	bool IsOpenedPCM () const {
-		return mPCMs.size () > 0; }
+		return mOutput.IsOpened (); }
 
-	void WritePCM (const uint8_t* buffer, size_t size);
+	/// The stream is read by the queue callback when it is direct (set it before OpenPCM).
+	void SetPCMStream (PCMStream* stream) {
+		mOutput.SetStream (stream); }
+	void WritePCM (const uint8_t* buffer, size_t size, const PCMStamp& stamp) {
+		mOutput.Write (buffer, size, stamp); }
 
-//Helper methods
-private:
-	void StartPCM ();
-	void RealizeSLObject (SLObjectItf obj);
-
-	static void SLAPIENTRY PlayCallback (SLPlayItf play, void *context, SLuint32 event);
-	static void SLAPIENTRY QueueCallback (SLAndroidSimpleBufferQueueItf queue, void *context);
+	PCMStats GetPCMStats () const {
+		return mOutput.GetStats (); }
 
 //Data
 private:
-	static int mNextID;
-
 	bool mInited;
 
 	SLObjectItf mEngineObject;
 	SLEngineItf mEngine;
 	SLObjectItf mOutputMixObject;
 
-	map<int, Player*> mPlayers;
-
-	vector<shared_ptr<PCMSample>> mPCMs;
-	shared_ptr<PlayerPCM> mPCMPlayer;
-	int mPCMNumChannels;
-	int mPCMSampleRate;
-	int mPCMBytesPerSec;
-	int mPCMWriteBufferIndex;
-	float mPCMVolume;
+	PCMOutput mOutput; ///< On an OpenSLBackend (while inited).
 
 	AAssetManager* mAssetManager;
 };
@@ -0,0 +1,257 @@
+#include "../../pch.h"
+#include "etc1encoder.h"
+
+//The modifiers of the tables by the pixel index: +a, +b, -a, -b
+static const int s_modifiers[8][4] = {
+	{ 2, 8, -2, -8 },
+	{ 5, 17, -5, -17 },
+	{ 9, 29, -9, -29 },
+	{ 13, 42, -13, -42 },
+	{ 18, 60, -18, -60 },
+	{ 24, 80, -24, -80 },
+	{ 33, 106, -33, -106 },
+	{ 47, 183, -47, -183 }
+};
+
+static inline int Clamp255 (int value) {
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static inline int Expand (int value, int bits) {
+	return bits == 4 ? value * 17 : (value << 3 | value >> 2);
+}
+
+/// The position (x, y) in the block of the pixels of the subblocks (subblock: 0 or 1, flip: the subblocks are 4x2).
+static void SubblockPixels (int flip, int subblock, int xs[8], int ys[8]) {
+	for (int i = 0; i < 8; ++i) {
+		if (flip) {
+			xs[i] = i % 4;
+			ys[i] = subblock * 2 + i / 4;
+		} else {
+			xs[i] = subblock * 2 + i / 4;
+			ys[i] = i % 4;
+		}
+	}
+}
+
+vector<uint8_t> ETC1Encoder::Encode (const uint8_t* rgba, int width, int height) {
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	vector<uint8_t> blocks ((size_t) blocksX * blocksY * 8);
+
+	uint8_t block[16][3];
+	for (int by = 0; by < blocksY; ++by) {
+		for (int bx = 0; bx < blocksX; ++bx) {
+			for (int y = 0; y < 4; ++y) {
+				for (int x = 0; x < 4; ++x) {
+					int srcX = min (bx * 4 + x, width - 1);
+					int srcY = min (by * 4 + y, height - 1);
+					memcpy (block[y * 4 + x], rgba + ((size_t) srcY * width + srcX) * 4, 3);
+				}
+			}
+
+			uint64_t code = EncodeBlock (block);
+			uint8_t* dst = &blocks[((size_t) by * blocksX + bx) * 8];
+			for (int i = 0; i < 8; ++i) //Big endian
+				dst[i] = (uint8_t) (code >> (56 - i * 8));
+		}
+	}
+
+	return blocks;
+}
+
+void ETC1Encoder::Decode (const uint8_t* blocks, int width, int height, vector<uint8_t>& rgba) {
+	int blocksX = (width + 3) / 4;
+	int blocksY = (height + 3) / 4;
+	rgba.resize ((size_t) width * height * 4);
+
+	uint8_t block[16][3];
+	for (int by = 0; by < blocksY; ++by) {
+		for (int bx = 0; bx < blocksX; ++bx) {
+			const uint8_t* src = blocks + ((size_t) by * blocksX + bx) * 8;
+			uint64_t code = 0;
+			for (int i = 0; i < 8; ++i)
+				code = code << 8 | src[i];
+
+			DecodeBlock (code, block);
+			for (int y = 0; y < 4 && by * 4 + y < height; ++y) {
+				for (int x = 0; x < 4 && bx * 4 + x < width; ++x) {
+					uint8_t* dst = &rgba[((size_t) (by * 4 + y) * width + bx * 4 + x) * 4];
+					memcpy (dst, block[y * 4 + x], 3);
+					dst[3] = 0xFF;
+				}
+			}
+		}
+	}
+}
+
+uint64_t ETC1Encoder::EncodeBlock (const uint8_t block[16][3]) {
+	uint64_t bestCode = 0;
+	uint32_t bestError = 0xFFFFFFFF;
+
+	for (int flip = 0; flip < 2; ++flip) {
+		int xs[2][8];
+		int ys[2][8];
+		uint8_t pixels[2][8][3];
+		for (int s = 0; s < 2; ++s) {
+			SubblockPixels (flip, s, xs[s], ys[s]);
+			for (int i = 0; i < 8; ++i)
+				memcpy (pixels[s][i], block[ys[s][i] * 4 + xs[s][i]], 3);
+		}
+
+		for (int diff = 0; diff < 2; ++diff) {
+			int bits = diff ? 5 : 4;
+			SubblockCode codes[2];
+			int quantized[2][3];
+			EncodeSubblock (pixels[0], bits, codes[0], quantized[0]);
+			EncodeSubblock (pixels[1], bits, codes[1], quantized[1]);
+
+			if (diff) {
+				//The second base color is the first one and a delta of -4..3
+				bool clamped = false;
+				for (int c = 0; c < 3; ++c) {
+					int delta = quantized[1][c] - quantized[0][c];
+					if (delta < -4 || delta > 3) {
+						quantized[1][c] = quantized[0][c] + max (-4, min (3, delta));
+						clamped = true;
+					}
+				}
+
+				if (clamped) {
+					int base[3] = { Expand (quantized[1][0], 5), Expand (quantized[1][1], 5), Expand (quantized[1][2], 5) };
+					FindModifiers (pixels[1], base, codes[1]);
+				}
+			}
+
+			uint32_t error = codes[0].error + codes[1].error;
+			if (error >= bestError)
+				continue;
+
+			bestError = error;
+
+			uint64_t code = 0;
+			if (diff) {
+				for (int c = 0; c < 3; ++c) {
+					int delta = quantized[1][c] - quantized[0][c];
+					code |= (uint64_t) quantized[0][c] << (59 - c * 8);
+					code |= (uint64_t) (delta & 7) << (56 - c * 8);
+				}
+			} else {
+				for (int c = 0; c < 3; ++c) {
+					code |= (uint64_t) quantized[0][c] << (60 - c * 8);
+					code |= (uint64_t) quantized[1][c] << (56 - c * 8);
+				}
+			}
+
+			code |= (uint64_t) codes[0].table << 37 | (uint64_t) codes[1].table << 34 | (uint64_t) diff << 33 | (uint64_t) flip << 32;
+
+			//The pixel indices by columns: the most significant bits in 31..16, the least significant ones in 15..0
+			for (int s = 0; s < 2; ++s) {
+				for (int i = 0; i < 8; ++i) {
+					int bit = xs[s][i] * 4 + ys[s][i];
+					uint32_t index = codes[s].indices[i];
+					code |= (uint64_t) (index >> 1) << (16 + bit) | (uint64_t) (index & 1) << bit;
+				}
+			}
+
+			bestCode = code;
+		}
+	}
+
+	return bestCode;
+}
+
+void ETC1Encoder::FindModifiers (const uint8_t pixels[8][3], const int base[3], SubblockCode& code) {
+	code.error = 0xFFFFFFFF;
+	memcpy (code.base, base, sizeof (code.base));
+
+	for (int table = 0; table < 8; ++table) {
+		uint32_t error = 0;
+		uint8_t indices[8];
+		for (int i = 0; i < 8 && error < code.error; ++i) {
+			uint32_t bestError = 0xFFFFFFFF;
+			for (int index = 0; index < 4; ++index) {
+				int modifier = s_modifiers[table][index];
+				uint32_t pixelError = 0;
+				for (int c = 0; c < 3; ++c) {
+					int d = Clamp255 (base[c] + modifier) - pixels[i][c];
+					pixelError += (uint32_t) (d * d);
+				}
+
+				if (pixelError < bestError) {
+					bestError = pixelError;
+					indices[i] = (uint8_t) index;
+				}
+			}
+
+			error += bestError;
+		}
+
+		if (error < code.error) {
+			code.error = error;
+			code.table = table;
+			memcpy (code.indices, indices, sizeof (indices));
+		}
+	}
+}
+
+void ETC1Encoder::EncodeSubblock (const uint8_t pixels[8][3], int bits, SubblockCode& code, int quantized[3]) {
+	int maxValue = (1 << bits) - 1;
+
+	int average[3];
+	for (int c = 0; c < 3; ++c) {
+		int sum = 0;
+		for (int i = 0; i < 8; ++i)
+			sum += pixels[i][c];
+		average[c] = (sum * maxValue + 8 * 255 / 2) / (8 * 255);
+	}
+
+	//The average and its neighbours in the direction of the gray (the modifiers move all of the channels together)
+	code.error = 0xFFFFFFFF;
+	for (int step = -1; step <= 1; ++step) {
+		int candidate[3];
+		int base[3];
+		for (int c = 0; c < 3; ++c) {
+			candidate[c] = max (0, min (maxValue, average[c] + step));
+			base[c] = Expand (candidate[c], bits);
+		}
+
+		SubblockCode candidateCode;
+		FindModifiers (pixels, base, candidateCode);
+		if (candidateCode.error < code.error) {
+			code = candidateCode;
+			memcpy (quantized, candidate, sizeof (candidate));
+		}
+	}
+}
+
+void ETC1Encoder::DecodeBlock (uint64_t code, uint8_t block[16][3]) {
+	bool diff = ((code >> 33) & 1) != 0;
+	int flip = (int) ((code >> 32) & 1);
+	int tables[2] = { (int) ((code >> 37) & 7), (int) ((code >> 34) & 7) };
+
+	int bases[2][3];
+	for (int c = 0; c < 3; ++c) {
+		if (diff) {
+			int first = (int) ((code >> (59 - c * 8)) & 31);
+			int delta = (int) ((code >> (56 - c * 8)) & 7);
+			if (delta >= 4) //Signed 3 bits
+				delta -= 8;
+			bases[0][c] = Expand (first, 5);
+			bases[1][c] = Expand ((first + delta) & 31, 5);
+		} else {
+			bases[0][c] = Expand ((int) ((code >> (60 - c * 8)) & 15), 4);
+			bases[1][c] = Expand ((int) ((code >> (56 - c * 8)) & 15), 4);
+		}
+	}
+
+	for (int y = 0; y < 4; ++y) {
+		for (int x = 0; x < 4; ++x) {
+			int s = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+			int bit = x * 4 + y;
+			int index = (int) (((code >> (16 + bit)) & 1) << 1 | ((code >> bit) & 1));
+			for (int c = 0; c < 3; ++c)
+				block[y * 4 + x][c] = (uint8_t) Clamp255 (bases[s][c] + s_modifiers[tables[s]][index]);
+		}
+	}
+}
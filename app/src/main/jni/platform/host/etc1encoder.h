@@ -0,0 +1,38 @@
+#pragma once
+
+///
+/// ETC1 block compression of the texture_converter tool (host build only).
+///
+/// Each 4x4 block is encoded in both subblock orientations (2x4 and 4x2), in the individual (RGB444) and the
+/// differential (RGB555 + delta) modes. The base color of a subblock is searched around its average color with each of
+/// the 8 modifier tables, the encoding of the smallest squared error is kept. Slow, but it runs only offline.
+class ETC1Encoder {
+//Definitions
+private:
+	struct SubblockCode {
+		int base[3]; ///< The expanded (8 bit) base color.
+		int table;
+		uint32_t error;
+		uint8_t indices[8]; ///< The modifier indices of the pixels (in the order of Subblock pixels).
+	};
+
+//Interface
+public:
+	/// Encode the RGB channels of the RGBA pixels (the edge pixels are repeated into the partial blocks).
+	static vector<uint8_t> Encode (const uint8_t* rgba, int width, int height);
+
+	/// Decode the blocks into RGBA pixels (alpha 255), for the measurement of the quality.
+	static void Decode (const uint8_t* blocks, int width, int height, vector<uint8_t>& rgba);
+
+//Helper methods
+private:
+	static uint64_t EncodeBlock (const uint8_t block[16][3]);
+
+	/// The best code of the pixels with the given base color (the error of all of the tables).
+	static void FindModifiers (const uint8_t pixels[8][3], const int base[3], SubblockCode& code);
+
+	/// Search the quantized base colors around the average color of the pixels (bits: 4 or 5 bit channels).
+	static void EncodeSubblock (const uint8_t pixels[8][3], int bits, SubblockCode& code, int quantized[3]);
+
+	static void DecodeBlock (uint64_t code, uint8_t block[16][3]);
+};
@@ -0,0 +1,472 @@
+#include "../../pch.h"
+#include "glshim.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// GLShim implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+GLShim::GLShim () :
+	mError (GL_NO_ERROR),
+	mUnpackAlignment (4),
+	mNextName (1),
+	mActiveUnit (0),
+	mBoundArrayBuffer (0),
+	mBoundElementBuffer (0) {
+	memset (mBoundTextures, 0, sizeof (mBoundTextures));
+}
+
+const GLShim::Texture* GLShim::FindTexture (GLuint texture) const {
+	auto it = mTextures.find (texture);
+	return it == mTextures.end () ? nullptr : &it->second;
+}
+
+size_t GLShim::TextureBytes () const {
+	size_t bytes = 0;
+	for (auto& it : mTextures)
+		bytes += it.second.pixels.size ();
+	return bytes;
+}
+
+void GLShim::SetError (GLenum error) {
+	//Only the first error is kept until glGetError () is called (like on a real driver)
+	if (mError == GL_NO_ERROR)
+		mError = error;
+}
+
+GLenum GLShim::TakeError () {
+	GLenum error = mError;
+	mError = GL_NO_ERROR;
+	return error;
+}
+
+void GLShim::SetUnpackAlignment (GLint alignment) {
+	if (alignment != 1 && alignment != 2 && alignment != 4 && alignment != 8) {
+		SetError (GL_INVALID_VALUE);
+		return;
+	}
+
+	mUnpackAlignment = alignment;
+}
+
+void GLShim::GenNames (GLsizei n, GLuint* names, bool textures) {
+	for (GLsizei i = 0; i < n; ++i) {
+		names[i] = mNextName++;
+		if (textures)
+			mTextures[names[i]] = Texture ();
+		else
+			mBuffers[names[i]] = vector<uint8_t> ();
+	}
+}
+
+void GLShim::DeleteTextures (GLsizei n, const GLuint* textures) {
+	for (GLsizei i = 0; i < n; ++i) {
+		mTextures.erase (textures[i]);
+		for (GLuint& bound : mBoundTextures) {
+			if (bound == textures[i])
+				bound = 0;
+		}
+	}
+}
+
+void GLShim::DeleteBuffers (GLsizei n, const GLuint* buffers) {
+	for (GLsizei i = 0; i < n; ++i) {
+		mBuffers.erase (buffers[i]);
+		if (mBoundArrayBuffer == buffers[i])
+			mBoundArrayBuffer = 0;
+		if (mBoundElementBuffer == buffers[i])
+			mBoundElementBuffer = 0;
+	}
+}
+
+void GLShim::BindTexture (GLuint texture) {
+	++mStats.textureBinds;
+
+	if (texture != 0 && mTextures.find (texture) == mTextures.end ()) //GLES 1.x does not create textures on bind
+		mTextures[texture] = Texture ();
+
+	mBoundTextures[mActiveUnit] = texture;
+}
+
+void GLShim::ActiveTexture (GLenum unit) {
+	if (unit < GL_TEXTURE0 || unit >= GL_TEXTURE0 + sizeof (mBoundTextures) / sizeof (mBoundTextures[0])) {
+		SetError (GL_INVALID_ENUM);
+		return;
+	}
+
+	mActiveUnit = unit - GL_TEXTURE0;
+}
+
+void GLShim::BindBuffer (GLenum target, GLuint buffer) {
+	++mStats.bufferBinds;
+
+	if (buffer != 0 && mBuffers.find (buffer) == mBuffers.end ())
+		mBuffers[buffer] = vector<uint8_t> ();
+
+	if (target == GL_ARRAY_BUFFER)
+		mBoundArrayBuffer = buffer;
+	else if (target == GL_ELEMENT_ARRAY_BUFFER)
+		mBoundElementBuffer = buffer;
+	else
+		SetError (GL_INVALID_ENUM);
+}
+
+void GLShim::TexImage (GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+	auto it = mTextures.find (mBoundTextures[mActiveUnit]);
+	GLsizei bytePerPixel = BytePerPixel (format, type);
+	if (it == mTextures.end () || bytePerPixel == 0 || width < 0 || height < 0) {
+		SetError (it == mTextures.end () ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return;
+	}
+
+	Texture& texture = it->second;
+	texture.width = width;
+	texture.height = height;
+	texture.format = format;
+	texture.type = type;
+	texture.pixels.assign ((size_t) width * height * bytePerPixel, 0);
+
+	if (pixels != nullptr)
+		TexSubImage (0, 0, width, height, format, type, pixels); //counts the upload
+	else
+		++mStats.textureUploads;
+}
+
+void GLShim::TexSubImage (GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+	auto it = mTextures.find (mBoundTextures[mActiveUnit]);
+	if (it == mTextures.end () || pixels == nullptr) {
+		SetError (GL_INVALID_OPERATION);
+		return;
+	}
+
+	Texture& texture = it->second;
+	if (format != texture.format || type != texture.type) {
+		SetError (GL_INVALID_OPERATION);
+		return;
+	}
+
+	if (xoffset < 0 || yoffset < 0 || width < 0 || height < 0 || xoffset + width > texture.width || yoffset + height > texture.height) {
+		SetError (GL_INVALID_VALUE);
+		return;
+	}
+
+	//The source rows are padded to the unpack alignment
+	size_t bytePerPixel = (size_t) BytePerPixel (format, type);
+	size_t rowBytes = (size_t) width * bytePerPixel;
+	size_t srcPitch = (rowBytes + mUnpackAlignment - 1) / mUnpackAlignment * mUnpackAlignment;
+	size_t destPitch = (size_t) texture.width * bytePerPixel;
+
+	const uint8_t* src = (const uint8_t*) pixels;
+	for (GLsizei y = 0; y < height; ++y)
+		memcpy (&texture.pixels[(yoffset + y) * destPitch + xoffset * bytePerPixel], src + y * srcPitch, rowBytes);
+
+	++mStats.textureUploads;
+	mStats.textureUploadBytes += rowBytes * height;
+}
+
+void GLShim::CompressedTexImage (GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const GLvoid* data) {
+	auto it = mTextures.find (mBoundTextures[mActiveUnit]);
+	if (it == mTextures.end () || data == nullptr || imageSize < 0) {
+		SetError (it == mTextures.end () ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return;
+	}
+
+	//ETC1 is the only compressed format (blocks of 4x4 pixels in 8 bytes, the partial blocks are whole)
+	if (format != GL_ETC1_RGB8_OES) {
+		SetError (GL_INVALID_ENUM);
+		return;
+	}
+
+	if (width < 0 || height < 0 || imageSize != (width + 3) / 4 * ((height + 3) / 4) * 8) {
+		SetError (GL_INVALID_VALUE);
+		return;
+	}
+
+	//The compressed blocks are stored as they are
+	Texture& texture = it->second;
+	texture.width = width;
+	texture.height = height;
+	texture.format = format;
+	texture.type = 0;
+	texture.pixels.assign ((const uint8_t*) data, (const uint8_t*) data + imageSize);
+
+	++mStats.textureUploads;
+	mStats.textureUploadBytes += (uint64_t) imageSize;
+}
+
+void GLShim::BufferData (GLenum target, GLsizeiptr size, const GLvoid* data) {
+	vector<uint8_t>* buffer = BoundBuffer (target);
+	if (buffer == nullptr || size < 0) {
+		SetError (buffer == nullptr ? GL_INVALID_OPERATION : GL_INVALID_VALUE);
+		return;
+	}
+
+	if (data != nullptr) {
+		buffer->assign ((const uint8_t*) data, (const uint8_t*) data + size);
+		mStats.bufferUploadBytes += (uint64_t) size;
+	} else {
+		buffer->assign ((size_t) size, 0);
+	}
+}
+
+void GLShim::BufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
+	vector<uint8_t>* buffer = BoundBuffer (target);
+	if (buffer == nullptr || data == nullptr) {
+		SetError (GL_INVALID_OPERATION);
+		return;
+	}
+
+	if (offset < 0 || size < 0 || (size_t) (offset + size) > buffer->size ()) {
+		SetError (GL_INVALID_VALUE);
+		return;
+	}
+
+	memcpy (&(*buffer)[offset], data, (size_t) size);
+	mStats.bufferUploadBytes += (uint64_t) size;
+}
+
+void GLShim::Draw (GLsizei count) {
+	++mStats.drawCalls;
+	mStats.drawnVertices += (uint64_t) count;
+}
+
+GLsizei GLShim::BytePerPixel (GLenum format, GLenum type) {
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+		switch (format) {
+		case GL_RGBA:
+			return 4;
+		case GL_RGB:
+			return 3;
+		case GL_LUMINANCE_ALPHA:
+			return 2;
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+			return 1;
+		default:
+			return 0;
+		}
+	case GL_UNSIGNED_SHORT_5_6_5:
+		return format == GL_RGB ? 2 : 0;
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+		return format == GL_RGBA ? 2 : 0;
+	default:
+		return 0;
+	}
+}
+
+vector<uint8_t>* GLShim::BoundBuffer (GLenum target) {
+	GLuint name = target == GL_ARRAY_BUFFER ? mBoundArrayBuffer : (target == GL_ELEMENT_ARRAY_BUFFER ? mBoundElementBuffer : 0);
+	auto it = mBuffers.find (name);
+	return it == mBuffers.end () ? nullptr : &it->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// GL functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+extern "C" {
+
+GLenum glGetError () {
+	GLShim::Get ().CountCall ();
+	return GLShim::Get ().TakeError ();
+}
+
+void glGetIntegerv (GLenum pname, GLint* params) {
+	GLShim::Get ().CountCall ();
+
+	switch (pname) {
+	case GL_MAX_TEXTURE_SIZE:
+		*params = 2048;
+		break;
+	case GL_UNPACK_ALIGNMENT:
+		*params = 4;
+		break;
+	case GL_MAX_TEXTURE_UNITS:
+		*params = 2;
+		break;
+	default:
+		GLShim::Get ().SetError (GL_INVALID_ENUM);
+		break;
+	}
+}
+
+const GLubyte* glGetString (GLenum name) {
+	GLShim::Get ().CountCall ();
+
+	//The extensions used by the game
+	if (name == GL_EXTENSIONS)
+		return (const GLubyte*) "GL_OES_compressed_ETC1_RGB8_texture";
+
+	GLShim::Get ().SetError (GL_INVALID_ENUM);
+	return nullptr;
+}
+
+void glViewport (GLint x, GLint y, GLsizei width, GLsizei height) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glClearColor (GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glClear (GLbitfield mask) {
+	GLShim::Get ().CountCall ();
+}
+
+void glEnable (GLenum cap) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glDisable (GLenum cap) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glEnableClientState (GLenum array) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glDisableClientState (GLenum array) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glBlendFunc (GLenum sfactor, GLenum dfactor) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glColor4f (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glMatrixMode (GLenum mode) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glLoadIdentity () {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glPushMatrix () {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glPopMatrix () {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glOrthof (GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glTranslatef (GLfloat x, GLfloat y, GLfloat z) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glRotatef (GLfloat angle, GLfloat x, GLfloat y, GLfloat z) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glScalef (GLfloat x, GLfloat y, GLfloat z) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glGenTextures (GLsizei n, GLuint* textures) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().GenNames (n, textures, true);
+}
+
+void glDeleteTextures (GLsizei n, const GLuint* textures) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().DeleteTextures (n, textures);
+}
+
+void glBindTexture (GLenum target, GLuint texture) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().BindTexture (texture);
+}
+
+void glActiveTexture (GLenum texture) {
+	GLShim::Get ().CountStateCall ();
+	GLShim::Get ().ActiveTexture (texture);
+}
+
+void glClientActiveTexture (GLenum texture) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glTexParameteri (GLenum target, GLenum pname, GLint param) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glPixelStorei (GLenum pname, GLint param) {
+	GLShim::Get ().CountStateCall ();
+	if (pname == GL_UNPACK_ALIGNMENT)
+		GLShim::Get ().SetUnpackAlignment (param);
+}
+
+void glTexImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+	GLShim::Get ().CountCall ();
+	if (internalformat != (GLint) format) { //GLES 1.x requires the same internal and external format
+		GLShim::Get ().SetError (GL_INVALID_OPERATION);
+		return;
+	}
+
+	GLShim::Get ().TexImage (width, height, format, type, pixels);
+}
+
+void glTexSubImage2D (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().TexSubImage (xoffset, yoffset, width, height, format, type, pixels);
+}
+
+void glCompressedTexImage2D (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().CompressedTexImage (width, height, internalformat, imageSize, data);
+}
+
+void glGenBuffers (GLsizei n, GLuint* buffers) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().GenNames (n, buffers, false);
+}
+
+void glDeleteBuffers (GLsizei n, const GLuint* buffers) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().DeleteBuffers (n, buffers);
+}
+
+void glBindBuffer (GLenum target, GLuint buffer) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().BindBuffer (target, buffer);
+}
+
+void glBufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().BufferData (target, size, data);
+}
+
+void glBufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().BufferSubData (target, offset, size, data);
+}
+
+void glVertexPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glTexCoordPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glColorPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer) {
+	GLShim::Get ().CountStateCall ();
+}
+
+void glDrawArrays (GLenum mode, GLint first, GLsizei count) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().Draw (count);
+}
+
+void glDrawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
+	GLShim::Get ().CountCall ();
+	GLShim::Get ().Draw (count);
+}
+
+} //extern "C"
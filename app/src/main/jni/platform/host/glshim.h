@@ -0,0 +1,248 @@
+#pragma once
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//The subset of OpenGL ES 1.x used by the game (host build only)
+//
+//The calls do not render anything: the shim records them, keeps the texture and buffer
+//contents in memory and counts the work, so the game code can be measured without a GPU.
+//////////////////////////////////////////////////////////////////////////////////////////
+typedef void GLvoid;
+typedef unsigned int GLenum;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef signed char GLbyte;
+typedef short GLshort;
+typedef int GLint;
+typedef int GLsizei;
+typedef unsigned char GLubyte;
+typedef unsigned short GLushort;
+typedef unsigned int GLuint;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef intptr_t GLintptr;
+typedef intptr_t GLsizeiptr;
+
+#define GL_FALSE							0
+#define GL_TRUE								1
+
+#define GL_NO_ERROR							0
+#define GL_INVALID_ENUM						0x0500
+#define GL_INVALID_VALUE					0x0501
+#define GL_INVALID_OPERATION				0x0502
+#define GL_STACK_OVERFLOW					0x0503
+#define GL_STACK_UNDERFLOW					0x0504
+#define GL_OUT_OF_MEMORY					0x0505
+
+#define GL_COLOR_BUFFER_BIT					0x00004000
+
+#define GL_POINTS							0x0000
+#define GL_LINES							0x0001
+#define GL_TRIANGLES						0x0004
+#define GL_TRIANGLE_STRIP					0x0005
+#define GL_TRIANGLE_FAN						0x0006
+
+#define GL_SRC_ALPHA						0x0302
+#define GL_ONE_MINUS_SRC_ALPHA				0x0303
+#define GL_ZERO								0
+#define GL_ONE								1
+
+#define GL_TEXTURE_2D						0x0DE1
+#define GL_BLEND							0x0BE2
+#define GL_VERTEX_ARRAY						0x8074
+#define GL_COLOR_ARRAY						0x8076
+#define GL_TEXTURE_COORD_ARRAY				0x8078
+
+#define GL_MODELVIEW						0x1700
+#define GL_PROJECTION						0x1701
+
+#define GL_UNSIGNED_BYTE					0x1401
+#define GL_UNSIGNED_SHORT					0x1403
+#define GL_FLOAT							0x1406
+#define GL_UNSIGNED_SHORT_5_6_5				0x8363
+#define GL_UNSIGNED_SHORT_4_4_4_4			0x8033
+#define GL_UNSIGNED_SHORT_5_5_5_1			0x8034
+
+#define GL_ALPHA							0x1906
+#define GL_RGB								0x1907
+#define GL_RGBA								0x1908
+#define GL_LUMINANCE						0x1909
+#define GL_LUMINANCE_ALPHA					0x190A
+
+#define GL_TEXTURE_MAG_FILTER				0x2800
+#define GL_TEXTURE_MIN_FILTER				0x2801
+#define GL_TEXTURE_WRAP_S					0x2802
+#define GL_TEXTURE_WRAP_T					0x2803
+#define GL_NEAREST							0x2600
+#define GL_LINEAR							0x2601
+#define GL_CLAMP_TO_EDGE					0x812F
+
+#define GL_UNPACK_ALIGNMENT					0x0CF5
+#define GL_MAX_TEXTURE_SIZE					0x0D33
+
+#define GL_ARRAY_BUFFER						0x8892
+#define GL_ELEMENT_ARRAY_BUFFER				0x8893
+#define GL_STATIC_DRAW						0x88E4
+#define GL_DYNAMIC_DRAW						0x88E8
+
+#define GL_ETC1_RGB8_OES					0x8D64
+
+#define GL_TEXTURE0							0x84C0
+#define GL_TEXTURE1							0x84C1
+#define GL_MAX_TEXTURE_UNITS				0x84E2
+
+#define GL_EXTENSIONS						0x1F03
+
+extern "C" {
+GLenum glGetError ();
+void glGetIntegerv (GLenum pname, GLint* params);
+const GLubyte* glGetString (GLenum name);
+
+void glViewport (GLint x, GLint y, GLsizei width, GLsizei height);
+void glClearColor (GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+void glClear (GLbitfield mask);
+
+void glEnable (GLenum cap);
+void glDisable (GLenum cap);
+void glEnableClientState (GLenum array);
+void glDisableClientState (GLenum array);
+void glBlendFunc (GLenum sfactor, GLenum dfactor);
+void glColor4f (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+void glMatrixMode (GLenum mode);
+void glLoadIdentity ();
+void glPushMatrix ();
+void glPopMatrix ();
+void glOrthof (GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar);
+void glTranslatef (GLfloat x, GLfloat y, GLfloat z);
+void glRotatef (GLfloat angle, GLfloat x, GLfloat y, GLfloat z);
+void glScalef (GLfloat x, GLfloat y, GLfloat z);
+
+void glGenTextures (GLsizei n, GLuint* textures);
+void glDeleteTextures (GLsizei n, const GLuint* textures);
+void glBindTexture (GLenum target, GLuint texture);
+void glActiveTexture (GLenum texture);
+void glClientActiveTexture (GLenum texture);
+void glTexParameteri (GLenum target, GLenum pname, GLint param);
+void glPixelStorei (GLenum pname, GLint param);
+void glTexImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+void glTexSubImage2D (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels);
+void glCompressedTexImage2D (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data);
+
+void glGenBuffers (GLsizei n, GLuint* buffers);
+void glDeleteBuffers (GLsizei n, const GLuint* buffers);
+void glBindBuffer (GLenum target, GLuint buffer);
+void glBufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+void glBufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+void glVertexPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glTexCoordPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glColorPointer (GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glDrawArrays (GLenum mode, GLint first, GLsizei count);
+void glDrawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+}
+
+///
+/// The recording state of the GL shim.
+class GLShim {
+//Definitions
+public:
+	/// The counted work since the last ResetStats () call.
+	struct Stats {
+		uint64_t calls; ///< All of the GL calls.
+		uint64_t stateCalls; ///< Enable/disable, blend, color, matrix and client state calls.
+		uint64_t textureBinds;
+		uint64_t bufferBinds;
+		uint64_t textureUploads; ///< glTexImage2D, glTexSubImage2D and glCompressedTexImage2D calls.
+		uint64_t textureUploadBytes;
+		uint64_t bufferUploadBytes;
+		uint64_t drawCalls;
+		uint64_t drawnVertices;
+
+		Stats () { memset (this, 0, sizeof (Stats)); }
+	};
+
+	struct Texture {
+		GLsizei width;
+		GLsizei height;
+		GLenum format;
+		GLenum type;
+		vector<uint8_t> pixels; ///< Tightly packed rows of the uploaded image.
+
+		Texture () : width (0), height (0), format (GL_RGBA), type (GL_UNSIGNED_BYTE) {}
+	};
+
+//Data
+private:
+	Stats mStats;
+	GLenum mError;
+	GLint mUnpackAlignment;
+
+	GLuint mNextName;
+	GLuint mActiveUnit; ///< The index of the active texture unit.
+	GLuint mBoundTextures[2]; ///< The textures bound to the units (the units of the game: the color and the alpha plane).
+	GLuint mBoundArrayBuffer;
+	GLuint mBoundElementBuffer;
+	map<GLuint, Texture> mTextures;
+	map<GLuint, vector<uint8_t>> mBuffers;
+
+//Construction
+private:
+	GLShim ();
+
+public:
+	static GLShim& Get () {
+		static GLShim inst;
+		return inst;
+	}
+
+//Interface
+public:
+	const Stats& GetStats () const {
+		return mStats;
+	}
+
+	void ResetStats () {
+		mStats = Stats ();
+	}
+
+	/// The recorded state of a texture (nullptr, when the texture does not exist).
+	const Texture* FindTexture (GLuint texture) const;
+
+	/// The count of the live textures and their uploaded size in bytes.
+	size_t TextureCount () const {
+		return mTextures.size ();
+	}
+
+	size_t TextureBytes () const;
+
+	/// The count of the live buffers.
+	size_t BufferCount () const {
+		return mBuffers.size ();
+	}
+
+//Recording (called by the gl functions)
+public:
+	void CountCall () { ++mStats.calls; }
+	void CountStateCall () { ++mStats.calls; ++mStats.stateCalls; }
+	void SetError (GLenum error);
+	GLenum TakeError ();
+
+	void SetUnpackAlignment (GLint alignment);
+	void GenNames (GLsizei n, GLuint* names, bool textures);
+	void DeleteTextures (GLsizei n, const GLuint* textures);
+	void DeleteBuffers (GLsizei n, const GLuint* buffers);
+	void BindTexture (GLuint texture);
+	void ActiveTexture (GLenum unit);
+	void BindBuffer (GLenum target, GLuint buffer);
+	void TexImage (GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels);
+	void TexSubImage (GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels);
+	void CompressedTexImage (GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const GLvoid* data);
+	void BufferData (GLenum target, GLsizeiptr size, const GLvoid* data);
+	void BufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+	void Draw (GLsizei count);
+
+//Helper methods
+private:
+	static GLsizei BytePerPixel (GLenum format, GLenum type);
+	vector<uint8_t>* BoundBuffer (GLenum target);
+};
@@ -0,0 +1,305 @@
+#include "../../pch.h"
+#include "../../content/pixelkernels.h"
+#include "../../management/triplebuffer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Micro-benchmarks of the emulator frame path, each one against the implementation it replaced.
+//
+// usage: game_host_bench [handoff|kernels|formats|all] [seconds]
+//
+// handoff: the canvas handoff between the emulator and the game thread. The old one shared a recursive mutex: the
+// emulator rendered the frame under the lock, the game thread converted it under the same lock. The triple buffer
+// copies the finished frame into the writer slot and publishes it. The emulator runs in warp (as during the disk load),
+// the game thread converts the newest frame at 60 Hz. Reported is the time the emulator waits for the game thread (the
+// stall) and the time of the frame copy, that the triple buffer adds instead.
+//
+// kernels: the throughput of the selected SIMD pixel kernels and of the scalar ones (the previous 64 bit mask and shift
+// loop), converting whole frames row by row, as the game scene does. Two frames of random pixels alternate, so each
+// row changes.
+//
+// formats: the pixel stage of the in game frame update in each canvas format. The legacy BGRA frames are converted row
+// by row, the negotiated RGBA8888 and RGB565 frames are only compared with the texture rows and copied (no conversion
+// stage). A band of rows changes in each frame, like a moving sprite.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//The C64 screen (PAL) with the borders, in the legacy BGRA format of the emulator
+static const uint32_t s_width = 384;
+static const uint32_t s_height = 272;
+static const uint32_t s_frame_bytes = s_width * s_height * 4;
+
+static double Now () {
+	timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+/// Render a frame of the emulator: the whole screen is written, a band of rows moves with the frame index.
+static void RenderFrame (uint8_t* dest, uint32_t frameIndex) {
+	uint32_t bandStart = frameIndex % s_height;
+	for (uint32_t y = 0; y < s_height; ++y) {
+		uint32_t color = (y - bandStart) % s_height < 16 ? ((frameIndex & 1) ? 0xFFA0A0FFu : 0xFF6C5EB5u) : 0xFF352879u;
+		uint32_t* row = (uint32_t*) &dest[y * s_width * 4];
+		for (uint32_t x = 0; x < s_width; ++x)
+			row[x] = color;
+	}
+}
+
+struct HandoffResult {
+	uint32_t emulatorFrames;
+	uint32_t gameFrames;
+	double stallTotal;
+	double stallMax;
+	double copyTotal;
+	double convertTotal; ///< The conversion time of the game thread (the lock is held this long).
+};
+
+static void LogHandoff (const char* name, const HandoffResult& result, double seconds) {
+	LOGI ("handoff %-7s emulator frames %7u, stall: avg %7.3f us, max %7.1f us, total %6.2f ms/s, copy: avg %6.2f us; game frames %4u, convert: avg %6.1f us",
+		  name, result.emulatorFrames, result.stallTotal / result.emulatorFrames * 1e6, result.stallMax * 1e6, result.stallTotal / seconds * 1e3,
+		  result.copyTotal / result.emulatorFrames * 1e6, result.gameFrames, result.gameFrames > 0 ? result.convertTotal / result.gameFrames * 1e6 : 0.0);
+}
+
+/// The old handoff: LockCanvas/UnlockCanvas of the emulator and the conversion of the game thread hold the same lock.
+static HandoffResult BenchLockHandoff (double seconds) {
+	vector<uint8_t> canvas (s_frame_bytes, 0);
+	vector<uint8_t> texture (s_frame_bytes, 0);
+	recursive_mutex canvasLock;
+	bool canvasDirty = false;
+	atomic<bool> done (false);
+	HandoffResult result = { 0, 0, 0, 0, 0, 0 };
+
+	thread game ([&] () {
+		const PixelKernels& kernels = PixelKernels::Get ();
+		chrono::steady_clock::time_point next = chrono::steady_clock::now ();
+		while (!done.load (memory_order_acquire)) {
+			next += chrono::microseconds (16667);
+			this_thread::sleep_until (next);
+
+			lock_guard<recursive_mutex> lock (canvasLock);
+			if (canvasDirty) {
+				double start = Now ();
+				kernels.ConvertBGRA (&canvas[0], &texture[0], s_width * s_height);
+				result.convertTotal += Now () - start;
+				canvasDirty = false;
+				++result.gameFrames;
+			}
+		}
+	});
+
+	double end = Now () + seconds;
+	for (uint32_t frameIndex = 0; Now () < end; ++frameIndex) {
+		double start = Now ();
+		canvasLock.lock ();
+		double stall = Now () - start;
+
+		RenderFrame (&canvas[0], frameIndex);
+		canvasDirty = true;
+		canvasLock.unlock ();
+
+		result.stallTotal += stall;
+		result.stallMax = max (result.stallMax, stall);
+		++result.emulatorFrames;
+	}
+
+	done.store (true, memory_order_release);
+	game.join ();
+	return result;
+}
+
+/// The triple buffer handoff of UnlockCanvas: copy the finished frame into the writer slot and publish it.
+static HandoffResult BenchTripleBufferHandoff (double seconds) {
+	vector<uint8_t> canvas (s_frame_bytes, 0);
+	vector<uint8_t> texture (s_frame_bytes, 0);
+	TripleBuffer frames;
+	frames.Resize (s_frame_bytes);
+	atomic<bool> done (false);
+	HandoffResult result = { 0, 0, 0, 0, 0, 0 };
+
+	thread game ([&] () {
+		const PixelKernels& kernels = PixelKernels::Get ();
+		chrono::steady_clock::time_point next = chrono::steady_clock::now ();
+		while (!done.load (memory_order_acquire)) {
+			next += chrono::microseconds (16667);
+			this_thread::sleep_until (next);
+
+			if (frames.Acquire ()) {
+				double start = Now ();
+				kernels.ConvertBGRA (frames.ReadBuffer (), &texture[0], s_width * s_height);
+				result.convertTotal += Now () - start;
+				++result.gameFrames;
+			}
+		}
+	});
+
+	double end = Now () + seconds;
+	for (uint32_t frameIndex = 0; Now () < end; ++frameIndex) {
+		RenderFrame (&canvas[0], frameIndex);
+
+		double start = Now ();
+		memcpy (frames.WriteBuffer (), &canvas[0], frames.Size ());
+		double published = Now ();
+		frames.Publish (frameIndex);
+		double stall = Now () - published;
+
+		result.copyTotal += published - start;
+		result.stallTotal += stall;
+		result.stallMax = max (result.stallMax, stall);
+		++result.emulatorFrames;
+	}
+
+	done.store (true, memory_order_release);
+	game.join ();
+	return result;
+}
+
+static void BenchHandoff (double seconds) {
+	LogHandoff ("lock", BenchLockHandoff (seconds), seconds);
+	LogHandoff ("triple", BenchTripleBufferHandoff (seconds), seconds);
+}
+
+/// Convert frames row by row for the given time. Returns the converted pixels per nanosecond.
+template<typename Convert>
+static double BenchKernel (const vector<uint8_t> sources[2], double seconds, Convert convert) {
+	vector<uint8_t> texture (s_frame_bytes, 0);
+	uint64_t pixelCount = 0;
+	uint32_t changedCount = 0; //Keeps the result of the conversion alive
+
+	double start = Now ();
+	double elapsed = 0;
+	for (uint32_t frameIndex = 0; elapsed < seconds; ++frameIndex) {
+		const uint8_t* frame = &sources[frameIndex & 1][0];
+		for (uint32_t y = 0; y < s_height; ++y) {
+			if (convert (&frame[y * s_width * 4], &texture[y * s_width * 4], s_width))
+				++changedCount;
+		}
+
+		pixelCount += s_width * s_height;
+		elapsed = Now () - start;
+	}
+
+	if (changedCount == 0)
+		LOGE ("no rows changed");
+	return (double) pixelCount / (elapsed * 1e9);
+}
+
+static void LogKernels (const char* name, double scalar, double selected) {
+	LOGI ("kernels %-14s scalar %6.3f pixels/ns, %s %6.3f pixels/ns (%.2fx)", name, scalar, PixelKernels::Get ().Name ().c_str (), selected, selected / scalar);
+}
+
+static void BenchKernels (double seconds) {
+	vector<uint8_t> sources[2];
+	uint32_t seed = 0x12345678;
+	for (auto& source : sources) {
+		source.resize (s_frame_bytes);
+		for (auto& value : source) {
+			seed = seed * 1664525u + 1013904223u;
+			value = (uint8_t) (seed >> 24);
+		}
+	}
+
+	const PixelKernels& kernels = PixelKernels::Get ();
+	double part = seconds / 4;
+	uint32_t sums[3] = { 0, 0, 0 };
+
+	double scalar = BenchKernel (sources, part, [] (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+		return PixelKernels::ConvertBGRA_Scalar (src, dst, pixelCount);
+	});
+	double selected = BenchKernel (sources, part, [&kernels] (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+		return kernels.ConvertBGRA (src, dst, pixelCount);
+	});
+	LogKernels ("ConvertBGRA", scalar, selected);
+
+	scalar = BenchKernel (sources, part, [&sums] (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+		PixelKernels::ConvertBGRASum_Scalar (src, dst, pixelCount, sums);
+		return true;
+	});
+	selected = BenchKernel (sources, part, [&kernels, &sums] (const uint8_t* src, uint8_t* dst, uint32_t pixelCount) {
+		kernels.ConvertBGRASum (src, dst, pixelCount, sums);
+		return true;
+	});
+	LogKernels ("ConvertBGRASum", scalar, selected);
+}
+
+/// The in game pixel stage (GameScene::UpdatePixelsInGame) of one frame. Returns the count of the changed rows.
+static uint32_t UpdatePixels (const uint8_t* frame, uint8_t* texture, uint32_t pitch, bool isDirectFormat) {
+	const PixelKernels& kernels = PixelKernels::Get ();
+	uint32_t changedCount = 0;
+	for (uint32_t y = 0; y < s_height; ++y) {
+		const uint8_t* src = &frame[y * pitch];
+		uint8_t* dest = &texture[y * pitch];
+
+		if (isDirectFormat) {
+			if (memcmp (dest, src, pitch) != 0) {
+				memcpy (dest, src, pitch);
+				++changedCount;
+			}
+		} else if (kernels.ConvertBGRA (src, dest, s_width)) {
+			++changedCount;
+		}
+	}
+
+	return changedCount;
+}
+
+static void BenchFormat (const char* name, const vector<vector<uint8_t>>& frames, uint32_t bytePerPixel, bool isDirectFormat, double seconds) {
+	uint32_t pitch = s_width * bytePerPixel;
+	vector<uint8_t> texture (pitch * s_height, 0);
+	uint64_t changedCount = 0;
+
+	double start = Now ();
+	double elapsed = 0;
+	uint32_t frameCount = 0;
+	for (; elapsed < seconds; ++frameCount) {
+		changedCount += UpdatePixels (&frames[frameCount % frames.size ()][0], &texture[0], pitch, isDirectFormat);
+		elapsed = Now () - start;
+	}
+
+	LOGI ("format %-8s pixel stage: avg %6.2f us/frame, changed rows %.1f/frame", name, elapsed / frameCount * 1e6, (double) changedCount / frameCount);
+}
+
+static void BenchFormats (double seconds) {
+	//The same frames rendered by the emulator in each format
+	const uint32_t frameCount = 16;
+	vector<vector<uint8_t>> bgraFrames (frameCount);
+	vector<vector<uint8_t>> rgbaFrames (frameCount);
+	vector<vector<uint8_t>> rgb565Frames (frameCount);
+	for (uint32_t i = 0; i < frameCount; ++i) {
+		bgraFrames[i].resize (s_frame_bytes);
+		RenderFrame (&bgraFrames[i][0], i);
+
+		rgbaFrames[i].resize (s_frame_bytes);
+		PixelKernels::ConvertBGRA_Scalar (&bgraFrames[i][0], &rgbaFrames[i][0], s_width * s_height);
+
+		rgb565Frames[i].resize (s_width * s_height * 2);
+		uint16_t* dest = (uint16_t*) &rgb565Frames[i][0];
+		for (uint32_t p = 0; p < s_width * s_height; ++p) {
+			const uint8_t* rgba = &rgbaFrames[i][p * 4];
+			dest[p] = (uint16_t) ((rgba[0] >> 3) << 11 | (rgba[1] >> 2) << 5 | rgba[2] >> 3);
+		}
+	}
+
+	double part = seconds / 3;
+	BenchFormat ("bgra", bgraFrames, 4, false, part);
+	BenchFormat ("rgba", rgbaFrames, 4, true, part);
+	BenchFormat ("rgb565", rgb565Frames, 2, true, part);
+}
+
+int main (int argc, char** argv) {
+	string name = argc > 1 ? argv[1] : "all";
+	double seconds = argc > 2 ? atof (argv[2]) : 2.0;
+	if (name != "all" && name != "handoff" && name != "kernels" && name != "formats") {
+		fprintf (stderr, "usage: game_host_bench [handoff|kernels|formats|all] [seconds]\n");
+		return 1;
+	}
+
+	LOGI ("pixel kernels: %s, %ux%u pixels", PixelKernels::Get ().Name ().c_str (), s_width, s_height);
+
+	if (name == "all" || name == "handoff")
+		BenchHandoff (seconds);
+	if (name == "all" || name == "kernels")
+		BenchKernels (seconds);
+	if (name == "all" || name == "formats")
+		BenchFormats (seconds);
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+#include "../../pch.h"
+#include "hostcontentmanager.h"
+#include "../../management/simaudiobackend.h"
+#include "../../content/pngdecoder.h"
+
+HostContentManager::HostContentManager (const string& assetPath, const string& dataPath) :
+	mAssetPath (assetPath),
+	mDataPath (dataPath),
+	mNextSoundID (1) {
+	mPCMOutput.SetBackend (unique_ptr<IAudioBackend> (new NullAudioBackend (false)));
+}
+
+Image HostContentManager::LoadImage (const string& asset) {
+	vector<uint8_t> png = ReadWholeFile (mAssetPath + "/" + asset);
+
+	HostImage* image = new HostImage ();
+	if (png.empty () || !PNGDecoder::DecodeShared (&png[0], png.size (), image->pixels, image->width, image->height)) {
+		LOGE ("HostContentManager::LoadImage () - Cannot read image: %s", asset.c_str ());
+		delete image;
+		return nullptr;
+	}
+
+	return (Image) image;
+}
+
+void HostContentManager::UnloadImage (Image& image) {
+	delete (HostImage*) image;
+	image = nullptr;
+}
+
+const uint8_t* HostContentManager::LockPixels (Image image) {
+	CHECKMSG (image != nullptr, "HostContentManager::LockPixels () - image cannot be nullptr!");
+	return &((HostImage*) image)->pixels[0];
+}
+
+void HostContentManager::UnlockPixels (Image image) {
+	//Nothing to do, the pixels are always in memory
+}
+
+int HostContentManager::GetWidth (const Image image) const {
+	return image == nullptr ? 0 : ((const HostImage*) image)->width;
+}
+
+int HostContentManager::GetHeight (const Image image) const {
+	return image == nullptr ? 0 : ((const HostImage*) image)->height;
+}
+
+void HostContentManager::ReleaseImageThread () {
+	//Nothing to do, the images are loaded from files
+}
+
+vector<uint8_t> HostContentManager::ReadAsset (const string& asset) const {
+	return ReadWholeFile (mAssetPath + "/" + asset);
+}
+
+int HostContentManager::LoadSound (const string& asset) {
+	int soundID = mNextSoundID++;
+
+	HostSound& sound = mSounds[soundID];
+	sound.asset = asset;
+	sound.playing = false;
+	sound.looped = false;
+
+	return soundID;
+}
+
+void HostContentManager::UnloadSound (int soundID) {
+	mSounds.erase (soundID);
+}
+
+void HostContentManager::PlaySound (int soundID, float volume, bool looped) {
+	auto it = mSounds.find (soundID);
+	if (it != mSounds.end ()) {
+		it->second.playing = true;
+		it->second.looped = looped;
+	}
+}
+
+void HostContentManager::StopSound (int soundID) {
+	auto it = mSounds.find (soundID);
+	if (it != mSounds.end ())
+		it->second.playing = false;
+}
+
+bool HostContentManager::IsSoundEnded (int soundID) const {
+	//Nothing is played, so only the looped sounds last until they are stopped
+	auto it = mSounds.find (soundID);
+	return it == mSounds.end () || !it->second.playing || !it->second.looped;
+}
+
+void HostContentManager::OpenPCM (float volume, int numChannels, int sampleRate, int bytesPerSec, int deviceBufferFrames, int deviceBufferCount) {
+	mPCMOutput.Open (volume, numChannels, sampleRate, bytesPerSec, deviceBufferFrames, deviceBufferCount);
+}
+
+void HostContentManager::ClosePCM () {
+	mPCMOutput.Close ();
+}
+
+bool HostContentManager::IsOpenedPCM () const {
+	return mPCMOutput.IsOpened ();
+}
+
+void HostContentManager::SetPCMStream (PCMStream* stream) {
+	mPCMOutput.SetStream (stream);
+}
+
+PCMStats HostContentManager::GetPCMStats () const {
+	return mPCMOutput.GetStats ();
+}
+
+void HostContentManager::WritePCM (const uint8_t* buffer, size_t size, const PCMStamp& stamp) {
+	mPCMOutput.Write (buffer, size, stamp);
+}
+
+string HostContentManager::ReadTextFile (const string& fileName) const {
+	vector<uint8_t> content = ReadWholeFile (mDataPath + "/" + fileName);
+	return string (content.begin (), content.end ());
+}
+
+void HostContentManager::WriteTextFile (const string& fileName, const string& content, bool append) {
+	WriteFile (fileName, vector<uint8_t> (content.begin (), content.end ()), append);
+}
+
+vector<uint8_t> HostContentManager::ReadFile (const string& fileName) const {
+	return ReadWholeFile (mDataPath + "/" + fileName);
+}
+
+void HostContentManager::WriteFile (const string& fileName, const vector<uint8_t>& content, bool append) {
+	string path = mDataPath + "/" + fileName;
+	ofstream file (path, ios::binary | (append ? ios::app : ios::trunc));
+	CHECKARG (file.good (), "HostContentManager::WriteFile () - Cannot open file: %s", path.c_str ());
+
+	if (!content.empty ())
+		file.write ((const char*) &content[0], content.size ());
+}
+
+void HostContentManager::DisplayStatus (const string& status) const {
+	LOGI ("status: %s", status.c_str ());
+}
+
+void HostContentManager::Log (const string& log) {
+	LOGD ("%s", log.c_str ());
+}
+
+double HostContentManager::GetTime () const {
+	timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+vector<uint8_t> HostContentManager::ReadWholeFile (const string& path) {
+	ifstream file (path, ios::binary);
+	if (!file.good ()) //Missing files are empty (like on the device)
+		return vector<uint8_t> ();
+
+	return vector<uint8_t> ((istreambuf_iterator<char> (file)), istreambuf_iterator<char> ());
+}
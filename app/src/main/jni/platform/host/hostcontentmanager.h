@@ -0,0 +1,93 @@
+#pragma once
+
+#include "../../management/IContentManager.h"
+#include "../../management/pcmoutput.h"
+
+///
+/// Content manager of the host (desktop) build.
+///
+/// Images are decoded by the native PNG decoder of the device, so the pixels, texture sizes and uploads match it.
+/// Sounds are only counted, the PCM output is the pipeline of the device on a simulated audio backend (a driven null
+/// backend by default).
+class HostContentManager : public IContentManager {
+//Definitions
+private:
+	struct HostImage {
+		int width;
+		int height;
+		vector<uint8_t> pixels; ///< RGBA
+	};
+
+	struct HostSound {
+		string asset;
+		bool playing;
+		bool looped;
+	};
+
+//Data
+private:
+	string mAssetPath; ///< The root of the assets (app/src/main/assets).
+	string mDataPath; ///< The directory of the read/write files.
+
+	map<int, HostSound> mSounds;
+	int mNextSoundID;
+
+	PCMOutput mPCMOutput;
+
+//Construction
+public:
+	HostContentManager (const string& assetPath, const string& dataPath);
+
+//Image interface
+public:
+	virtual Image LoadImage (const string& asset) override;
+	virtual void UnloadImage (Image& image) override;
+
+	virtual const uint8_t* LockPixels (Image image) override;
+	virtual void UnlockPixels (Image image) override;
+	virtual int GetWidth (const Image image) const override;
+	virtual int GetHeight (const Image image) const override;
+	virtual void ReleaseImageThread () override;
+	virtual vector<uint8_t> ReadAsset (const string& asset) const override;
+
+//Sound interface
+public:
+	virtual int LoadSound (const string& asset) override;
+	virtual void UnloadSound (int soundID) override;
+
+	virtual void PlaySound (int soundID, float volume, bool looped) override;
+	virtual void StopSound (int soundID) override;
+	virtual bool IsSoundEnded (int soundID) const override;
+
+//PCM sound interface
+public:
+	virtual void OpenPCM (float volume, int numChannels, int sampleRate, int bytesPerSec, int deviceBufferFrames, int deviceBufferCount) override;
+	virtual void ClosePCM () override;
+	virtual bool IsOpenedPCM () const override;
+
+	virtual void SetPCMStream (PCMStream* stream) override;
+	virtual PCMStats GetPCMStats () const override;
+	virtual void WritePCM (const uint8_t* buffer, size_t size, const PCMStamp& stamp) override;
+
+	/// Replace the audio backend (call it only while the PCM output is closed).
+	void SetAudioBackend (unique_ptr<IAudioBackend>&& backend) {
+		mPCMOutput.SetBackend (move (backend));
+	}
+
+//Utility interface
+public:
+	virtual string ReadTextFile (const string& fileName) const override;
+	virtual void WriteTextFile (const string& fileName, const string& content, bool append) override;
+
+	virtual vector<uint8_t> ReadFile (const string& fileName) const override;
+	virtual void WriteFile (const string& fileName, const vector<uint8_t>& content, bool append) override;
+
+	virtual void DisplayStatus (const string& status) const override;
+
+	virtual void Log (const string& log) override;
+	virtual double GetTime () const override;
+
+//Helper methods
+private:
+	static vector<uint8_t> ReadWholeFile (const string& path);
+};
@@ -0,0 +1,193 @@
+#include "../../pch.h"
+#include "hostemulator.h"
+#include "hostcontentmanager.h"
+#include "../../engine.h"
+#include "../../game/mayhemgame.h"
+
+engine_s g_engine; ///< The one and only global object of the game!
+
+static uint32_t s_key_events = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Emulator functions used by the game
+////////////////////////////////////////////////////////////////////////////////////////////////////
+extern "C" void keyboard_key_pressed (signed long key) {
+	++s_key_events;
+}
+
+extern "C" void keyboard_key_released (signed long key) {
+	++s_key_events;
+}
+
+extern "C" void keyboard_key_clear () {
+}
+
+extern "C" void vsync_suspend_speed_eval () {
+}
+
+extern "C" void machine_trigger_reset (const unsigned int reset_mode) {
+}
+
+extern "C" int autostart_disk (const char *file_name, const char *program_name, unsigned int program_number, unsigned int runmode) {
+	return 0;
+}
+
+extern "C" int ui_quicksnapshot_load () {
+	return 1; //The game starts from the snapshot (skips the demo and the hack screen)
+}
+
+extern "C" void ui_quicksnapshot_remove () {
+}
+
+extern "C" void ui_quicksnapshot_save () {
+}
+
+extern "C" int resources_set_int (const char *name, int value) {
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// HostEmulator implementation
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void HostEmulator::InitEngine () {
+	g_engine.lastUpdateTime = -1;
+	g_engine.is_warp = true;
+	g_engine.is_paused = false;
+
+	g_engine.canvas_inited = false;
+	g_engine.canvas_width = 0;
+	g_engine.canvas_height = 0;
+	g_engine.canvas_bit_per_pixel = 0;
+	g_engine.canvas_pitch = 0;
+	g_engine.canvas_format = CANVAS_FORMAT_BGRA8888;
+
+	g_engine.visible_width = 0;
+	g_engine.visible_height = 0;
+
+	g_engine.deviceSamplingRate = 48000;
+	g_engine.deviceBufferFrames = 256;
+	g_engine.deviceBufferCount = 4;
+	g_engine.pcm_tuner.Init (g_engine.deviceSamplingRate, g_engine.deviceBufferFrames, g_engine.deviceBufferCount);
+	g_engine.pcm_sampleRate = 0;
+	g_engine.pcm_bytesPerSec = 0;
+	g_engine.pcm_numChannels = 0;
+
+	g_engine.pcm.Reset (64 * 1024);
+
+	s_key_events = 0;
+}
+
+void HostEmulator::InitCanvas (uint32_t format, uint32_t width, uint32_t height, uint32_t visible_width, uint32_t visible_height) {
+	uint32_t bpp = format == CANVAS_FORMAT_RGB565 ? 16 : 32;
+	uint32_t bytePerPixel = bpp / 8;
+
+	g_engine.canvas_width = width;
+	g_engine.canvas_height = height;
+	g_engine.canvas_bit_per_pixel = bpp;
+	g_engine.canvas_pitch = width * bytePerPixel;
+	g_engine.canvas_format = format;
+
+	g_engine.visible_width = visible_width;
+	g_engine.visible_height = visible_height;
+
+	g_engine.canvas.assign (g_engine.canvas_pitch * height, 0);
+	g_engine.canvas_frames.Resize (g_engine.canvas_pitch * visible_height);
+	g_engine.frame_barrier.Reset ();
+
+	g_engine.canvas_inited = true;
+}
+
+void HostEmulator::RenderSolidFrame (uint8_t red, uint8_t green, uint8_t blue) {
+	uint32_t bytePerPixel = g_engine.canvas_bit_per_pixel / 8;
+	for (uint32_t y = 0; y < g_engine.visible_height; ++y) {
+		uint8_t* row = &g_engine.canvas[y * g_engine.canvas_pitch];
+		for (uint32_t x = 0; x < g_engine.visible_width; ++x)
+			WritePixel (row + x * bytePerPixel, red, green, blue);
+	}
+
+	Publish ();
+}
+
+void HostEmulator::RenderMovingFrame (uint32_t frameIndex, uint32_t changedRows) {
+	//Restore the rows of the previous band, then draw the band at its new position
+	uint32_t bytePerPixel = g_engine.canvas_bit_per_pixel / 8;
+	uint32_t height = g_engine.visible_height;
+	uint32_t prevStart = frameIndex > 0 ? (frameIndex - 1) * changedRows % height : height;
+	uint32_t start = frameIndex * changedRows % height;
+
+	for (uint32_t i = 0; i < changedRows && i < height; ++i) {
+		if (prevStart < height) {
+			uint8_t* prevRow = &g_engine.canvas[((prevStart + i) % height) * g_engine.canvas_pitch];
+			for (uint32_t x = 0; x < g_engine.visible_width; ++x)
+				WritePixel (prevRow + x * bytePerPixel, 0, 0, 0);
+		}
+	}
+
+	for (uint32_t i = 0; i < changedRows && i < height; ++i) {
+		uint8_t* row = &g_engine.canvas[((start + i) % height) * g_engine.canvas_pitch];
+		for (uint32_t x = 0; x < g_engine.visible_width; ++x)
+			WritePixel (row + x * bytePerPixel, (uint8_t) (x + frameIndex), (uint8_t) (i * 16), 0xA0);
+	}
+
+	Publish ();
+}
+
+void HostEmulator::InitSound (uint32_t numChannels, uint32_t sampleRate) {
+	g_engine.pcm_sampleRate = sampleRate;
+	g_engine.pcm_bytesPerSec = sampleRate * numChannels * 2;
+	g_engine.pcm_numChannels = numChannels;
+
+	g_engine.pcm.Discard ();
+}
+
+void HostEmulator::WriteSoundFrame (uint32_t frameIndex, uint64_t time) {
+	uint32_t frameSize = g_engine.pcm_numChannels * 2;
+	uint32_t sampleCount = g_engine.pcm_sampleRate / 50;
+	if (frameSize == 0 || sampleCount == 0)
+		return;
+
+	static vector<uint8_t> pcm;
+	pcm.resize (sampleCount * frameSize);
+
+	int16_t* samples = (int16_t*) &pcm[0];
+	for (uint32_t i = 0; i < sampleCount; ++i) {
+		uint32_t time = frameIndex * sampleCount + i;
+		int16_t value = (time / 50) % 2 ? 4096 : -4096;
+		for (uint32_t channel = 0; channel < g_engine.pcm_numChannels; ++channel)
+			*samples++ = value;
+	}
+
+	PCMStamp stamp = { time, g_engine.emulator_frame };
+	g_engine.pcm.Write (&pcm[0], (uint32_t) pcm.size (), stamp);
+}
+
+uint32_t HostEmulator::KeyEventCount () {
+	return s_key_events;
+}
+
+void HostEmulator::WritePixel (uint8_t* dest, uint8_t red, uint8_t green, uint8_t blue) {
+	switch (g_engine.canvas_format) {
+	case CANVAS_FORMAT_RGBA8888:
+		dest[0] = red;
+		dest[1] = green;
+		dest[2] = blue;
+		dest[3] = 0xFF;
+		break;
+	case CANVAS_FORMAT_RGB565:
+		*(uint16_t*) dest = (uint16_t) ((red >> 3) << 11 | (green >> 2) << 5 | (blue >> 3));
+		break;
+	default: //BGRA
+		dest[0] = blue;
+		dest[1] = green;
+		dest[2] = red;
+		dest[3] = 0xFF;
+		break;
+	}
+}
+
+void HostEmulator::Publish () {
+	//Same as UnlockCanvas in jni_GameLib.cpp
+	memcpy (g_engine.canvas_frames.WriteBuffer (), &g_engine.canvas[0], g_engine.canvas_frames.Size ());
+	g_engine.canvas_frames.Publish (g_engine.emulator_frame);
+	++g_engine.emulator_frame;
+}
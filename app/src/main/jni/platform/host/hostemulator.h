@@ -0,0 +1,38 @@
+#pragma once
+
+///
+/// Stand-in for the C64 emulator in the host (desktop) build.
+///
+/// Provides the emulator functions called by the game code and produces synthetic frames
+/// on the canvas of g_engine the same way, as the emulator callbacks of jni_GameLib.cpp do.
+class HostEmulator {
+//Interface
+public:
+	/// Reset the engine state (like GameLib.init).
+	static void InitEngine ();
+
+	/// Set up the canvas (like the init canvas callback of the emulator).
+	static void InitCanvas (uint32_t format, uint32_t width, uint32_t height, uint32_t visible_width, uint32_t visible_height);
+
+	/// Render a frame filled with one color and publish it to the game thread.
+	static void RenderSolidFrame (uint8_t red, uint8_t green, uint8_t blue);
+
+	/// Render a frame, where a band of changedRows rows moves with the frame index (like a scrolling sprite), and publish it.
+	static void RenderMovingFrame (uint32_t frameIndex, uint32_t changedRows);
+
+	/// Set up the sound format (like the sound init callback of the emulator).
+	static void InitSound (uint32_t numChannels, uint32_t sampleRate);
+
+	/// Write one frame (1/50 s) of 16 bit PCM (a square wave) to the sound stream (like the sound write callback). The sound is
+	/// stamped with time (the clock of the audio backend, so a driven backend measures the latency in its own time) and with the
+	/// emulator frame (write it before rendering the frame: the sound written before a frame is published belongs to it).
+	static void WriteSoundFrame (uint32_t frameIndex, uint64_t time);
+
+	/// The count of the keyboard events sent by the game.
+	static uint32_t KeyEventCount ();
+
+//Helper methods
+private:
+	static void WritePixel (uint8_t* dest, uint8_t red, uint8_t green, uint8_t blue);
+	static void Publish ();
+};
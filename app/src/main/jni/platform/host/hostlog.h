@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdarg.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//Macro definitions (same as in jnihelper/jniload.h, but written to the console)
+//////////////////////////////////////////////////////////////////////////////////////////
+#define LOG_TAG "Mayhem"
+#define LOGI(...)  host_log_print ("I", LOG_TAG, __VA_ARGS__)
+#define LOGD(...)  host_log_print ("D", LOG_TAG, __VA_ARGS__)
+#define LOGE(...)  host_log_print ("E", LOG_TAG, __VA_ARGS__)
+
+#define CHECKMSG(check, msg)								\
+	if (!(check)) {											\
+		LOGE ("Assertion occured! message: %s", msg);		\
+		assert (check);										\
+	}
+
+#define CHECK(check)	CHECKMSG (check, "nothing")
+
+#define CHECKARG(check, ...)								\
+	if (!(check)) {											\
+		LOGE ("Assertion occured!");						\
+		LOGE (__VA_ARGS__);									\
+		assert (check);										\
+	}
+
+inline void host_log_print (const char* level, const char* tag, const char* format, ...) __attribute__ ((format (printf, 3, 4)));
+inline void host_log_print (const char* level, const char* tag, const char* format, ...) {
+	fprintf (stderr, "%s/%s: ", level, tag);
+
+	va_list args;
+	va_start (args, format);
+	vfprintf (stderr, format, args);
+	va_end (args);
+
+	fputc ('\n', stderr);
+}
@@ -0,0 +1,197 @@
+#include "../../pch.h"
+#include "hostcontentmanager.h"
+#include "hostemulator.h"
+#include "../../engine.h"
+#include "../../game/mayhemgame.h"
+#include "../../content/pixelkernels.h"
+#include "../../content/spritebatch.h"
+#include "../../content/geometryregistry.h"
+#include "../../content/texturecache.h"
+#include "../../content/textureloader.h"
+#include "../../management/frametimer.h"
+#include "../../management/simaudiobackend.h"
+#include "../../management/avsync.h"
+#include "../../management/glstate.h"
+
+extern engine_s g_engine;
+
+#ifndef GAME_HOST_ASSET_PATH
+#	define GAME_HOST_ASSET_PATH "assets"
+#endif //GAME_HOST_ASSET_PATH
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Headless runner of the game: drives Update/Render with synthetic emulator frames and reports the
+// time spent in the game code, the recorded GL work per frame and the latency of the emulator sound.
+//
+// usage: game_host_runner [frame count] [bgra|rgba|rgb565] [changed rows per frame] [null|realtime|<file.wav>] [batch|nobatch] [filter|nofilter] [async|sync] [etc1|rgba]
+//
+// The PCM output plays on a simulated audio device: "null" (default) and a WAV file path are driven by the frames
+// (1/50 s each), so the output is bit-exact the same in each run, "realtime" plays by the steady clock. The meshes
+// are drawn by the sprite batch ("batch", default) or one by one ("nobatch"), the redundant GL state calls are filtered
+// ("filter", default) or issued ("nofilter"). The image assets are decoded by the worker threads of the texture loader
+// ("async", default) or at once on the GL thread ("sync"). The ETC1 containers of the image assets are uploaded
+// ("etc1", default) or the PNG images ("rgba").
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t ParseFormat (const string& name) {
+	if (name == "rgba")
+		return CANVAS_FORMAT_RGBA8888;
+	if (name == "rgb565")
+		return CANVAS_FORMAT_RGB565;
+	return CANVAS_FORMAT_BGRA8888;
+}
+
+static uint64_t AudioClock (void* context) {
+	return ((SimulatedAudioBackend*) context)->Now ();
+}
+
+static double Now () {
+	timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec / 1e9;
+}
+
+int main (int argc, char** argv) {
+	uint32_t frameCount = argc > 1 ? (uint32_t) atoi (argv[1]) : 600;
+	uint32_t format = ParseFormat (argc > 2 ? argv[2] : "bgra");
+	uint32_t changedRows = argc > 3 ? (uint32_t) atoi (argv[3]) : 16;
+	string audioSink = argc > 4 ? argv[4] : "null";
+	SpriteBatch::SetEnabled (argc > 5 ? string (argv[5]) != "nobatch" : true);
+	GLState::SetEnabled (argc > 6 ? string (argv[6]) != "nofilter" : true);
+	TextureLoader::SetEnabled (argc > 7 ? string (argv[7]) != "sync" : true);
+	TextureLoader::SetETC1Enabled (argc > 8 ? string (argv[8]) != "rgba" : true);
+
+	//The size of the C64 screen (PAL) and a landscape phone
+	const uint32_t canvasWidth = 384;
+	const uint32_t canvasHeight = 272;
+	const int screenWidth = 1920;
+	const int screenHeight = 1080;
+
+	HostEmulator::InitEngine ();
+	HostContentManager* contentManager = new HostContentManager (GAME_HOST_ASSET_PATH, ".");
+	g_engine.contentManager.reset (contentManager);
+	g_engine.pcm_tuner.Load (*contentManager); //The buffer configuration learned in the working directory (like GameLib.init)
+
+	SimulatedAudioBackend* audio = nullptr;
+	if (audioSink == "null" || audioSink == "realtime")
+		audio = new NullAudioBackend (audioSink == "realtime");
+	else
+		audio = new WAVAudioBackend (audioSink, false);
+	contentManager->SetAudioBackend (unique_ptr<IAudioBackend> (audio));
+	AVSync::Get ().SetClock (&AudioClock, audio); //The frames are presented in the time of the audio device
+	g_engine.pointerIDs.reset (new set<int32_t> ());
+
+	g_engine.game.reset (new MayhemGame (*g_engine.contentManager));
+	double initStart = Now ();
+	g_engine.game->Init (screenWidth, screenHeight, 2392, 1440);
+	double initTime = Now () - initStart;
+
+	HostEmulator::InitCanvas (format, canvasWidth, canvasHeight, canvasWidth, canvasHeight);
+	HostEmulator::InitSound (2, 44100);
+
+	LOGI ("pixel kernels: %s, frames: %u, changed rows: %u, audio: %s, sprite batch: %s, gl state filter: %s, texture loads: %s, textures: %s", PixelKernels::Get ().Name ().c_str (),
+		  frameCount, changedRows, audio->Name (), SpriteBatch::IsEnabled () ? "on" : "off", GLState::IsEnabled () ? "on" : "off",
+		  TextureLoader::IsEnabled () ? "async" : "sync", TextureLoader::IsETC1Enabled () ? "etc1" : "rgba");
+
+	//Load phase: a bright screen lets the game load the snapshot and enter the game state
+	const uint32_t loadFrameCount = 4;
+	double loadMaxTime = 0;
+	for (uint32_t i = 0; i < loadFrameCount; ++i) {
+		HostEmulator::RenderSolidFrame (0xFF, 0xFF, 0xFF);
+
+		double start = Now ();
+		g_engine.game->Update (1.0f / 50.0f);
+		g_engine.game->Render ();
+		loadMaxTime = max (loadMaxTime, Now () - start);
+	}
+
+	LOGI ("init: %.2f ms", initTime * 1e3);
+	LOGI ("load phase: max frame %.2f ms, texture loader: %s", loadMaxTime * 1e3, TextureLoader::Get ().ToJSON ().c_str ());
+
+	//Game phase: measured
+	GLShim& gl = GLShim::Get ();
+	gl.ResetStats ();
+	GLState::Get ().ResetStats ();
+	FrameTimer::Get ().Reset ();
+	g_engine.pcm.ResetLatency ();
+	AVSync::Get ().Reset ();
+
+	double totalTime = 0;
+	double maxTime = 0;
+	chrono::steady_clock::time_point frameStart = chrono::steady_clock::now ();
+	for (uint32_t i = 0; i < frameCount; ++i) {
+		HostEmulator::WriteSoundFrame (i, audio->Now ());
+		HostEmulator::RenderMovingFrame (i, changedRows);
+
+		double start = Now ();
+		{
+			FramePhaseTimer timer (FramePhase::Update);
+			g_engine.game->Update (1.0f / 50.0f);
+		}
+		{
+			FramePhaseTimer timer (FramePhase::Render);
+			g_engine.game->Render ();
+		}
+		double frameTime = Now () - start;
+
+		totalTime += frameTime;
+		maxTime = max (maxTime, frameTime);
+
+		if (audio->IsRealTime ()) //The emulator runs at 50 Hz
+			this_thread::sleep_until (frameStart + chrono::microseconds (20000 * (i + 1)));
+		else //The device plays the frame
+			audio->Advance (1000000000ull / 50);
+	}
+
+	const GLShim::Stats& stats = gl.GetStats ();
+	double frames = frameCount > 0 ? (double) frameCount : 1.0;
+	LOGI ("update + render: avg %.1f us, max %.1f us", totalTime / frames * 1e6, maxTime * 1e6);
+	LOGI ("GL per frame: calls %.1f, state calls %.1f, texture binds %.1f, draws %.1f, vertices %.1f",
+		  stats.calls / frames, stats.stateCalls / frames, stats.textureBinds / frames, stats.drawCalls / frames, stats.drawnVertices / frames);
+	LOGI ("GL uploads per frame: textures %.2f (%.0f bytes), buffers %.0f bytes",
+		  stats.textureUploads / frames, stats.textureUploadBytes / frames, stats.bufferUploadBytes / frames);
+	LOGI ("GL state calls (issued, filtered): %s", GLState::Get ().ToJSON ().c_str ());
+	LOGI ("live textures: %zu (%zu bytes)", gl.TextureCount (), gl.TextureBytes ());
+
+	GeometryRegistry::Stats geometryStats = GeometryRegistry::Get ().GetStats ();
+	LOGI ("live buffers: %zu, shared geometry: buffers %u, references %u, hits %llu, misses %llu", gl.BufferCount (), geometryStats.bufferCount,
+		  geometryStats.referenceCount, (unsigned long long) geometryStats.hitCount, (unsigned long long) geometryStats.missCount);
+	LOGI ("frame phases: %s", FrameTimer::Get ().ToJSON ().c_str ());
+	LOGI ("pcm latency (emulator write to device): %s", g_engine.pcm.LatencyToJSON ().c_str ());
+
+	PCMStats pcmStats = contentManager->GetPCMStats ();
+	LOGI ("pcm output: played %llu bytes, callbacks %u, underruns %u, overruns %u, starved %u, jitter mean %.1f us, queue depth %.2f, fill %.1f ms, ratio %.5f",
+		  (unsigned long long) audio->PlayedBytes (), pcmStats.callbackCount, pcmStats.underrunCount, pcmStats.overrunCount, audio->StarveCount (),
+		  pcmStats.jitterMeanMicros, pcmStats.queueDepthMean, pcmStats.fillMeanMillis, pcmStats.ratio);
+	LOGI ("a/v sync (sound start - frame presentation): %s", AVSync::Get ().ToJSON ().c_str ());
+
+	//Rotation: the layouts are rebuilt twice, the second time from the cached textures
+	TextureCache::Get ().ResetStats ();
+	TextureLoader::Get ().ResetStats ();
+	double rotationTimes[3];
+	for (int i = 0; i < 3; ++i) {
+		bool portrait = i % 2 == 0;
+		double start = Now ();
+		g_engine.game->Resize (portrait ? screenHeight : screenWidth, portrait ? screenWidth : screenHeight);
+		g_engine.game->Render ();
+		rotationTimes[i] = Now () - start;
+	}
+
+	//The frames until the textures of the new layouts are uploaded (the placeholders are drawn till then)
+	uint32_t pendingFrameCount = 0;
+	while (TextureLoader::Get ().GetStats ().pendingCount > 0) {
+		this_thread::sleep_for (chrono::milliseconds (20));
+		g_engine.game->Render ();
+		++pendingFrameCount;
+	}
+
+	LOGI ("rotation: portrait %.2f ms, landscape %.2f ms, portrait %.2f ms, texture cache: %s", rotationTimes[0] * 1e3, rotationTimes[1] * 1e3,
+		  rotationTimes[2] * 1e3, TextureCache::Get ().ToJSON ().c_str ());
+	LOGI ("texture loader: frames to upload %u, %s", pendingFrameCount, TextureLoader::Get ().ToJSON ().c_str ());
+
+	TextureLoader::Get ().Shutdown (); //The workers release their threads by the content manager of the game
+	g_engine.game->Shutdown ();
+	g_engine.game.reset ();
+	AVSync::Get ().SetClock (nullptr, nullptr);
+	g_engine.contentManager.reset ();
+	return 0;
+}
@@ -0,0 +1,94 @@
+#include "../../../pch.h"
+#include "../../../management/bytering.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Two thread stress test of the byte ring (host build, ctest).
+//
+// The producer writes words holding their own stream position, so the consumer can check each word it reads against
+// the read position. The stream runs over 2^32 bytes (the positions wrap around), with discards only at the start:
+// the discard position is left more than 2^31 bytes behind, where a signed distance to it changes its sign.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static const uint32_t s_capacity = 64 * 1024;
+static const uint32_t s_write_size = 4096;
+static const uint32_t s_read_size = 16384;
+static const uint64_t s_total_bytes = (1ull << 32) + (1ull << 24);
+static const uint64_t s_discard_bytes = 1ull << 24; ///< The discards are in this first part of the stream.
+
+int main (int argc, char** argv) {
+	ByteRing ring;
+	ring.Reset (s_capacity);
+
+	atomic<bool> done (false);
+	atomic<bool> failed (false);
+
+	thread producer ([&] () {
+		vector<uint32_t> words (s_write_size / 4);
+		uint64_t written = 0;
+		uint32_t discardCount = 0;
+		while (written < s_total_bytes && !failed.load (memory_order_relaxed)) {
+			uint32_t pos = ring.WritePosition ();
+			for (size_t i = 0; i < words.size (); ++i)
+				words[i] = pos + (uint32_t) i * 4;
+
+			uint32_t count = ring.Write ((const uint8_t*) &words[0], s_write_size);
+			if (count == 0)
+				this_thread::yield ();
+			written += count;
+
+			if (written < s_discard_bytes && (written / s_write_size) % 997 == 0) {
+				ring.Discard ();
+				++discardCount;
+			}
+		}
+
+		LOGI ("producer: %llu bytes, %u discards, overflow %llu bytes", (unsigned long long) written, discardCount, (unsigned long long) ring.OverflowBytes ());
+		done.store (true, memory_order_release);
+	});
+
+	uint64_t readBytes = 0;
+	while (!failed.load (memory_order_relaxed)) {
+		bool finished = done.load (memory_order_acquire);
+
+		uint32_t available = ring.Available ();
+		if (available > ring.Capacity ()) {
+			LOGE ("available %u bytes over the capacity after %llu bytes", available, (unsigned long long) readBytes);
+			failed.store (true, memory_order_relaxed);
+			break;
+		}
+
+		uint32_t pos = ring.ReadPosition ();
+		uint32_t count = ring.Read (s_read_size, [&] (const uint8_t* data, uint32_t size) {
+			if ((pos | size) % 4 != 0) {
+				LOGE ("unaligned read: position %u, size %u", pos, size);
+				failed.store (true, memory_order_relaxed);
+				return;
+			}
+
+			const uint32_t* words = (const uint32_t*) data;
+			for (uint32_t i = 0; i < size / 4; ++i, pos += 4) {
+				if (words[i] != pos) {
+					LOGE ("stale data after %llu bytes: position %u, word %u", (unsigned long long) readBytes, pos, words[i]);
+					failed.store (true, memory_order_relaxed);
+					return;
+				}
+			}
+		});
+
+		readBytes += count;
+		if (count == 0) {
+			if (finished)
+				break;
+			this_thread::yield ();
+		}
+	}
+
+	producer.join ();
+
+	if (failed.load (memory_order_relaxed)) {
+		LOGE ("bytering test: FAILED");
+		return 1;
+	}
+
+	LOGI ("bytering test: passed, read %llu bytes", (unsigned long long) readBytes);
+	return 0;
+}
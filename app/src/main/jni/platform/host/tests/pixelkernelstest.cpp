@@ -0,0 +1,117 @@
+#include "../../../pch.h"
+#include "../../../content/pixelkernels.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test of the SIMD pixel kernels (host build, ctest).
+//
+// The kernels selected for the running CPU are compared with the scalar ones: the converted pixels, the change flag and
+// the channel sums have to be exactly the same. Every length up to a few vectors covers the remainder handling, the
+// screen sized images of saturated and random pixels cover the width of the sum accumulators.
+//
+// The RGB565 sums are compared with a per pixel sum of the channels expanded to 8 bits, also at the extreme values
+// (0x0000: 0, 0xFFFF: 255 in each channel).
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static uint32_t s_failure_count = 0;
+
+static void Check (bool condition, const char* kernel, uint32_t pixelCount, const char* pattern) {
+	if (!condition) {
+		LOGE ("%s mismatch: %u pixels of %s", kernel, pixelCount, pattern);
+		++s_failure_count;
+	}
+}
+
+static void Compare (const PixelKernels& kernels, const vector<uint8_t>& src, uint32_t pixelCount, const char* pattern) {
+	vector<uint8_t> expected (pixelCount * 4 + 4, 0);
+	vector<uint8_t> result (pixelCount * 4 + 4, 0);
+
+	bool expectedChanged = PixelKernels::ConvertBGRA_Scalar (&src[0], &expected[0], pixelCount);
+	bool changed = kernels.ConvertBGRA (&src[0], &result[0], pixelCount);
+	Check (changed == expectedChanged && result == expected, "ConvertBGRA", pixelCount, pattern);
+	Check (!kernels.ConvertBGRA (&src[0], &result[0], pixelCount), "ConvertBGRA (unchanged)", pixelCount, pattern);
+
+	uint32_t expectedSums[3] = { 7, 11, 13 }; //The sums are added to the values
+	uint32_t sums[3] = { 7, 11, 13 };
+	fill (result.begin (), result.end (), 0);
+	PixelKernels::ConvertBGRASum_Scalar (&src[0], &expected[0], pixelCount, expectedSums);
+	kernels.ConvertBGRASum (&src[0], &result[0], pixelCount, sums);
+	Check (result == expected && memcmp (sums, expectedSums, sizeof (sums)) == 0, "ConvertBGRASum", pixelCount, pattern);
+
+	uint32_t expectedRGBASums[3] = { 7, 11, 13 };
+	uint32_t rgbaSums[3] = { 7, 11, 13 };
+	PixelKernels::SumRGBA_Scalar (&src[0], pixelCount, expectedRGBASums);
+	kernels.SumRGBA (&src[0], pixelCount, rgbaSums);
+	Check (memcmp (rgbaSums, expectedRGBASums, sizeof (rgbaSums)) == 0, "SumRGBA", pixelCount, pattern);
+}
+
+/// The straightforward sum of the little endian RGB565 pixels (the 5 and 6 bit channels expanded by replicating their high bits).
+static void SumRGB565_Reference (const uint8_t* src, uint32_t pixelCount, uint32_t* sums) {
+	for (uint32_t i = 0; i < pixelCount; ++i) {
+		uint32_t pixel = (uint32_t) src[i * 2] | (uint32_t) src[i * 2 + 1] << 8;
+		uint32_t red = pixel >> 11;
+		uint32_t green = (pixel >> 5) & 0x3F;
+		uint32_t blue = pixel & 0x1F;
+
+		sums[0] += (red << 3) | (red >> 2);
+		sums[1] += (green << 2) | (green >> 4);
+		sums[2] += (blue << 3) | (blue >> 2);
+	}
+}
+
+static void CompareRGB565 (const PixelKernels& kernels, const vector<uint8_t>& src, uint32_t pixelCount, const char* pattern) {
+	uint32_t expectedSums[3] = { 7, 11, 13 };
+	uint32_t sums[3] = { 7, 11, 13 };
+	SumRGB565_Reference (&src[0], pixelCount, expectedSums);
+	kernels.SumRGB565 (&src[0], pixelCount, sums);
+	Check (memcmp (sums, expectedSums, sizeof (sums)) == 0, "SumRGB565", pixelCount, pattern);
+}
+
+int main (int argc, char** argv) {
+	const PixelKernels& kernels = PixelKernels::Get ();
+
+	//The C64 screen (PAL) with the borders
+	const uint32_t screenPixelCount = 384 * 272;
+
+	vector<uint8_t> random (screenPixelCount * 4);
+	uint32_t seed = 0x12345678;
+	for (auto& value : random) {
+		seed = seed * 1664525u + 1013904223u;
+		value = (uint8_t) (seed >> 24);
+	}
+
+	vector<uint8_t> saturated (screenPixelCount * 4, 0xFF);
+	vector<uint8_t> black (screenPixelCount * 4, 0x00);
+
+	for (uint32_t pixelCount = 0; pixelCount <= 259; ++pixelCount) {
+		Compare (kernels, random, pixelCount, "random");
+		Compare (kernels, saturated, pixelCount, "saturated");
+
+		CompareRGB565 (kernels, random, pixelCount, "random");
+		CompareRGB565 (kernels, saturated, pixelCount, "saturated");
+		CompareRGB565 (kernels, black, pixelCount, "black");
+	}
+
+	Compare (kernels, random, 384, "random");
+	Compare (kernels, random, screenPixelCount, "random");
+	Compare (kernels, saturated, screenPixelCount, "saturated");
+
+	CompareRGB565 (kernels, random, 383, "random");
+	CompareRGB565 (kernels, random, screenPixelCount, "random");
+	CompareRGB565 (kernels, saturated, screenPixelCount, "saturated");
+
+	//The extremes of the format (0xFFFF: white, 0x0000: black)
+	uint32_t whiteSums[3] = { 0, 0, 0 };
+	kernels.SumRGB565 (&saturated[0], 3, whiteSums);
+	Check (whiteSums[0] == 3 * 255 && whiteSums[1] == 3 * 255 && whiteSums[2] == 3 * 255, "SumRGB565 (white)", 3, "saturated");
+
+	uint32_t blackSums[3] = { 7, 11, 13 };
+	kernels.SumRGB565 (&black[0], 3, blackSums);
+	Check (blackSums[0] == 7 && blackSums[1] == 11 && blackSums[2] == 13, "SumRGB565 (black)", 3, "black");
+
+	if (s_failure_count > 0) {
+		LOGE ("pixel kernels test (%s): FAILED, %u mismatches", kernels.Name ().c_str (), s_failure_count);
+		return 1;
+	}
+
+	LOGI ("pixel kernels test (%s): passed", kernels.Name ().c_str ());
+	return 0;
+}
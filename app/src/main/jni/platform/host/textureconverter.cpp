@@ -0,0 +1,85 @@
+#include "../../pch.h"
+#include "etc1encoder.h"
+#include "../../content/etc1texture.h"
+#include "../../content/pngdecoder.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Converts a PNG image asset into the ETC1 container of the texture loader (<asset>.etc1).
+//
+// usage: texture_converter [-flatten] <input.png> <output.etc1>
+//
+// The pixels are premultiplied by the PNG decoder of the game. The images with transparent pixels get an alpha plane,
+// "-flatten" composites them over the black clear color of the game instead (the anti-aliased edges of the nearly
+// opaque backgrounds), so they are stored without the alpha plane.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+static vector<uint8_t> ReadWholeFile (const string& path) {
+	ifstream file (path, ios::binary);
+	return vector<uint8_t> ((istreambuf_iterator<char> (file)), istreambuf_iterator<char> ());
+}
+
+/// The peak signal to noise ratio of the RGB channels of the decoded blocks.
+static double ColorPSNR (const vector<uint8_t>& pixels, const vector<uint8_t>& decoded) {
+	double error = 0;
+	for (size_t i = 0; i < pixels.size (); i += 4) {
+		for (size_t c = 0; c < 3; ++c) {
+			double d = (double) pixels[i + c] - (double) decoded[i + c];
+			error += d * d;
+		}
+	}
+
+	double mse = error / (double) (pixels.size () / 4 * 3);
+	return mse > 0 ? 10.0 * log10 (255.0 * 255.0 / mse) : 99.0;
+}
+
+int main (int argc, char** argv) {
+	bool flatten = argc > 1 && string (argv[1]) == "-flatten";
+	int argIndex = flatten ? 2 : 1;
+	if (argc - argIndex != 2) {
+		fprintf (stderr, "usage: texture_converter [-flatten] <input.png> <output.etc1>\n");
+		return 1;
+	}
+
+	string inputPath = argv[argIndex];
+	string outputPath = argv[argIndex + 1];
+
+	vector<uint8_t> png = ReadWholeFile (inputPath);
+	vector<uint8_t> pixels;
+	ETC1Texture texture;
+	if (png.empty () || !PNGDecoder ().Decode (&png[0], png.size (), pixels, texture.width, texture.height)) {
+		fprintf (stderr, "Cannot read image: %s\n", inputPath.c_str ());
+		return 1;
+	}
+
+	//Over black the premultiplied colors stay the same
+	bool hasAlpha = false;
+	for (size_t i = 3; i < pixels.size () && !hasAlpha; i += 4)
+		hasAlpha = pixels[i] != 0xFF;
+
+	if (hasAlpha && !flatten) {
+		size_t pitch = ETC1Texture::AlphaPitch (texture.width);
+		texture.alpha.assign (pitch * texture.height, 0);
+		for (int y = 0; y < texture.height; ++y) {
+			for (int x = 0; x < texture.width; ++x)
+				texture.alpha[y * pitch + x] = pixels[((size_t) y * texture.width + x) * 4 + 3];
+		}
+	}
+
+	texture.color = ETC1Encoder::Encode (&pixels[0], texture.width, texture.height);
+
+	vector<uint8_t> decoded;
+	ETC1Encoder::Decode (&texture.color[0], texture.width, texture.height, decoded);
+
+	vector<uint8_t> container = texture.Write ();
+	ofstream file (outputPath, ios::binary | ios::trunc);
+	file.write ((const char*) &container[0], (streamsize) container.size ());
+	if (!file.good ()) {
+		fprintf (stderr, "Cannot write container: %s\n", outputPath.c_str ());
+		return 1;
+	}
+
+	size_t rgbaBytes = pixels.size ();
+	printf ("%s: %dx%d, %s, texture %zu bytes (RGBA %zu bytes, %.1fx), color PSNR %.2f dB\n", outputPath.c_str (), texture.width, texture.height,
+			texture.alpha.empty () ? (hasAlpha ? "flattened" : "opaque") : "alpha plane", texture.Bytes (), rgbaBytes,
+			(double) rgbaBytes / (double) texture.Bytes (), ColorPSNR (pixels, decoded));
+	return 0;
+}
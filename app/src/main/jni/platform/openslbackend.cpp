@@ -0,0 +1,205 @@
+#include "../pch.h"
+#include "openslbackend.h"
+#include "../management/pcmstream.h"
+#include "../jnihelper/jniload.h"
+
+OpenSLBackend::OpenSLBackend (SLObjectItf engineObject, SLEngineItf engine, SLObjectItf outputMixObject) :
+	mEngineObject (engineObject),
+	mEngine (engine),
+	mOutputMixObject (outputMixObject),
+	mPlayer (nullptr),
+	mPlay (nullptr),
+	mVolume (nullptr),
+	mQueue (nullptr),
+	mCallback (nullptr),
+	mContext (nullptr) {
+	CHECKMSG (engineObject != nullptr && engine != nullptr, "OpenSLBackend::OpenSLBackend () - engine cannot be nullptr!");
+	CHECKMSG (outputMixObject != nullptr, "OpenSLBackend::OpenSLBackend () - outputMixObject cannot be nullptr!");
+}
+
+OpenSLBackend::~OpenSLBackend () {
+	Close ();
+}
+
+bool OpenSLBackend::Open (const AudioFormat& format, BufferCallback callback, void* context) {
+	CHECKMSG (mPlayer == nullptr, "OpenSLBackend::Open () - The player is opened already!");
+	CHECKMSG (callback != nullptr, "OpenSLBackend::Open () - callback cannot be nullptr!");
+	CHECKMSG (format.bufferCount >= 2, "OpenSLBackend::Open () - Minimum two buffers needed!");
+
+	mCallback = callback;
+	mContext = context;
+
+	// configure audio source
+	SLDataLocator_AndroidFD loc_fd = {
+		SL_DATALOCATOR_ANDROIDSIMPLEBUFFERQUEUE,
+		(SLint32) format.bufferCount
+	};
+
+	SLuint16 bitsPerSample = (SLuint16) (format.bytesPerSec / format.sampleRate * 8);
+
+	SLuint16 containerSize = 0;
+	switch (bitsPerSample) {
+		case SL_PCMSAMPLEFORMAT_FIXED_8:
+			containerSize = SL_PCMSAMPLEFORMAT_FIXED_8;
+			break;
+		case SL_PCMSAMPLEFORMAT_FIXED_16:
+			containerSize = SL_PCMSAMPLEFORMAT_FIXED_16;
+			break;
+		default:
+		case SL_PCMSAMPLEFORMAT_FIXED_20:
+		case SL_PCMSAMPLEFORMAT_FIXED_24:
+		case SL_PCMSAMPLEFORMAT_FIXED_28:
+		case SL_PCMSAMPLEFORMAT_FIXED_32:
+			containerSize = SL_PCMSAMPLEFORMAT_FIXED_32;
+			break;
+	}
+
+	SLuint32 channelMask = 0;
+	if (format.numChannels == 1)
+		channelMask = SL_SPEAKER_FRONT_CENTER;
+	else if (format.numChannels == 2)
+		channelMask = SL_SPEAKER_FRONT_LEFT | SL_SPEAKER_FRONT_RIGHT;
+	else {
+		LOGE ("OpenSLBackend::Open () - Number of channels must be 1 or 2! Other channel count is not supported yet.");
+		return false;
+	}
+
+	SLDataFormat_PCM format_pcm;
+	format_pcm.formatType       = SL_DATAFORMAT_PCM;
+	format_pcm.numChannels      = (SLuint32) format.numChannels;
+	format_pcm.samplesPerSec    = (SLuint32) format.sampleRate * 1000;
+	format_pcm.bitsPerSample    = bitsPerSample;
+	format_pcm.containerSize    = containerSize;
+	format_pcm.channelMask      = channelMask;
+	format_pcm.endianness       = SL_BYTEORDER_LITTLEENDIAN;
+
+	SLDataSource audioSrc = {
+		&loc_fd,
+		&format_pcm
+	};
+
+	// configure audio sink
+	SLDataLocator_OutputMix loc_outmix = {
+		SL_DATALOCATOR_OUTPUTMIX,
+		mOutputMixObject
+	};
+
+	SLDataSink audioSnk = {
+		&loc_outmix,
+		NULL
+	};
+
+	// realize engine objects
+	RealizeSLObject (mEngineObject);
+	RealizeSLObject (mOutputMixObject);
+
+	// create audio player
+	const unsigned int NUM_INTERFACES = 3;
+	const SLInterfaceID ids[NUM_INTERFACES] = { SL_IID_PLAY, SL_IID_VOLUME, SL_IID_ANDROIDSIMPLEBUFFERQUEUE };
+	const SLboolean req[NUM_INTERFACES] = { SL_BOOLEAN_TRUE, SL_BOOLEAN_TRUE, SL_BOOLEAN_TRUE };
+
+	SLresult result = (*mEngine)->CreateAudioPlayer (mEngine, &mPlayer, &audioSrc, &audioSnk, NUM_INTERFACES, ids, req);
+	CHECKMSG (result == SL_RESULT_SUCCESS && mPlayer != nullptr, "OpenSLBackend::Open () - CreateAudioPlayer () failed");
+
+	// realize the player
+	RealizeSLObject (mPlayer);
+
+	// get the play interface
+	result = (*mPlayer)->GetInterface (mPlayer, SL_IID_PLAY, &mPlay);
+	CHECKMSG (result == SL_RESULT_SUCCESS && mPlay != nullptr, "OpenSLBackend::Open () - Player::GetInterface (SL_IID_PLAY) failed");
+
+	// get the volume interface
+	result = (*mPlayer)->GetInterface (mPlayer, SL_IID_VOLUME, &mVolume);
+	CHECKMSG (result == SL_RESULT_SUCCESS && mVolume != nullptr, "OpenSLBackend::Open () - Player::GetInterface (SL_IID_VOLUME) failed");
+
+	// get the simple buffer queue interface
+	result = (*mPlayer)->GetInterface (mPlayer, SL_IID_ANDROIDSIMPLEBUFFERQUEUE, &mQueue);
+	CHECKMSG (result == SL_RESULT_SUCCESS && mQueue != nullptr, "OpenSLBackend::Open () - Player::GetInterface (SL_IID_ANDROIDSIMPLEBUFFERQUEUE) failed");
+
+	result = (*mQueue)->RegisterCallback (mQueue, OpenSLBackend::QueueCallback, this);
+	CHECKMSG (result == SL_RESULT_SUCCESS, "OpenSLBackend::Open () - Queue::RegisterCallback () failed");
+
+	return true;
+}
+
+void OpenSLBackend::Close () {
+	if (mPlay != nullptr) {
+		(*mPlay)->SetPlayState (mPlay, SL_PLAYSTATE_STOPPED);
+	}
+
+	if (mQueue != nullptr) {
+		(*mQueue)->Clear (mQueue);
+	}
+
+	if (mPlayer != nullptr) {
+		(*mPlayer)->AbortAsyncOperation (mPlayer);
+		(*mPlayer)->Destroy (mPlayer);
+	}
+
+	mPlayer = nullptr;
+	mPlay = nullptr;
+	mVolume = nullptr;
+	mQueue = nullptr;
+}
+
+void OpenSLBackend::Start () {
+	CHECKMSG (mPlay != nullptr, "OpenSLBackend::Start () - Can be called only after Open ()!");
+
+	//Start playing
+	SLresult result = (*mPlay)->SetPlayState (mPlay, SL_PLAYSTATE_PLAYING);
+	CHECKMSG (result == SL_RESULT_SUCCESS, "OpenSLBackend::Start () - Play::SetPlayState (Play) failed");
+}
+
+bool OpenSLBackend::Enqueue (const uint8_t* buffer, uint32_t size) {
+	return mQueue != nullptr && (*mQueue)->Enqueue (mQueue, buffer, (SLuint32) size) == SL_RESULT_SUCCESS;
+}
+
+uint32_t OpenSLBackend::QueuedCount () const {
+	SLAndroidSimpleBufferQueueState state;
+	return mQueue != nullptr && (*mQueue)->GetState (mQueue, &state) == SL_RESULT_SUCCESS ? (uint32_t) state.count : 0;
+}
+
+uint64_t OpenSLBackend::Now () const {
+	return PCMStream::Now ();
+}
+
+void OpenSLBackend::RealizeSLObject (SLObjectItf obj) {
+	//Checking the object’s state since we would like to use it now, and its resources may have been stolen.
+	SLuint32 state;
+	SLresult result = (*obj)->GetState (obj, &state);
+	CHECKMSG (result == SL_RESULT_SUCCESS, "OpenSLBackend::RealizeSLObject () - Player::GetState () failed");
+
+	//Resuming state synchronously.
+	if (state != SL_OBJECT_STATE_REALIZED) {
+		if (SL_OBJECT_STATE_SUSPENDED == state)
+			result = (*obj)->Resume (obj, SL_BOOLEAN_FALSE);
+		else if (SL_OBJECT_STATE_UNREALIZED == state)
+			result = (*obj)->Realize (obj, SL_BOOLEAN_FALSE);
+
+		while (SL_RESULT_RESOURCE_ERROR == result) {
+			//Not enough resources. Increasing object priority.
+			SLint32 priority;
+			SLboolean preemptable;
+
+			result = (*obj)->GetPriority (obj, &priority, &preemptable);
+			CHECKMSG (result == SL_RESULT_SUCCESS, "OpenSLBackend::RealizeSLObject () - Player::GetPriority () failed");
+
+			result = (*obj)->SetPriority (obj, INT_MAX, SL_BOOLEAN_FALSE);
+			CHECKMSG (result == SL_RESULT_SUCCESS, "OpenSLBackend::RealizeSLObject () - Player::SetPriority () failed");
+
+			//trying again
+			if (SL_OBJECT_STATE_SUSPENDED == state)
+				result = (*obj)->Resume (obj, SL_BOOLEAN_FALSE);
+			else if (SL_OBJECT_STATE_UNREALIZED == state)
+				result = (*obj)->Realize (obj, SL_BOOLEAN_FALSE);
+		}
+	}
+}
+
+void SLAPIENTRY OpenSLBackend::QueueCallback (SLAndroidSimpleBufferQueueItf queue, void *context) {
+	CHECKMSG (queue != nullptr, "OpenSLBackend::QueueCallback () - queue cannot be nullptr!");
+	CHECKMSG (context != nullptr, "OpenSLBackend::QueueCallback () - context cannot be nullptr!");
+
+	OpenSLBackend* backend = (OpenSLBackend*) context;
+	backend->mCallback (backend->mContext);
+}
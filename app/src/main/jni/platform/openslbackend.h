@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../management/audiobackend.h"
+
+///
+/// The OpenSL ES audio device: a buffer queue player on the output mix of the AudioManager.
+class OpenSLBackend : public IAudioBackend {
+//Data
+private:
+	SLObjectItf mEngineObject;
+	SLEngineItf mEngine;
+	SLObjectItf mOutputMixObject;
+
+	SLObjectItf mPlayer;
+	SLPlayItf mPlay;
+	SLVolumeItf mVolume;
+	SLAndroidSimpleBufferQueueItf mQueue;
+
+	BufferCallback mCallback;
+	void* mContext;
+
+//Construction
+public:
+	/// The engine and the output mix belong to the caller (they have to live longer than the backend).
+	OpenSLBackend (SLObjectItf engineObject, SLEngineItf engine, SLObjectItf outputMixObject);
+	virtual ~OpenSLBackend ();
+
+//Interface
+public:
+	virtual const char* Name () const override {
+		return "opensl";
+	}
+
+	virtual bool Open (const AudioFormat& format, BufferCallback callback, void* context) override;
+	virtual void Close () override;
+	virtual void Start () override;
+	virtual bool Enqueue (const uint8_t* buffer, uint32_t size) override;
+	virtual uint32_t QueuedCount () const override;
+	virtual uint64_t Now () const override;
+
+	/// Realize (or resume) an object, raising its priority while the resources are missing.
+	static void RealizeSLObject (SLObjectItf obj);
+
+//Helper methods
+private:
+	static void SLAPIENTRY QueueCallback (SLAndroidSimpleBufferQueueItf queue, void *context);
+};